@@ -0,0 +1,252 @@
+// Compares the LineScanner kernels with each other and with the QTextStream::readLine() loop
+// the index replaced.
+//
+// Usage: LineScannerBenchmark [--check] [log file]
+//
+// Every run first checks that all kernels find the same line starts and longest line as a
+// naive reference, over edge cases: newlines at and around vector boundaries, "\r\n" split
+// across chunks and stream buffers, and unaligned starts and tails. With --check nothing
+// else is done; otherwise the kernels are timed over the given file, or over a generated
+// log of about 256 MB.
+
+#include <QByteArray>
+#include <QBuffer>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QRandomGenerator>
+#include <QTextStream>
+#include <QVector>
+#include <cstdio>
+#include "LineScanner.h"
+
+namespace {
+
+struct Result {
+    QVector<quint64> lineStarts;
+    qint64 longest = 0;
+
+    bool operator==(const Result &other) const {
+        return lineStarts == other.lineStarts && longest == other.longest;
+    }
+};
+
+const LineScanner::Kernel kernels[] = {LineScanner::Scalar, LineScanner::SSE2, LineScanner::AVX2};
+
+Result reference(const char *data, qint64 size) {
+    Result result;
+    qint64 lineStart = 0;
+    for (qint64 i = 0; i < size; ++i) {
+        if (data[i] != '\n') {
+            continue;
+        }
+        qint64 length = i - lineStart;
+        if (length > 0 && data[i - 1] == '\r') {
+            --length;
+        }
+        result.longest = qMax(result.longest, length);
+        lineStart = i + 1;
+        if (lineStart < size) {
+            result.lineStarts.append(static_cast<quint64>(lineStart));
+        }
+    }
+    if (lineStart < size) {
+        qint64 length = size - lineStart;
+        if (data[size - 1] == '\r') {
+            --length;
+        }
+        result.longest = qMax(result.longest, length);
+    }
+    return result;
+}
+
+// Scans a buffer in chunks ending at the given offsets, as the index builder does
+Result scanChunks(const char *data, qint64 size, const QVector<qint64> &chunkEnds) {
+    Result result;
+    LineScanner scanner(data, size);
+    qint64 from = 0;
+    for (qint64 to : chunkEnds) {
+        scanner.scan(from, to, result.lineStarts);
+        from = to;
+    }
+    scanner.scan(from, size, result.lineStarts);
+    result.longest = scanner.longestLine();
+    return result;
+}
+
+// Feeds a buffer as a stream split at the given offsets, as compressed sources do
+Result scanStream(const char *data, qint64 size, const QVector<qint64> &chunkEnds) {
+    Result result;
+    LineScanner scanner;
+    qint64 from = 0;
+    for (qint64 to : chunkEnds) {
+        scanner.scanBuffer(data + from, to - from, result.lineStarts);
+        from = to;
+    }
+    scanner.scanBuffer(data + from, size - from, result.lineStarts);
+    scanner.finish();
+    if (!result.lineStarts.isEmpty() && static_cast<qint64>(result.lineStarts.last()) == size) {
+        result.lineStarts.removeLast(); // A newline ending the stream starts no line
+    }
+    result.longest = scanner.longestLine();
+    return result;
+}
+
+int failures = 0;
+
+void check(const QByteArray &bytes, qint64 start, const QVector<qint64> &chunkEnds, const char *what) {
+    const char *data = bytes.constData() + start;
+    const qint64 size = bytes.size() - start;
+    const Result expected = reference(data, size);
+    for (LineScanner::Kernel kernel : kernels) {
+        LineScanner::setKernel(kernel);
+        if (LineScanner::kernel() != kernel) {
+            continue; // Not supported by this CPU
+        }
+        if (!(scanChunks(data, size, chunkEnds) == expected) || !(scanStream(data, size, chunkEnds) == expected)) {
+            std::printf("MISMATCH (%s kernel): %s, %lld bytes from offset %lld\n", LineScanner::kernelName(), what,
+                        static_cast<long long>(size), static_cast<long long>(start));
+            ++failures;
+        }
+    }
+}
+
+void checkEdgeCases() {
+    // A newline or "\r\n" at every position around the 16, 32 and 64-byte blocks of the kernels
+    for (qint64 size = 1; size <= 200; ++size) {
+        for (qint64 position = 0; position < size; ++position) {
+            QByteArray bytes(size, 'x');
+            bytes[position] = '\n';
+            check(bytes, 0, {}, "single newline");
+            if (position > 0) {
+                bytes[position - 1] = '\r';
+                check(bytes, 0, {}, "single CRLF");
+                check(bytes, 0, {position}, "CRLF split across chunks");
+            }
+        }
+    }
+
+    // Unaligned starts and tails of the same bytes
+    QByteArray lines;
+    for (int i = 0; lines.size() < 4096; ++i) {
+        lines.append(QByteArray(i % 97, 'a' + i % 26));
+        lines.append(i % 3 == 0 ? "\r\n" : "\n");
+    }
+    for (qint64 start = 0; start < 64; ++start) {
+        for (qint64 cut = 0; cut < 64; ++cut) {
+            check(lines.left(lines.size() - cut), start, {}, "unaligned start and tail");
+        }
+    }
+
+    // Random lines split at random chunk boundaries
+    QRandomGenerator random(42);
+    const char alphabet[] = {'a', 'b', '\r', '\n', '\n', 'z'};
+    for (int round = 0; round < 2000; ++round) {
+        QByteArray bytes(random.bounded(1, 400), '\0');
+        for (char &byte : bytes) {
+            byte = alphabet[random.bounded(static_cast<int>(sizeof(alphabet)))];
+        }
+        QVector<qint64> chunkEnds;
+        for (qint64 end = random.bounded(1, 70); end < bytes.size(); end += random.bounded(1, 70)) {
+            chunkEnds.append(end);
+        }
+        check(bytes, 0, chunkEnds, "random chunks");
+    }
+}
+
+QByteArray generateLog(qint64 size) {
+    static const char *const messages[] = {
+        "INFO  [main] Request handled in 12 ms, status=200, path=/api/v1/items",
+        "DEBUG [worker-3] Cache lookup key=session:8f2a1c hit=true",
+        "WARN  [db-pool] Connection acquisition took 850 ms, pool size 32, waiting 4",
+        "ERROR [scheduler] Job nightly-export failed: java.io.IOException: Broken pipe",
+        "INFO  [http-nio-8080-exec-7] GET /health 200",
+    };
+    QByteArray log;
+    log.reserve(size + 256);
+    QRandomGenerator random(7);
+    qint64 millis = 0;
+    while (log.size() < size) {
+        millis += random.bounded(50);
+        log.append("2024-03-01 12:");
+        log.append(QByteArray::number(10 + millis / 60000 % 50));
+        log.append(':');
+        log.append(QByteArray::number(10 + millis / 1000 % 50));
+        log.append(' ');
+        log.append(messages[random.bounded(5)]);
+        log.append('\n');
+    }
+    return log;
+}
+
+void report(const char *name, qint64 bytes, qint64 nanoseconds, qint64 lines) {
+    const double seconds = nanoseconds / 1e9;
+    std::printf("%-24s %8.1f ms %10.2f GB/s %12lld lines\n", name, seconds * 1e3, bytes / seconds / 1e9, static_cast<long long>(lines));
+}
+
+void benchmark(const QByteArray &log) {
+    std::printf("%lld bytes\n", static_cast<long long>(log.size()));
+
+    QBuffer buffer;
+    buffer.setData(log);
+    buffer.open(QIODevice::ReadOnly);
+    QTextStream in(&buffer);
+    QElapsedTimer timer;
+    timer.start();
+    qint64 lines = 0;
+    qint64 longest = 0;
+    while (!in.atEnd()) {
+        longest = qMax<qint64>(longest, in.readLine().size());
+        ++lines;
+    }
+    report("QTextStream::readLine", log.size(), timer.nsecsElapsed(), lines);
+
+    for (LineScanner::Kernel kernel : kernels) {
+        LineScanner::setKernel(kernel);
+        if (LineScanner::kernel() != kernel) {
+            continue;
+        }
+        QVector<quint64> lineStarts;
+        lineStarts.reserve(log.size() / 64);
+        timer.start();
+        LineScanner scanner(log.constData(), log.size());
+        scanner.scan(0, log.size(), lineStarts);
+        report(QByteArray("LineScanner ").append(LineScanner::kernelName()).constData(), log.size(), timer.nsecsElapsed(), lineStarts.size() + 1);
+    }
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+    bool checkOnly = false;
+    QString filePath;
+    for (int i = 1; i < argc; ++i) {
+        if (QByteArray(argv[i]) == "--check") {
+            checkOnly = true;
+        } else {
+            filePath = QString::fromLocal8Bit(argv[i]);
+        }
+    }
+
+    checkEdgeCases();
+    if (failures > 0) {
+        return 1;
+    }
+    std::printf("All kernels agree with the reference\n");
+    if (checkOnly) {
+        return 0;
+    }
+
+    QByteArray log;
+    if (filePath.isEmpty()) {
+        log = generateLog(256 * 1024 * 1024);
+    } else {
+        QFile file(filePath);
+        if (!file.open(QIODevice::ReadOnly)) {
+            std::printf("Cannot open %s\n", qPrintable(filePath));
+            return 1;
+        }
+        log = file.readAll();
+    }
+    benchmark(log);
+    return 0;
+}
@@ -0,0 +1,275 @@
+// Compares the TextSearcher kernels with each other and with the QString::indexOf() and
+// QTextDocument::find() searches the raw-byte search replaced.
+//
+// Usage: TextSearcherBenchmark [--check] [log file]
+//
+// Every run first checks that all kernels find the same matches as a naive reference, case
+// sensitive and folded, over edge cases: the neighbours of the letters in ASCII ('@', '[',
+// '`', '{'), which a careless fold confuses with them, bytes of 0x80 and above, which are
+// never folded, and needles at every position around the end of the 16 and 32-byte blocks.
+// With --check nothing else is done; otherwise the searches are timed over the given file,
+// or over a generated log of about 256 MB.
+
+#include <QByteArray>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QGuiApplication>
+#include <QRandomGenerator>
+#include <QString>
+#include <QTextCursor>
+#include <QTextDocument>
+#include <QVector>
+#include <cstdio>
+#include "LineScanner.h"
+#include "TextSearcher.h"
+
+namespace {
+
+const LineScanner::Kernel kernels[] = {LineScanner::Scalar, LineScanner::SSE2, LineScanner::AVX2};
+
+// Bytes close to the letters or to their case bit, as UTF-8: 'é' and 'É' differ in 0x20 only
+const char *const confusables[] = {"@", "A", "Z", "[", "`", "a", "z", "{", "x", " ", "\xC3\xA9", "\xC3\x89"};
+const int confusableCount = sizeof(confusables) / sizeof(confusables[0]);
+
+char foldCase(char byte) {
+    return (byte >= 'A' && byte <= 'Z') ? static_cast<char>(byte - 'A' + 'a') : byte;
+}
+
+QByteArray flipCase(const QByteArray &bytes) {
+    QByteArray flipped = bytes;
+    for (char &byte : flipped) {
+        if ((byte >= 'a' && byte <= 'z') || (byte >= 'A' && byte <= 'Z')) {
+            byte = static_cast<char>(byte ^ 0x20);
+        }
+    }
+    return flipped;
+}
+
+// Every offset at or after from where the needle starts, folding ASCII letters only
+QVector<qint64> reference(const QByteArray &haystack, qint64 from, const QByteArray &needle, bool folded) {
+    QVector<qint64> matches;
+    for (qint64 i = from; i + needle.size() <= haystack.size(); ++i) {
+        qint64 j = 0;
+        while (j < needle.size() && (folded ? foldCase(haystack.at(i + j)) == foldCase(needle.at(j)) : haystack.at(i + j) == needle.at(j))) {
+            ++j;
+        }
+        if (j == needle.size()) {
+            matches.append(i);
+        }
+    }
+    return matches;
+}
+
+// Every match, each search resuming one byte after the last match, so from is mostly unaligned
+QVector<qint64> search(const TextSearcher &searcher, const QByteArray &haystack, qint64 from) {
+    QVector<qint64> matches;
+    for (qint64 match = searcher.indexIn(haystack.constData(), haystack.size(), from); match >= 0;
+         match = searcher.indexIn(haystack.constData(), haystack.size(), match + 1)) {
+        matches.append(match);
+    }
+    return matches;
+}
+
+int failures = 0;
+
+void check(const QByteArray &haystack, qint64 from, const QByteArray &needle, const char *what) {
+    for (Qt::CaseSensitivity caseSensitivity : {Qt::CaseSensitive, Qt::CaseInsensitive}) {
+        const QVector<qint64> expected = reference(haystack, from, needle, caseSensitivity == Qt::CaseInsensitive);
+        const TextSearcher searcher(QString::fromUtf8(needle), caseSensitivity);
+        for (LineScanner::Kernel kernel : kernels) {
+            LineScanner::setKernel(kernel);
+            if (LineScanner::kernel() != kernel) {
+                continue; // Not supported by this CPU
+            }
+            if (search(searcher, haystack, from) != expected) {
+                std::printf("MISMATCH (%s kernel, %s): %s, needle \"%s\", %lld bytes from offset %lld\n", LineScanner::kernelName(),
+                            caseSensitivity == Qt::CaseSensitive ? "case sensitive" : "folded", what, needle.constData(),
+                            static_cast<long long>(haystack.size()), static_cast<long long>(from));
+                ++failures;
+            }
+        }
+    }
+}
+
+void checkEdgeCases() {
+    // Every pair of confusable characters as a needle, over text made of all of them, long
+    // enough for both kernels to find candidates in full blocks
+    QByteArray mixed;
+    for (int round = 0; round < 4; ++round) {
+        for (int i = 0; i < confusableCount; ++i) {
+            for (int j = 0; j < confusableCount; ++j) {
+                mixed.append(confusables[(i + round) % confusableCount]).append(confusables[j]);
+            }
+        }
+    }
+    for (int i = 0; i < confusableCount; ++i) {
+        for (int j = 0; j < confusableCount; ++j) {
+            const QByteArray needle = QByteArray(confusables[i]).append(confusables[j]);
+            check(mixed, 0, needle, "confusable pair");
+            check(mixed, 0, QByteArray(needle).append('x').append(needle), "confusable pair around a letter");
+        }
+    }
+
+    // Needles of every length placed at every position around the end of a block, in both
+    // cases, over filler of letter neighbours; the haystack also ends right after the needle
+    const QByteArray pattern("a@Z[`{zy\xC3\xA9q\xC3\x89mNoP@@[[``{{aAzZbCdEfGhIjKlMnOpQrStU");
+    for (qint64 length = 1; length <= 40; ++length) {
+        const QByteArray needle = pattern.left(length);
+        for (qint64 position = 0; position <= 100; ++position) {
+            for (const QByteArray &placed : {needle, flipCase(needle)}) {
+                QByteArray haystack(position, '@');
+                haystack.append(placed);
+                check(haystack, 0, needle, "needle ending the haystack");
+                haystack.append(QByteArray(70, '`'));
+                check(haystack, 0, needle, "needle across a block end");
+                check(haystack, position % 17, needle, "needle across a block end, unaligned start");
+            }
+        }
+    }
+
+    // Random text of confusable characters, with needles cut out of it and flipped in case
+    QRandomGenerator random(42);
+    for (int round = 0; round < 3000; ++round) {
+        QVector<QByteArray> characters;
+        const int count = random.bounded(1, 300);
+        for (int i = 0; i < count; ++i) {
+            characters.append(confusables[random.bounded(confusableCount)]);
+        }
+        QByteArray haystack;
+        for (const QByteArray &character : std::as_const(characters)) {
+            haystack.append(character);
+        }
+
+        const int first = random.bounded(count);
+        const int last = qMin(count, first + random.bounded(1, 12));
+        QByteArray needle;
+        for (int i = first; i < last; ++i) {
+            needle.append(characters.at(i));
+        }
+        check(haystack, random.bounded(static_cast<int>(haystack.size())), random.bounded(2) ? flipCase(needle) : needle, "random text");
+    }
+}
+
+QByteArray generateLog(qint64 size) {
+    static const char *const messages[] = {
+        "INFO  [main] Request handled in 12 ms, status=200, path=/api/v1/items",
+        "DEBUG [worker-3] Cache lookup key=session:8f2a1c hit=true",
+        "WARN  [db-pool] Connection acquisition took 850 ms, pool size 32, waiting 4",
+        "ERROR [scheduler] Job nightly-export failed: java.io.IOException: Broken pipe",
+        "INFO  [http-nio-8080-exec-7] GET /health 200",
+    };
+    QByteArray log;
+    log.reserve(size + 256);
+    QRandomGenerator random(7);
+    qint64 millis = 0;
+    while (log.size() < size) {
+        millis += random.bounded(50);
+        log.append("2024-03-01 12:");
+        log.append(QByteArray::number(10 + millis / 60000 % 50));
+        log.append(':');
+        log.append(QByteArray::number(10 + millis / 1000 % 50));
+        log.append(' ');
+        log.append(messages[random.bounded(5)]);
+        log.append('\n');
+    }
+    return log;
+}
+
+void report(const char *name, qint64 bytes, qint64 nanoseconds, qint64 matches) {
+    const double seconds = nanoseconds / 1e9;
+    std::printf("  %-30s %8.1f ms %10.2f GB/s %10lld matches\n", name, seconds * 1e3, bytes / seconds / 1e9, static_cast<long long>(matches));
+}
+
+void benchmark(const QByteArray &log) {
+    // QTextDocument lays out every block it holds, so it only gets the first few megabytes
+    const qint64 documentBytes = qMin<qint64>(log.size(), 16 * 1024 * 1024);
+    std::printf("%lld bytes, of which QTextDocument gets %lld\n", static_cast<long long>(log.size()), static_cast<long long>(documentBytes));
+
+    QElapsedTimer timer;
+    timer.start();
+    const QString text = QString::fromUtf8(log);
+    report("QString::fromUtf8", log.size(), timer.nsecsElapsed(), 0);
+    QTextDocument document;
+    document.setPlainText(QString::fromUtf8(log.constData(), documentBytes));
+
+    const char *const patterns[] = {"nightly-export", "Broken Pipe", "status=500"};
+    for (const char *pattern : patterns) {
+        for (Qt::CaseSensitivity caseSensitivity : {Qt::CaseSensitive, Qt::CaseInsensitive}) {
+            std::printf("\"%s\", %s\n", pattern, caseSensitivity == Qt::CaseSensitive ? "case sensitive" : "ignoring case");
+            const QString needle = QString::fromUtf8(pattern);
+
+            qint64 matches = 0;
+            timer.start();
+            for (qint64 at = text.indexOf(needle, 0, caseSensitivity); at >= 0; at = text.indexOf(needle, at + needle.size(), caseSensitivity)) {
+                ++matches;
+            }
+            report("QString::indexOf", log.size(), timer.nsecsElapsed(), matches);
+
+            const QTextDocument::FindFlags flags = caseSensitivity == Qt::CaseSensitive ? QTextDocument::FindCaseSensitively : QTextDocument::FindFlags();
+            matches = 0;
+            timer.start();
+            for (QTextCursor cursor = document.find(needle, 0, flags); !cursor.isNull(); cursor = document.find(needle, cursor, flags)) {
+                ++matches;
+            }
+            report("QTextDocument::find", documentBytes, timer.nsecsElapsed(), matches);
+
+            const TextSearcher searcher(needle, caseSensitivity);
+            for (LineScanner::Kernel kernel : kernels) {
+                LineScanner::setKernel(kernel);
+                if (LineScanner::kernel() != kernel) {
+                    continue;
+                }
+                matches = 0;
+                timer.start();
+                for (qint64 at = searcher.indexIn(log.constData(), log.size()); at >= 0;
+                     at = searcher.indexIn(log.constData(), log.size(), at + searcher.patternLength())) {
+                    ++matches;
+                }
+                report(QByteArray("TextSearcher ").append(LineScanner::kernelName()).constData(), log.size(), timer.nsecsElapsed(), matches);
+            }
+        }
+    }
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+    bool checkOnly = false;
+    QString filePath;
+    for (int i = 1; i < argc; ++i) {
+        if (QByteArray(argv[i]) == "--check") {
+            checkOnly = true;
+        } else {
+            filePath = QString::fromLocal8Bit(argv[i]);
+        }
+    }
+
+    checkEdgeCases();
+    if (failures > 0) {
+        return 1;
+    }
+    std::printf("All kernels agree with the reference\n");
+    if (checkOnly) {
+        return 0;
+    }
+
+    // QTextDocument needs a GUI application, but no display
+    if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM")) {
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+    }
+    QGuiApplication app(argc, argv);
+
+    QByteArray log;
+    if (filePath.isEmpty()) {
+        log = generateLog(256 * 1024 * 1024);
+    } else {
+        QFile file(filePath);
+        if (!file.open(QIODevice::ReadOnly)) {
+            std::printf("Cannot open %s\n", qPrintable(filePath));
+            return 1;
+        }
+        log = file.readAll();
+    }
+    benchmark(log);
+    return 0;
+}
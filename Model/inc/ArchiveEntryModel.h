@@ -0,0 +1,186 @@
+#ifndef ARCHIVEENTRYMODEL_H
+#define ARCHIVEENTRYMODEL_H
+
+#include <QAbstractItemModel>
+#include <QSharedPointer>
+#include <QVector>
+#include <QBitArray>
+#include <QIcon>
+#include "ArchiveSession.h"
+
+/**
+ * @brief Checkable item model over the entries of an ArchiveSession, for archives with any number of entries.
+ *
+ * Entries are sorted by path once, so that every directory covers a contiguous range of them.
+ * Directory nodes are only created when the view expands a directory (fetchMore()), and no
+ * per-item objects exist beyond that, so opening an archive with hundreds of thousands of
+ * entries costs one sort. Sizes of directories and their check states are derived from the
+ * range in constant and logarithmic time: sizes from prefix sums, check states from a Fenwick
+ * tree over the checked flags.
+ *
+ * With a filter set, the model turns into a flat list of the matching entries, shown by their
+ * full path. A pattern containing *, ? or [ is a glob matched against the file name, or against
+ * the full path if it contains a /; anything else is a case-insensitive substring of the path.
+ */
+class ArchiveEntryModel : public QAbstractItemModel
+{
+    Q_OBJECT
+
+public:
+    /**
+     * @brief Columns of the model.
+     */
+    enum Column {
+        NameColumn,             ///< Entry or directory name, full path while filtering.
+        SizeColumn,             ///< Uncompressed size.
+        CompressedSizeColumn,   ///< Size stored in the archive.
+        ColumnCount
+    };
+
+    /**
+     * @brief Role returning the path of a file entry inside the archive, empty for directories.
+     */
+    static constexpr int EntryPathRole = Qt::UserRole + 1;
+
+    /**
+     * @brief Constructs a model over the entries of an archive, with nothing checked.
+     * @param archive Session of the archive.
+     * @param parent The parent QObject.
+     */
+    explicit ArchiveEntryModel(const QSharedPointer<ArchiveSession> &archive, QObject *parent = nullptr);
+
+    QModelIndex index(int row, int column, const QModelIndex &parent = QModelIndex()) const override;
+    QModelIndex parent(const QModelIndex &child) const override;
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex &parent = QModelIndex()) const override;
+    bool hasChildren(const QModelIndex &parent = QModelIndex()) const override;
+    bool canFetchMore(const QModelIndex &parent) const override;
+    void fetchMore(const QModelIndex &parent) override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+    bool setData(const QModelIndex &index, const QVariant &value, int role = Qt::EditRole) override;
+    Qt::ItemFlags flags(const QModelIndex &index) const override;
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+
+    /**
+     * @brief Filters the entries by name or glob; an empty pattern shows the directory tree again.
+     *
+     * When a substring pattern only extends the previous one, just the previous matches are searched.
+     *
+     * @param pattern Glob or substring, see the class description.
+     */
+    void setFilter(const QString &pattern);
+
+    /**
+     * @brief Returns true while a filter is set.
+     */
+    bool isFiltered() const;
+
+    /**
+     * @brief Returns the number of entries matching the filter, all entries when there is none.
+     */
+    int matchCount() const;
+
+    /**
+     * @brief Checks or unchecks all entries matching the filter, all entries when there is none.
+     */
+    void setMatchingChecked(bool check);
+
+    /**
+     * @brief Returns the paths inside the archive of all checked entries.
+     */
+    QStringList checkedEntries() const;
+
+    /**
+     * @brief Checks exactly the given entries and unchecks all others.
+     * @param entryPaths Paths of the entries inside the archive.
+     */
+    void setCheckedEntries(const QStringList &entryPaths);
+
+    /**
+     * @brief Returns the paths inside the archive of the entries matching the filter, all entries when there is none.
+     */
+    QStringList matchingEntries() const;
+
+    /**
+     * @brief Returns the number of checked entries.
+     */
+    int checkedCount() const;
+
+    /**
+     * @brief Returns the total uncompressed size of the checked entries.
+     */
+    qint64 checkedSize() const;
+
+    /**
+     * @brief Returns the total size stored in the archive of the checked entries.
+     */
+    qint64 checkedCompressedSize() const;
+
+signals:
+    /**
+     * @brief Emitted when entries have been checked or unchecked.
+     */
+    void checkedChanged();
+
+private:
+    /**
+     * @brief File or directory of the tree; directories cover a range of the sorted entries.
+     */
+    struct Node {
+        int parent = -1;                ///< Parent node, -1 for the root.
+        int row = 0;                    ///< Row of the node under its parent.
+        int begin = 0;                  ///< First sorted entry below the node, the entry itself for files.
+        int end = 0;                    ///< One past the last sorted entry below the node.
+        int prefixLength = 0;           ///< Length of the directory path including the trailing /, 0 for files.
+        bool populated = false;         ///< True once the children of a directory have been created.
+        QVector<int> children;          ///< Child nodes, once populated.
+    };
+
+    QSharedPointer<ArchiveSession> archive;     ///< Archive whose entries are shown.
+    QVector<int> order;                         ///< Indices of the archive entries, sorted by path.
+    QVector<qint64> sizeBefore;                 ///< Uncompressed size of the sorted entries before every position.
+    QVector<qint64> compressedBefore;           ///< Compressed size of the sorted entries before every position.
+    QVector<Node> nodes;                        ///< Tree nodes, nodes[0] is the root.
+    QBitArray checked;                          ///< Checked flag of every sorted entry.
+    QVector<int> checkedTree;                   ///< Fenwick tree over checked, counts checked entries in a range.
+    int checkedTotal = 0;                       ///< Number of checked entries.
+    qint64 checkedBytes = 0;                    ///< Uncompressed size of the checked entries.
+    qint64 checkedCompressedBytes = 0;          ///< Compressed size of the checked entries.
+    QString filter;                             ///< Current filter, empty when showing the tree.
+    bool substringFilter = false;               ///< True if filter is a substring rather than a glob.
+    QVector<int> matches;                       ///< Sorted positions of the entries matching the filter.
+    QIcon folderIcon;                           ///< Decoration of directories.
+    QIcon fileIcon;                             ///< Decoration of files.
+
+    /**
+     * @brief Returns the archive entry at a sorted position.
+     */
+    const ArchiveSession::Entry &entryAt(int position) const;
+
+    /**
+     * @brief Creates the children of a directory node.
+     */
+    void populate(int node);
+
+    /**
+     * @brief Returns the number of checked entries among the sorted positions [begin, end).
+     */
+    int checkedIn(int begin, int end) const;
+
+    /**
+     * @brief Sets the checked flag of the entries at the sorted positions [begin, end) and updates the totals.
+     */
+    void setCheckedRange(int begin, int end, bool value);
+
+    /**
+     * @brief Emits dataChanged() for the check state of a node's populated descendants.
+     */
+    void notifyDescendants(int node);
+
+    /**
+     * @brief Emits dataChanged() for the check state of a node's ancestors.
+     */
+    void notifyAncestors(int node);
+};
+
+#endif // ARCHIVEENTRYMODEL_H
@@ -0,0 +1,118 @@
+#ifndef ARCHIVESEARCH_H
+#define ARCHIVESEARCH_H
+
+#include <QObject>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <QSharedPointer>
+#include <QThreadPool>
+#include <atomic>
+#include <memory>
+#include "ArchiveSession.h"
+
+/**
+ * @brief Searches entries of an archive for a text without extracting or indexing them.
+ *
+ * Every entry is streamed through the prefilter of a LineMatcher once, on a thread pool of
+ * its own, the largest entries first. Only candidate lines are decoded, and matched in full
+ * where the prefilter cannot tell, e.g. for non-ASCII text ignoring case. Only the first
+ * maxHits matching lines per entry are kept, so searching hundreds of entries costs no more
+ * memory than a few read buffers. Entries are read through ArchiveSession::openEntry(), so they are
+ * decompressed on the fly and nothing is written to disk, except for 7z entries, which are
+ * spooled like when they are opened.
+ *
+ * Results arrive through entrySearched() on the thread that owns the search.
+ */
+class ArchiveSearch : public QObject
+{
+    Q_OBJECT
+
+public:
+    /**
+     * @brief Line containing a match.
+     */
+    struct Hit {
+        qint64 line = 0;    ///< Zero-based line number within the entry.
+        QString text;       ///< Text of the line, shortened if it is very long.
+    };
+
+    /**
+     * @brief Outcome of searching one entry.
+     */
+    struct Result {
+        QString entryPath;          ///< Path of the entry inside the archive.
+        qint64 matchingLines = 0;   ///< Number of lines containing the text.
+        QVector<Hit> hits;          ///< The first matching lines, at most maxHits of them.
+        QString error;              ///< Description of the error if the entry could not be read, otherwise empty.
+    };
+
+    /**
+     * @brief Constructs an idle search over the entries of an archive.
+     * @param archive Session of the archive.
+     * @param parent The parent QObject.
+     */
+    explicit ArchiveSearch(const QSharedPointer<ArchiveSession> &archive, QObject *parent = nullptr);
+
+    /**
+     * @brief Cancels a running search and waits for its workers.
+     */
+    ~ArchiveSearch() override;
+
+    /**
+     * @brief Starts searching entries, cancelling a search that is still running.
+     * @param entryPaths Paths of the entries to search.
+     * @param text Text to search for.
+     * @param caseSensitivity Whether letters have to match in case.
+     * @param maxHits Number of matching lines kept per entry.
+     */
+    void start(const QStringList &entryPaths, const QString &text, Qt::CaseSensitivity caseSensitivity, int maxHits = 20);
+
+    /**
+     * @brief Stops the search; entries being searched stop after their current buffer.
+     */
+    void cancel();
+
+    /**
+     * @brief Returns true while a search is running.
+     */
+    bool isRunning() const;
+
+signals:
+    /**
+     * @brief Emitted for every entry once it has been searched.
+     * @param result Matches in the entry.
+     */
+    void entrySearched(const ArchiveSearch::Result &result);
+
+    /**
+     * @brief Emitted after every searched entry.
+     * @param entriesDone Entries searched so far.
+     * @param entriesTotal Entries to search.
+     * @param bytesSearched Uncompressed bytes searched so far.
+     */
+    void progress(int entriesDone, int entriesTotal, qint64 bytesSearched);
+
+    /**
+     * @brief Emitted when all entries have been searched or the search was cancelled.
+     * @param cancelled True if cancel() was called.
+     */
+    void finished(bool cancelled);
+
+private:
+    QSharedPointer<ArchiveSession> archive;     ///< Archive whose entries are searched.
+    QThreadPool pool;                           ///< Worker threads searching entries.
+    std::shared_ptr<std::atomic<bool>> stop;    ///< Cancellation flag of the current search, shared with its workers.
+    int generation = 0;                         ///< Number of the current search, results of older ones are dropped.
+    int entriesTotal = 0;                       ///< Entries of the current search.
+    int entriesDone = 0;                        ///< Entries of the current search searched so far.
+    qint64 bytesSearched = 0;                   ///< Uncompressed bytes searched by the current search.
+    bool running = false;                       ///< True while the current search has unfinished entries.
+
+    /**
+     * @brief Accounts the result of an entry on the owning thread and emits the signals.
+     */
+    void onEntrySearched(int searchGeneration, const Result &result, qint64 bytes);
+};
+
+#endif // ARCHIVESEARCH_H
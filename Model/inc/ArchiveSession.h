@@ -0,0 +1,266 @@
+#ifndef ARCHIVESESSION_H
+#define ARCHIVESESSION_H
+
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <QHash>
+#include <QSet>
+#include <QMutex>
+#include <QSharedPointer>
+#include <QEnableSharedFromThis>
+#include <functional>
+#include <memory>
+#include "LogSource.h"
+#include "DecompressingDevice.h"
+
+class QTemporaryDir;
+
+/**
+ * @brief Archive whose directory has been read once, serving its entries as log sources.
+ *
+ * ZIP, TAR (plain or compressed with gzip, bzip2, xz or zstd) and 7z archives are supported,
+ * and archives inside archives are listed as directories of their own, up to maxNestingDepth
+ * levels, so a .tar.gz bundle of ZIP files can be browsed as a single tree.
+ *
+ * Opening a session lists every file entry with its size, compression method and the position
+ * of its data in its container: the archive file itself, or an archive inside it. Containers
+ * are read through a chain of RangeDevice and DecompressingDevice, one link per level, so
+ * nothing is unpacked to disk. Entries are then read in place: stored entries of archives that
+ * are not compressed as a whole are memory-mapped straight from the archive file by a
+ * MappedLogSource, everything else is decompressed through the chain by a CompressedLogSource.
+ * Listing a compressed TAR decompresses it once; the inflate checkpoints recorded on the way
+ * let sources jump into it later instead of decompressing it from the start.
+ *
+ * 7z archives are the exception: KArchive decodes them as a whole, so the requested entries
+ * are spooled to a temporary directory with one decode per archive, see prepare().
+ *
+ * createSource() only reads the immutable listing, so any number of entries can be opened
+ * concurrently from the ingestion thread pool. Every entry is identified by sourcePath(), the
+ * archive path followed by the entry path, so entries with the same file name in different
+ * folders of the archive stay apart.
+ */
+class ArchiveSession : public QEnableSharedFromThis<ArchiveSession>
+{
+public:
+    /**
+     * @brief File entry of the archive.
+     */
+    struct Entry {
+        QString path;               ///< Path of the entry inside the archive, nested archives included.
+        qint64 size = 0;            ///< Uncompressed size in bytes.
+        qint64 compressedSize = 0;  ///< Size of the data stored in the archive in bytes.
+        qint64 position = 0;        ///< Offset of the entry data in its container.
+        int encoding = 0;           ///< ZIP compression method, 0 for TAR and 7z entries; see createSource().
+        int container = 0;          ///< Container holding the entry data.
+    };
+
+    /**
+     * @brief Callback invoked while listing with the compressed bytes of the archive read so far and its size.
+     *        Returning false cancels opening.
+     */
+    using ProgressCallback = std::function<bool(qint64 bytesRead, qint64 bytesTotal)>;
+
+    /**
+     * @brief Levels of archives inside archives that are listed.
+     */
+    static constexpr int maxNestingDepth = 4;
+
+    /**
+     * @brief Returns true if the file name has the extension of a supported archive format.
+     * @param filePath Path or name of the file.
+     */
+    static bool isArchive(const QString &filePath);
+
+    /**
+     * @brief Lists the entries of an archive and of the archives inside it.
+     *
+     * ZIP and 7z archives are listed from their directory. TAR archives have none and are
+     * read from start to end, which for compressed ones means decompressing them once.
+     *
+     * @param archivePath Path of the archive.
+     * @param errorString Receives the description of the error if the archive cannot be read,
+     *        an empty string if opening was cancelled; may be nullptr.
+     * @param progress Optional callback invoked while reading TAR archives.
+     * @return The session, or a null pointer on failure.
+     */
+    static QSharedPointer<ArchiveSession> open(const QString &archivePath, QString *errorString,
+                                               const ProgressCallback &progress = ProgressCallback());
+
+    /**
+     * @brief Removes the spooled 7z entries.
+     */
+    ~ArchiveSession();
+
+    /**
+     * @brief Returns the path of the archive.
+     */
+    QString archivePath() const;
+
+    /**
+     * @brief Returns true if the archive has not been modified since the session was opened.
+     */
+    bool isCurrent() const;
+
+    /**
+     * @brief Returns all file entries, in the order of the archive directories.
+     */
+    const QVector<Entry> &entries() const;
+
+    /**
+     * @brief Returns the entry with the given path, or nullptr if there is none.
+     * @param entryPath Path of the entry inside the archive.
+     */
+    const Entry *entry(const QString &entryPath) const;
+
+    /**
+     * @brief Returns the path identifying the source of an entry, as stored in the tree view.
+     * @param entryPath Path of the entry inside the archive.
+     */
+    QString sourcePath(const QString &entryPath) const;
+
+    /**
+     * @brief Returns the name of an entry as it should appear in the tree view.
+     *
+     * This is the file name of the entry, or its full path inside the archive when other
+     * entries have the same file name.
+     *
+     * @param entryPath Path of the entry inside the archive.
+     */
+    QString displayName(const QString &entryPath) const;
+
+    /**
+     * @brief Announces the entries about to be opened, so that the 7z archives holding some
+     *        of them are decoded once for all of them instead of once per entry.
+     * @param entryPaths Paths of the entries inside the archive.
+     */
+    void prepare(const QStringList &entryPaths);
+
+    /**
+     * @brief Creates the source reading an entry in place. Safe to call from any thread.
+     *
+     * Stored entries (ZIP method 0 and TAR entries) whose container is not compressed are
+     * served by a MappedLogSource over their range of the archive file. Deflated entries
+     * (method 8), entries of compressed containers and entries that are compressed files
+     * themselves, such as app.log.gz, are served by a CompressedLogSource. Nothing is read
+     * until the source is opened, except for 7z entries, which are spooled first.
+     *
+     * @param entryPath Path of the entry inside the archive.
+     * @param errorString Receives the description of the error on failure; may be nullptr.
+     * @return The source, or a null pointer if the entry does not exist or its compression method is not supported.
+     */
+    QSharedPointer<LogSource> createSource(const QString &entryPath, QString *errorString) const;
+
+    /**
+     * @brief Opens a device streaming the uncompressed text of an entry. Safe to call from any thread.
+     *
+     * The entry is decompressed the same way as by the source createSource() would create,
+     * but without indexing it, e.g. to search it once.
+     *
+     * @param entryPath Path of the entry inside the archive.
+     * @param errorString Receives the description of the error on failure; may be nullptr.
+     * @return The opened device, or nullptr on failure; the caller takes ownership.
+     */
+    QIODevice *openEntry(const QString &entryPath, QString *errorString) const;
+
+private:
+    /**
+     * @brief Kind of archive, judging by the file name.
+     */
+    enum Format {
+        NoArchive,
+        Zip,
+        Tar,
+        SevenZip
+    };
+
+    /**
+     * @brief Data an archive is read from: a range of the archive file or of another container, optionally compressed.
+     */
+    struct Container {
+        int parent = -1;                                                        ///< Container the range lies in, -1 for the archive file.
+        qint64 offset = 0;                                                      ///< Start of the range in the parent.
+        qint64 length = 0;                                                      ///< Length of the range.
+        DecompressingDevice::Compression compression = DecompressingDevice::None; ///< Compression of the range.
+        qint64 size = -1;                                                       ///< Decompressed size, -1 if unknown.
+        QVector<GzipCheckpoint> checkpoints;                                    ///< Inflate checkpoints recorded while listing.
+        QString prefix;                                                         ///< Path of the archive inside the session, with a trailing /.
+        bool sevenZip = false;                                                  ///< True if this is a 7z archive, whose entries are spooled.
+    };
+
+    explicit ArchiveSession(const QString &archivePath);
+
+    /**
+     * @brief Returns the format of an archive and the compression of a compressed TAR.
+     */
+    static Format formatForPath(const QString &filePath, DecompressingDevice::Compression &compression);
+
+    /**
+     * @brief Adds a container and returns its index.
+     */
+    int addContainer(int parent, qint64 offset, qint64 length, DecompressingDevice::Compression compression, qint64 size);
+
+    /**
+     * @brief Lists an archive in a container and, recursively, the archives inside it.
+     * @param container Container holding the archive.
+     * @param format Format of the archive.
+     * @param prefix Path of the archive inside the session, with a trailing /, empty for the archive itself.
+     * @param depth Nesting level of the archive.
+     * @param progress Optional callback; nested archives only use it to check for cancellation.
+     * @param expanded Receives the indexes of entries that turned out to be archives and were listed.
+     * @param errorString Receives the description of the error; may be nullptr.
+     * @return False if the archive cannot be read or listing was cancelled.
+     */
+    bool list(int container, Format format, const QString &prefix, int depth, const ProgressCallback &progress,
+              QSet<int> &expanded, QString *errorString);
+
+    /**
+     * @brief Appends the entries of a ZIP or 7z archive, read with KArchive.
+     */
+    bool listKArchive(int container, Format format, const QString &prefix, QString *errorString);
+
+    /**
+     * @brief Appends the entries of a TAR archive, read header by header.
+     */
+    bool listTar(int container, const QString &prefix, const ProgressCallback &progress, QString *errorString);
+
+    /**
+     * @brief Opens a new device over a range of a container, or of the archive file for -1.
+     * @return The opened device, or nullptr on errors; the caller takes ownership.
+     */
+    QIODevice *openRange(int parent, qint64 offset, qint64 length, DecompressingDevice::Compression compression,
+                         qint64 size, const QVector<GzipCheckpoint> &checkpoints = QVector<GzipCheckpoint>()) const;
+
+    /**
+     * @brief Opens a new device over the contents of a container.
+     * @return The opened device, or nullptr on errors; the caller takes ownership.
+     */
+    QIODevice *openContainer(int container) const;
+
+    /**
+     * @brief Translates an offset in a container to an offset in the archive file.
+     * @return False if the container is compressed or lies in a compressed container.
+     */
+    bool diskOffset(int container, qint64 offset, qint64 &result) const;
+
+    /**
+     * @brief Returns the path of a spooled 7z entry, decoding its archive if it has not been spooled yet.
+     * @return The path, or an empty string on errors.
+     */
+    QString spool(const Entry &entry, QString *errorString) const;
+
+    QString path;                       ///< Path of the archive.
+    qint64 archiveSize = 0;             ///< Size of the archive when the session was opened.
+    qint64 modified = 0;                ///< Modification time of the archive when the session was opened, in ms since the epoch.
+    QVector<Container> containers;      ///< Containers, containers[0] is the archive file.
+    QVector<Entry> entryList;           ///< File entries of the archive.
+    QHash<QString, int> entryIndex;     ///< Index in entryList of every entry, keyed by path.
+    QSet<QString> sharedNames;          ///< File names used by more than one entry.
+
+    mutable QMutex spoolMutex;                      ///< Guards the members below.
+    mutable std::unique_ptr<QTemporaryDir> spoolDir; ///< Directory of the spooled 7z entries, created on first use.
+    mutable QHash<QString, QString> spooled;        ///< Spooled file of every spooled 7z entry, keyed by entry path.
+    mutable QSet<QString> requested;                ///< 7z entries announced by prepare() and not spooled yet.
+};
+
+#endif // ARCHIVESESSION_H
@@ -0,0 +1,140 @@
+#ifndef COMPRESSEDLOGSOURCE_H
+#define COMPRESSEDLOGSOURCE_H
+
+#include <QMutex>
+#include <QCache>
+#include <functional>
+#include <memory>
+#include "LogSource.h"
+#include "DecompressingDevice.h"
+
+/**
+ * @brief LogSource over a gzip, bzip2, xz or zstd compressed log file, or over compressed data inside an archive.
+ *
+ * The data is inflated straight into the LineScanner, one buffer at a time: nothing is
+ * decompressed to a temporary file and the inflated text is never held in memory as a whole.
+ * Lines are read back by inflating the data again up to the requested block; the most
+ * recently used blocks are kept in a small cache, so scrolling through a region of the log
+ * does not inflate it over and over.
+ *
+ * Decompression goes through a DecompressingDevice. For gzip and raw deflate data it records
+ * inflate checkpoints while indexing, so reaching any block costs at most
+ * GzipDevice::checkpointSpan bytes of decompression; the other formats are inflated from the
+ * start. Line indexes and checkpoints of large sources are persisted in the IndexCache.
+ *
+ * Sources inside archives get their compressed data from an Input, which can be a range of
+ * the archive file or a device chain decompressing outer layers, such as a deflated entry of
+ * a ZIP file inside a .tar.gz.
+ */
+class CompressedLogSource : public LogSource
+{
+public:
+    /**
+     * @brief Where the compressed data of a source inside an archive comes from.
+     */
+    struct Input {
+        std::function<QIODevice *()> open;  ///< Creates a new random-access device over the compressed data, nullptr on errors.
+        qint64 length = 0;                  ///< Length of the compressed data.
+        QString diskPath;                   ///< File on disk the data is read from, checked by open().
+        qint64 diskOffset = 0;              ///< Start of the range of diskPath identifying the data in the IndexCache.
+        qint64 diskLength = 0;              ///< Length of that range.
+    };
+
+    /**
+     * @brief Returns true if the file name has the extension of a supported compression format.
+     * @param filePath Path of the file.
+     */
+    static bool isCompressed(const QString &filePath);
+
+    /**
+     * @brief Constructs a source for the given file. Nothing is read until open() is called.
+     * @param filePath Path of the compressed log file on disk.
+     */
+    explicit CompressedLogSource(const QString &filePath);
+
+    /**
+     * @brief Constructs a source for compressed data stored inside an archive.
+     * @param filePath Path identifying the source, e.g. the archive path followed by the entry path.
+     * @param input Where the compressed data comes from.
+     * @param compression Compression of the data; None serves the input as it is.
+     */
+    CompressedLogSource(const QString &filePath, const Input &input, DecompressingDevice::Compression compression);
+
+    /**
+     * @brief Closes the underlying file.
+     */
+    ~CompressedLogSource() override;
+
+    /**
+     * @brief Opens the data and checks that its compression format can be read.
+     * @return True on success; false otherwise, in which case errorString() describes the failure.
+     */
+    bool open() override;
+
+    /**
+     * @brief Builds the line-offset index while inflating the data in a single streaming pass.
+     *
+     * Offsets refer to the decompressed text. Progress reports the compressed bytes read
+     * as well as the decompressed bytes indexed. Unchanged data whose index is in the
+     * IndexCache is not inflated at all.
+     *
+     * @param progress Optional callback invoked after every chunk.
+     * @return True if all data was indexed; false if it could not be read, is corrupt or indexing was cancelled.
+     */
+    bool buildIndex(const ProgressCallback &progress = ProgressCallback()) override;
+
+    /**
+     * @brief Returns the size of the compressed data in bytes.
+     */
+    qint64 inputSize() const override;
+
+protected:
+    /**
+     * @brief Returns a copy of the requested decompressed bytes, assembled from cached blocks.
+     */
+    QByteArray readRange(qint64 offset, qint64 length, BytesLease *lease) const override;
+
+    /**
+     * @brief Extrapolates the decompressed size from the share of the compressed data indexed so far.
+     */
+    qint64 expectedSize() const override;
+
+private:
+    Input input;                                            ///< Compressed data.
+    DecompressingDevice::Compression compression;           ///< Compression of the data.
+    bool wholeFile = false;                                 ///< True for a compressed file on disk, sized by open().
+    qint64 modified = 0;                                    ///< Modification time of the file on disk when it was opened, in ms since the epoch.
+    QVector<GzipCheckpoint> checkpoints;                    ///< Inflate checkpoints of gzip and deflate data, guarded by lock.
+    qint64 inputRead = 0;                                   ///< Compressed bytes consumed by indexing so far, guarded by lock.
+    mutable QMutex readMutex;                               ///< Serializes readers of the decompressed text.
+    mutable std::unique_ptr<DecompressingDevice> reader;    ///< Device inflating blocks for readRange().
+    mutable QCache<qint64, QByteArray> blocks;              ///< Recently read blocks, keyed by block number.
+
+    /**
+     * @brief Opens a new device over the decompressed text, seeded with the known checkpoints.
+     * @param errorString Receives the description of the error on failure; may be nullptr.
+     * @return The device, or nullptr if the data cannot be read.
+     */
+    std::unique_ptr<DecompressingDevice> openText(QString *errorString) const;
+
+    /**
+     * @brief Adopts the cached index if the data is unchanged since it was cached.
+     * @return True if the cached index was adopted.
+     */
+    bool restoreFromCache();
+
+    /**
+     * @brief Persists the complete index and the checkpoints to the on-disk cache.
+     */
+    void saveToCache() const;
+
+    /**
+     * @brief Returns a decompressed block, inflating the data up to it if it is not cached.
+     *        The caller must hold readMutex; the pointer is valid until the next call.
+     * @param index Block number.
+     * @return The block, shorter than the block size at the end of the data; nullptr on read errors.
+     */
+    const QByteArray *block(qint64 index) const;
+};
+
+#endif // COMPRESSEDLOGSOURCE_H
@@ -0,0 +1,135 @@
+#ifndef DECOMPRESSINGDEVICE_H
+#define DECOMPRESSINGDEVICE_H
+
+#include <QIODevice>
+#include <QString>
+#include <QVector>
+#include <memory>
+#include "GzipDevice.h"
+
+/**
+ * @brief Random-access device over the decompressed bytes of compressed data.
+ *
+ * Reading goes through a GzipDevice for gzip and raw deflate data and through
+ * KCompressionDevice for bzip2, xz and zstd. Seeking forward decompresses and discards the
+ * bytes in between. Seeking back restarts at the nearest GzipCheckpoint, which are recorded
+ * while reading and can be handed in from an earlier pass, or at the start for the formats
+ * without checkpoints. With None the device simply passes the input through.
+ *
+ * Devices can be stacked, e.g. to read a deflated ZIP entry of a ZIP file inside a .tar.gz,
+ * through a RangeDevice over each level.
+ */
+class DecompressingDevice : public QIODevice
+{
+    Q_OBJECT
+
+public:
+    /**
+     * @brief Compression of the input.
+     */
+    enum Compression {
+        None,       ///< Not compressed.
+        Gzip,       ///< One or more gzip members.
+        RawDeflate, ///< Deflate data without framing, as in ZIP entries.
+        BZip2,      ///< bzip2.
+        Xz,         ///< xz.
+        Zstd        ///< Zstandard.
+    };
+
+    /**
+     * @brief Returns the compression of a file judging by its extension, None if it has no known one.
+     * @param filePath Path or name of the file.
+     */
+    static Compression compressionForPath(const QString &filePath);
+
+    /**
+     * @brief Constructs a device decompressing the given input.
+     * @param input Random-access device over the compressed data; the device takes ownership of it.
+     * @param compression Compression of the input.
+     * @param parent The parent QObject.
+     */
+    DecompressingDevice(QIODevice *input, Compression compression, QObject *parent = nullptr);
+
+    /**
+     * @brief Releases the decompressor before the input it reads from.
+     */
+    ~DecompressingDevice() override;
+
+    /**
+     * @brief Opens the input if needed and starts decompressing from the beginning; only ReadOnly is supported.
+     */
+    bool open(OpenMode mode) override;
+
+    /**
+     * @brief Returns false; any position can be read, see the class description for the cost.
+     */
+    bool isSequential() const override;
+
+    /**
+     * @brief Returns the decompressed size if known, otherwise the furthest position decompressed so far.
+     */
+    qint64 size() const override;
+
+    /**
+     * @brief Sets the decompressed size, if it is known in advance.
+     */
+    void setSize(qint64 size);
+
+    /**
+     * @brief Hands in checkpoints recorded earlier for the same data, in increasing order.
+     */
+    void setCheckpoints(const QVector<GzipCheckpoint> &checkpoints);
+
+    /**
+     * @brief Returns all checkpoints known so far, in increasing order.
+     */
+    QVector<GzipCheckpoint> checkpoints() const;
+
+    /**
+     * @brief Returns how many compressed bytes have been consumed so far.
+     */
+    qint64 inputPosition() const;
+
+    /**
+     * @brief Moves to the position at or before target from which target can be reached the quickest.
+     *
+     * This is where the decompressor already is, if reading on is the cheapest way, or the
+     * nearest checkpoint. Reading from there passes through all bytes up to target, so callers
+     * can keep those instead of having them discarded by a plain seek().
+     *
+     * @param target Decompressed offset.
+     * @return The new position, or -1 on errors.
+     */
+    qint64 restartBefore(qint64 target);
+
+protected:
+    qint64 readData(char *data, qint64 maxSize) override;
+    qint64 writeData(const char *data, qint64 maxSize) override;
+
+private:
+    QIODevice *input;                           ///< Compressed data, owned through the QObject tree.
+    Compression compression;                    ///< Compression of the input.
+    std::unique_ptr<QIODevice> decompressor;    ///< GzipDevice or KCompressionDevice over the input.
+    qint64 streamPosition = 0;                  ///< Decompressed offset the decompressor is at.
+    qint64 knownSize = -1;                      ///< Decompressed size, -1 while unknown.
+    qint64 furthest = 0;                        ///< Furthest decompressed offset reached.
+    QVector<GzipCheckpoint> points;             ///< Known checkpoints, in increasing order.
+
+    /**
+     * @brief Creates a new decompressor reading from the start of the input.
+     */
+    bool startOver();
+
+    /**
+     * @brief Positions the decompressor like restartBefore() without moving the device position.
+     * @return The decompressed offset of the decompressor, or -1 on errors.
+     */
+    qint64 reposition(qint64 target);
+
+    /**
+     * @brief Adds the checkpoints the GzipDevice recorded beyond the known ones.
+     */
+    void collectCheckpoints();
+};
+
+#endif // DECOMPRESSINGDEVICE_H
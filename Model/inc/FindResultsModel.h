@@ -0,0 +1,117 @@
+#ifndef FINDRESULTSMODEL_H
+#define FINDRESULTSMODEL_H
+
+#include <QAbstractListModel>
+#include <QSharedPointer>
+#include <QVector>
+#include "LogSource.h"
+#include "LogSearch.h"
+
+/**
+ * @brief List model of the lines found by a LogSearch or GroupSearch, one row per matching line.
+ *
+ * Rows hold no text: the model keeps the hits of the search, which reference the file, line
+ * and match ranges, plus the file and first hit of every row. A line is decoded from the
+ * source only when a view asks for it, which a QListView with uniform item sizes does for the
+ * rows it paints. A million hits cost about 20 MB this way, whatever the length of the lines.
+ *
+ * Results of several files are listed file after file, or merged by the timestamps of their
+ * lines; rows of such results start with the name of the file and the line number.
+ */
+class FindResultsModel : public QAbstractListModel
+{
+    Q_OBJECT
+
+public:
+    static constexpr int LineRole = Qt::UserRole + 1;       ///< Role returning the zero-based line number of a row.
+    static constexpr int ColumnRole = Qt::UserRole + 2;     ///< Role returning the column of the first match in a row.
+    static constexpr int LengthRole = Qt::UserRole + 3;     ///< Role returning the length of the first match in a row.
+    static constexpr int FilePathRole = Qt::UserRole + 4;   ///< Role returning the path of the file of a row.
+    static constexpr qint64 maxDisplayBytes = 4096;         ///< Bytes of a line shown, longer lines are cut.
+
+    /**
+     * @brief Constructs an empty model.
+     * @param parent The parent QObject.
+     */
+    explicit FindResultsModel(QObject *parent = nullptr);
+
+    /**
+     * @brief Replaces the results.
+     * @param source Log the hits were found in.
+     * @param filePath Path of the log file.
+     * @param hits Occurrences sorted by line and column, as returned by LogSearch::hits(); shared, not copied.
+     */
+    void setResults(const QSharedPointer<LogSource> &source, const QString &filePath, const QVector<LogSearch::Hit> &hits);
+
+    /**
+     * @brief Occurrences found in one file.
+     */
+    struct File {
+        QString filePath;                   ///< Path of the log file.
+        QSharedPointer<LogSource> source;   ///< Log the hits were found in.
+        QVector<LogSearch::Hit> hits;       ///< Occurrences sorted by line and column.
+    };
+
+    /**
+     * @brief Order of the rows of results of several files.
+     */
+    enum Order {
+        ByFileAndLine,  ///< File after file in the given order, by line within a file.
+        ByTimestamp     ///< By the timestamp of the line; lines without one keep their place in their file.
+    };
+
+    /**
+     * @brief Replaces the results by those of several files.
+     * @param files Occurrences per file; files without any are left out.
+     * @param order Order of the rows.
+     */
+    void setResults(const QVector<File> &files, Order order);
+
+    /**
+     * @brief Removes all results.
+     */
+    void clear();
+
+    /**
+     * @brief Returns the path of the file the results belong to, empty if there are none or they span several files.
+     */
+    QString filePath() const;
+
+    /**
+     * @brief Returns true if the results were set from several files.
+     */
+    bool isCrossFile() const;
+
+    /**
+     * @brief Returns the occurrences shown for the file of filePath(), empty for results of several files.
+     */
+    QVector<LogSearch::Hit> hits() const;
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+
+private:
+    /**
+     * @brief Matching line shown in a row.
+     */
+    struct Row {
+        qint32 file;        ///< Index into files.
+        qint32 firstHit;    ///< Index into the hits of the file of the first hit on the line.
+    };
+
+    QVector<File> files;                ///< Occurrences per file.
+    QVector<Row> rows;                  ///< Line shown in every row.
+    bool crossFile = false;             ///< True if the results were set from several files.
+
+    /**
+     * @brief Replaces the results and builds the rows.
+     */
+    void setFiles(const QVector<File> &files, Order order, bool crossFile);
+
+    /**
+     * @brief Returns the number of hits on the line of a row.
+     */
+    qint32 hitCount(const Row &row) const;
+};
+
+#endif // FINDRESULTSMODEL_H
@@ -0,0 +1,116 @@
+#ifndef GROUPSEARCH_H
+#define GROUPSEARCH_H
+
+#include <QObject>
+#include <QString>
+#include <QVector>
+#include <QSharedPointer>
+#include <QThreadPool>
+#include "LogSource.h"
+#include "LogSearch.h"
+#include "LineMatcher.h"
+
+/**
+ * @brief Searches several logs at once, e.g. all files of a group, on one shared thread pool.
+ *
+ * Every file is searched by a LogSearch of its own whose chunks are queued on the pool of this
+ * search, file after file, so all cores stay busy until the last chunk of the last file and a
+ * small file does not wait for a big one to finish. Results arrive per file through
+ * fileSearched() as soon as a file is done; results() holds all of them, in the order the
+ * files were given. Like a single LogSearch, the searches may run over files that are being
+ * followed and refreshed at the same time.
+ */
+class GroupSearch : public QObject
+{
+    Q_OBJECT
+
+public:
+    /**
+     * @brief Log to search.
+     */
+    struct Target {
+        QString filePath;                   ///< Path of the log file.
+        QSharedPointer<LogSource> source;   ///< Indexed lines of the file.
+    };
+
+    /**
+     * @brief Occurrences found in one log.
+     */
+    struct FileResult {
+        QString filePath;                   ///< Path of the log file.
+        QSharedPointer<LogSource> source;   ///< Log the hits were found in.
+        QVector<LogSearch::Hit> hits;       ///< Occurrences, sorted by line and column.
+        bool truncated = false;             ///< True if the file has more occurrences than were kept.
+    };
+
+    /**
+     * @brief Constructs an idle search.
+     * @param parent The parent QObject.
+     */
+    explicit GroupSearch(QObject *parent = nullptr);
+
+    /**
+     * @brief Cancels a running search and waits for its workers.
+     */
+    ~GroupSearch() override;
+
+    /**
+     * @brief Starts searching the logs, cancelling a search that is still running.
+     * @param targets Logs to search.
+     * @param matcher Text or regular expression to search for.
+     * @param maxHitsPerFile Number of occurrences kept per file.
+     */
+    void start(const QVector<Target> &targets, const LineMatcher &matcher, qint64 maxHitsPerFile = 1000000);
+
+    /**
+     * @brief Stops the search; files being searched stop at their next candidate.
+     */
+    void cancel();
+
+    /**
+     * @brief Returns true while a search is running.
+     */
+    bool isRunning() const;
+
+    /**
+     * @brief Returns the occurrences per file of the current or last search; files not searched yet have none.
+     */
+    const QVector<FileResult> &results() const;
+
+signals:
+    /**
+     * @brief Emitted for every file once it has been searched.
+     * @param filePath Path of the log file.
+     * @param hitCount Number of occurrences kept for it.
+     */
+    void fileSearched(const QString &filePath, qint64 hitCount);
+
+    /**
+     * @brief Emitted after every searched file.
+     * @param filesDone Files searched so far.
+     * @param filesTotal Files to search.
+     * @param hitsFound Occurrences found so far.
+     */
+    void progress(int filesDone, int filesTotal, qint64 hitsFound);
+
+    /**
+     * @brief Emitted when all files have been searched or the search was cancelled.
+     * @param cancelled True if cancel() was called.
+     */
+    void finished(bool cancelled);
+
+private:
+    QThreadPool pool;                   ///< Worker threads shared by the searches of all files.
+    QVector<LogSearch *> searches;      ///< Search of every file; kept for the lifetime of this object, as tasks may still refer to them.
+    QVector<FileResult> fileResults;    ///< Occurrences per file of the current search.
+    int filesDone = 0;                  ///< Files of the current search searched so far.
+    qint64 hitsFound = 0;               ///< Occurrences found by the current search so far.
+    bool running = false;               ///< True while the current search has unfinished files.
+
+    /**
+     * @brief Collects the results of a file on the owning thread and emits the signals.
+     */
+    void onFileSearched(int file, bool cancelled);
+};
+
+#endif // GROUPSEARCH_H
@@ -0,0 +1,120 @@
+#ifndef GZIPDEVICE_H
+#define GZIPDEVICE_H
+
+#include <QIODevice>
+#include <QByteArray>
+#include <QVector>
+#include <memory>
+
+struct z_stream_s;
+
+/**
+ * @brief Position in a gzip file where inflating can be restarted without decompressing what precedes it.
+ */
+struct GzipCheckpoint {
+    quint64 input = 0;      ///< Offset in the compressed file of the first byte not completely consumed.
+    quint64 output = 0;     ///< Decompressed offset the checkpoint corresponds to.
+    int bits = 0;           ///< Number of bits of the byte before input that still belong to the next block.
+    QByteArray window;      ///< Up to 32 KB of preceding decompressed data, the dictionary of the next block.
+};
+
+/**
+ * @brief Sequential device inflating a gzip file, or raw deflate data, with zlib, seekable through checkpoints.
+ *
+ * While reading from the start, the device can record a GzipCheckpoint at a deflate block
+ * boundary every checkpointSpan decompressed bytes, zran style: the compressed position,
+ * the bit offset within it and the 32 KB sliding window. Later, restartAt() resumes inflating
+ * at any recorded checkpoint, so reaching a given decompressed offset costs at most one span
+ * of decompression instead of everything before it. Concatenated gzip members, as written by
+ * pigz or by appending to a .gz file, are read as one stream. Raw deflate data, such as a
+ * deflated ZIP entry, is read the same way without gzip framing.
+ */
+class GzipDevice : public QIODevice
+{
+    Q_OBJECT
+
+public:
+    /**
+     * @brief Decompressed distance between two recorded checkpoints.
+     */
+    static constexpr qint64 checkpointSpan = 4 * 1024 * 1024;
+
+    /**
+     * @brief Framing of the compressed data.
+     */
+    enum Format {
+        Gzip,       ///< One or more gzip members.
+        RawDeflate  ///< A single deflate stream without header or trailer.
+    };
+
+    /**
+     * @brief Constructs a device inflating the given compressed data.
+     * @param input Random-access device over the compressed data, opened for reading; not owned.
+     * @param format Framing of the compressed data.
+     * @param parent The parent QObject.
+     */
+    explicit GzipDevice(QIODevice *input, Format format = Gzip, QObject *parent = nullptr);
+
+    /**
+     * @brief Releases the zlib state.
+     */
+    ~GzipDevice() override;
+
+    /**
+     * @brief Opens the device for reading from the start of the compressed data; only ReadOnly is supported.
+     */
+    bool open(OpenMode mode) override;
+
+    /**
+     * @brief Closes the device.
+     */
+    void close() override;
+
+    /**
+     * @brief Returns true; the device is read front to back, see restartAt() for random access.
+     */
+    bool isSequential() const override;
+
+    /**
+     * @brief Enables or disables recording checkpoints while reading.
+     */
+    void setRecordCheckpoints(bool enabled);
+
+    /**
+     * @brief Returns the checkpoints recorded since the last call, in increasing order.
+     */
+    QVector<GzipCheckpoint> takeCheckpoints();
+
+    /**
+     * @brief Continues inflating at a checkpoint recorded earlier for the same file.
+     * @param checkpoint Where to continue.
+     * @return True on success; false if the input cannot be positioned.
+     */
+    bool restartAt(const GzipCheckpoint &checkpoint);
+
+    /**
+     * @brief Returns the decompressed offset of the next byte to be read.
+     */
+    qint64 outputPosition() const;
+
+protected:
+    qint64 readData(char *data, qint64 maxSize) override;
+    qint64 writeData(const char *data, qint64 maxSize) override;
+
+private:
+    QIODevice *input;                       ///< Compressed data.
+    Format format;                          ///< Framing of the compressed data.
+    std::unique_ptr<z_stream_s> stream;     ///< zlib inflate state.
+    QByteArray inputBuffer;                 ///< Compressed bytes handed to zlib.
+    qint64 inputEnd = 0;                    ///< Offset in the compressed file one past inputBuffer's last byte.
+    qint64 output = 0;                      ///< Decompressed offset of the next byte to be read.
+    qint64 lastCheckpoint = 0;              ///< Decompressed offset of the last recorded checkpoint.
+    bool recordCheckpoints = false;         ///< Set by setRecordCheckpoints().
+    QVector<GzipCheckpoint> recorded;       ///< Checkpoints not taken yet.
+    bool raw = false;                       ///< True while inflating a raw deflate stream after restartAt().
+    bool memberEnded = false;               ///< True between the end of a gzip member and the start of the next.
+    qint64 trailerToSkip = 0;               ///< Bytes of a gzip trailer still to skip after a raw stream ended.
+    bool finished = false;                  ///< Set once the end of the compressed data has been reached.
+};
+
+#endif // GZIPDEVICE_H
@@ -0,0 +1,107 @@
+#ifndef INDEXCACHE_H
+#define INDEXCACHE_H
+
+#include <QString>
+#include <QVector>
+#include "GzipDevice.h"
+
+/**
+ * @brief Persistent, versioned on-disk cache of line-offset indexes.
+ *
+ * Every indexed file gets one binary sidecar under QStandardPaths::CacheLocation, named after
+ * a hash of the file path. Besides the line offsets and per-line timestamps it records the
+ * file size, modification time and hashes of the first and last indexed bytes, which lets a
+ * reopened file be recognized as unchanged, or as only appended to, without rescanning it.
+ * For gzip files the inflate checkpoints are stored as well, so that a reopened file can be
+ * read at any offset straight away.
+ *
+ * Sidecars take 16 bytes per line, so the cache is kept within maximumCacheSize. Saves keep a
+ * running total of the cache size, counted once by the first save of the process, and prune
+ * only once it exceeds the budget: then the sidecars of files that no longer exist are removed,
+ * and the least recently used ones until the rest fits. Loading a sidecar marks it as used.
+ */
+class IndexCache
+{
+public:
+    /**
+     * @brief Everything stored for one file.
+     */
+    struct Entry {
+        QString filePath;               ///< Path of the indexed file, guards against hash collisions.
+        quint64 fileSize = 0;           ///< Size of the file when it was indexed.
+        quint64 textSize = 0;           ///< Size of the indexed text; larger than fileSize for compressed files.
+        qint64 modified = 0;            ///< Modification time when it was indexed, in ms since the epoch.
+        quint64 headHash = 0;           ///< Hash of the first headTailSize bytes.
+        quint64 tailHash = 0;           ///< Hash of the last headTailSize bytes.
+        qint64 longestLine = 0;         ///< Length of the longest line.
+        bool timestampsSorted = true;   ///< True if the timestamps never decrease.
+        QVector<quint64> lineOffsets;   ///< Byte offset of every line start.
+        QVector<qint64> timestamps;     ///< Timestamp of every line, see TimestampParser.
+        QVector<GzipCheckpoint> checkpoints; ///< Inflate checkpoints of a gzip file, empty otherwise.
+    };
+
+    /**
+     * @brief Number of bytes hashed at the start and at the end of a file.
+     */
+    static constexpr qint64 headTailSize = 64 * 1024;
+
+    /**
+     * @brief Files smaller than this are cheaper to rescan than to look up.
+     */
+    static constexpr qint64 minimumFileSize = 1024 * 1024;
+
+    /**
+     * @brief Total size of all sidecars beyond which the least recently used ones are removed.
+     */
+    static constexpr qint64 maximumCacheSize = 1024LL * 1024 * 1024;
+
+    /**
+     * @brief Returns the sidecar path used for a file.
+     * @param filePath Path of the indexed file.
+     */
+    static QString cachePath(const QString &filePath);
+
+    /**
+     * @brief Loads the cached index of a file.
+     * @param filePath Path of the indexed file.
+     * @param entry Receives the cached data.
+     * @return True if a readable sidecar of the current version exists for this path.
+     */
+    static bool load(const QString &filePath, Entry &entry);
+
+    /**
+     * @brief Writes the index of a file to its sidecar, replacing any previous one atomically, and prunes the cache if it outgrew maximumCacheSize.
+     * @param entry Data to store; entry.filePath selects the sidecar.
+     * @return True on success.
+     */
+    static bool save(const Entry &entry);
+
+    /**
+     * @brief Removes the sidecars of files that no longer exist, then the least recently used ones beyond maximumCacheSize.
+     *
+     * Scans the whole cache directory and recounts the running total of the cache size.
+     *
+     * @param keepPath Sidecar that is never removed, e.g. the one just written.
+     */
+    static void prune(const QString &keepPath = QString());
+
+    /**
+     * @brief Hashes a range of bytes with 64-bit FNV-1a.
+     * @param data Start of the range.
+     * @param length Number of bytes to hash.
+     */
+    static quint64 hash(const uchar *data, qint64 length);
+
+    /**
+     * @brief Hashes the first and last headTailSize bytes of a range of a file that is not mapped.
+     * @param filePath Path of the file.
+     * @param offset Start of the range, e.g. of an entry inside an archive.
+     * @param length Number of bytes of the range.
+     * @param headHash Receives the hash of the first bytes.
+     * @param tailHash Receives the hash of the last bytes.
+     * @return False if the file cannot be read.
+     */
+    static bool hashFile(const QString &filePath, qint64 offset, qint64 length, quint64 &headHash, quint64 &tailHash);
+};
+
+#endif // INDEXCACHE_H
@@ -0,0 +1,107 @@
+#ifndef INGESTTASK_H
+#define INGESTTASK_H
+
+#include <QObject>
+#include <QRunnable>
+#include <QString>
+#include <QSharedPointer>
+#include <atomic>
+#include "LogSource.h"
+#include "ArchiveSession.h"
+
+/**
+ * @brief Background job that opens and indexes one log file or one entry of an archive.
+ *
+ * Tasks are executed on the LogManager thread pool. All signals are emitted from the worker
+ * thread and must be connected with Qt::QueuedConnection. The task is not auto-deleted so that
+ * its source can still be fetched when the queued signals arrive.
+ */
+class IngestTask : public QObject, public QRunnable
+{
+    Q_OBJECT
+
+public:
+    /**
+     * @brief Creates a task that indexes a plain log file.
+     * @param filePath Path of the log file.
+     * @param groupName Group the file will be added to.
+     * @param parent The parent QObject.
+     */
+    IngestTask(const QString &filePath, const QString &groupName, QObject *parent = nullptr);
+
+    /**
+     * @brief Creates a task that indexes an entry of an archive in place.
+     * @param archive Session of the archive, shared by all tasks of the same archive.
+     * @param entryPath Path of the entry inside the archive.
+     * @param groupName Group the file will be added to.
+     * @param parent The parent QObject.
+     */
+    IngestTask(const QSharedPointer<ArchiveSession> &archive, const QString &entryPath, const QString &groupName, QObject *parent = nullptr);
+
+    /**
+     * @brief Opens and indexes the file. Runs on a worker thread.
+     */
+    void run() override;
+
+    /**
+     * @brief Requests cancellation. The task stops after the chunk it is currently indexing.
+     */
+    void cancel();
+
+    /**
+     * @brief Returns true if cancel() has been called.
+     */
+    bool isCancelled() const;
+
+    /**
+     * @brief Returns the group the file will be added to.
+     */
+    QString groupName() const;
+
+    /**
+     * @brief Returns the name of the file as it should appear in the tree view.
+     */
+    QString displayName() const;
+
+    /**
+     * @brief Returns the source being indexed. Valid once sourceReady() has been emitted.
+     */
+    QSharedPointer<LogSource> source() const;
+
+signals:
+    /**
+     * @brief Emitted once the first chunk of the file is indexed and its lines can be browsed.
+     *
+     * Not emitted if the task is cancelled or indexing fails before the first chunk.
+     */
+    void sourceReady();
+
+    /**
+     * @brief Emitted periodically while indexing.
+     * @param bytesRead Bytes of this file read from disk so far.
+     * @param bytesIndexed Bytes of this file indexed so far; more than bytesRead for compressed files.
+     * @param linesIndexed Lines of this file indexed so far.
+     */
+    void progress(qint64 bytesRead, qint64 bytesIndexed, qint64 linesIndexed);
+
+    /**
+     * @brief Emitted when the task fails.
+     * @param error Description of the error.
+     */
+    void failed(const QString &error);
+
+    /**
+     * @brief Emitted when the task is done, whether it succeeded, failed or was cancelled.
+     */
+    void finished();
+
+private:
+    QString filePath;                           ///< Path of the log file, empty for archive entries.
+    QSharedPointer<ArchiveSession> archive;     ///< Archive the entry belongs to, null for plain files.
+    QString entryPath;                          ///< Path of the entry inside the archive, empty for plain files.
+    QString group;                              ///< Group the file will be added to.
+    QSharedPointer<LogSource> logSource;        ///< Source being indexed.
+    std::atomic_bool cancelled{false};          ///< Set by cancel().
+};
+
+#endif // INGESTTASK_H
@@ -0,0 +1,52 @@
+#ifndef LINELEXER_H
+#define LINELEXER_H
+
+#include <QString>
+#include <QVector>
+
+/**
+ * @brief Single-pass lexer finding the tokens of a log line worth highlighting.
+ *
+ * The rules are fixed in code rather than built from regular expressions at runtime: every
+ * position is looked at once, and a token candidate is only tried where a word starts. It
+ * recognizes severity levels (ERROR, WARN, INFO, DEBUG and their usual synonyms, in upper or
+ * title case), timestamps in the formats TimestampParser reads, IPv4 addresses with an
+ * optional port, UUIDs and decimal or hexadecimal numbers.
+ */
+class LineLexer
+{
+public:
+    /**
+     * @brief Kinds of tokens.
+     */
+    enum Kind : quint8 {
+        Error,      ///< ERROR, ERR, FATAL, CRITICAL, SEVERE.
+        Warning,    ///< WARN, WARNING.
+        Info,       ///< INFO, NOTICE.
+        Debug,      ///< DEBUG, TRACE, VERBOSE.
+        Timestamp,  ///< "YYYY-MM-DD HH:MM:SS" with an optional fraction.
+        Address,    ///< IPv4 address, optionally with a port.
+        Uuid,       ///< 8-4-4-4-12 hexadecimal digits.
+        Number,     ///< Decimal number, version-like dotted number or 0x hexadecimal number.
+        KindCount
+    };
+
+    /**
+     * @brief Token found in a line, as a range of UTF-16 code units.
+     */
+    struct Token {
+        int start = 0;          ///< First code unit.
+        int length = 0;         ///< Number of code units.
+        Kind kind = Number;     ///< What the token is.
+    };
+
+    using Tokens = QVector<Token>;
+
+    /**
+     * @brief Returns the tokens of a line, in order and not overlapping.
+     * @param line Text of the line, without its terminator.
+     */
+    static Tokens tokenize(const QString &line);
+};
+
+#endif // LINELEXER_H
@@ -0,0 +1,119 @@
+#ifndef LINEMATCHER_H
+#define LINEMATCHER_H
+
+#include <QString>
+#include <QRegularExpression>
+#include "TextSearcher.h"
+
+/**
+ * @brief Finds a literal text or a regular expression in log lines, with a byte-level prefilter.
+ *
+ * Matches are always found in decoded lines, so columns and lengths are in UTF-16 code units.
+ * Lines that cannot match are ruled out in their raw bytes first, by a TextSearcher for a
+ * literal every match has to contain: the text itself, or for a regular expression the
+ * longest run of literal characters that requiredLiteral() finds outside of groups and
+ * alternatives. The regular expression is compiled with the PCRE2 JIT once, up front.
+ *
+ * The prefilter folds ASCII letters only, so it is dropped for case-insensitive searches
+ * whose literal holds other characters. Const members are safe to call from several threads.
+ */
+class LineMatcher
+{
+public:
+    /**
+     * @brief Prepares a search.
+     * @param pattern Text or regular expression to search for.
+     * @param caseSensitivity Whether letters have to match in case.
+     * @param regularExpression True if pattern is a regular expression.
+     */
+    LineMatcher(const QString &pattern, Qt::CaseSensitivity caseSensitivity, bool regularExpression);
+
+    /**
+     * @brief Returns false if the regular expression does not compile; errorString() tells why.
+     */
+    bool isValid() const;
+
+    /**
+     * @brief Returns a description of the error in the regular expression.
+     */
+    QString errorString() const;
+
+    /**
+     * @brief Returns true if the pattern is empty, in which case nothing matches.
+     */
+    bool isEmpty() const;
+
+    /**
+     * @brief Returns true if lines have to contain the bytes found by literal() to match.
+     */
+    bool hasLiteral() const;
+
+    /**
+     * @brief Returns true if every match of literal() in the raw bytes is a match, so lines need not be decoded.
+     */
+    bool isLiteralExact() const;
+
+    /**
+     * @brief Returns the length of the literal text in UTF-16 code units, 0 for a regular expression.
+     */
+    qsizetype textLength() const;
+
+    /**
+     * @brief Returns the prefilter; only meaningful if hasLiteral() is true.
+     */
+    const TextSearcher &literal() const;
+
+    /**
+     * @brief Returns true if the raw bytes of a line may contain a match.
+     * @param bytes UTF-8 bytes of the line.
+     */
+    bool mayMatch(const QByteArray &bytes) const;
+
+    /**
+     * @brief Returns the first match starting at or after from, or -1 if there is none.
+     * @param line Decoded line.
+     * @param from Column to start searching at.
+     * @param length Receives the length of the match.
+     */
+    qsizetype indexIn(const QString &line, qsizetype from, qsizetype *length) const;
+
+    /**
+     * @brief Returns the last match starting at or before a column, or -1 if there is none.
+     * @param line Decoded line.
+     * @param before Last column a match may start at.
+     * @param length Receives the length of the match.
+     */
+    qsizetype lastIndexIn(const QString &line, qsizetype before, qsizetype *length) const;
+
+    /**
+     * @brief Returns true if every line this matcher matches is also matched by another one.
+     *
+     * This holds for literal texts searched for with the same case sensitivity, where this
+     * text contains the other one.
+     *
+     * @param other Matcher of an earlier search.
+     */
+    bool narrows(const LineMatcher &other) const;
+
+    /**
+     * @brief Returns the longest literal every match of a regular expression contains, or an empty string.
+     *
+     * Only the top level of the expression is looked at: groups, character classes, escapes
+     * other than of punctuation and optional characters end a run of literal characters, and
+     * an alternative or an inline option anywhere means there is no required literal.
+     * For "user=\d+ .*timeout" this is "timeout".
+     *
+     * @param pattern Regular expression in PCRE2 syntax.
+     */
+    static QString requiredLiteral(const QString &pattern);
+
+private:
+    QString text;                           ///< Literal text, for literal searches.
+    Qt::CaseSensitivity caseSensitivity;    ///< Whether letters have to match in case.
+    QRegularExpression expression;          ///< Compiled regular expression, invalid for literal searches.
+    TextSearcher searcher;                  ///< Prefilter over raw bytes.
+    bool prefilter = false;                 ///< True if searcher rules out lines.
+    bool exact = false;                     ///< True if searcher finds exactly the matches.
+};
+
+#endif // LINEMATCHER_H
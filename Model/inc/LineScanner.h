@@ -0,0 +1,115 @@
+#ifndef LINESCANNER_H
+#define LINESCANNER_H
+
+#include <QtGlobal>
+#include <QVector>
+
+/**
+ * @brief Vectorized line-boundary scanner used to build line-offset indexes.
+ *
+ * Finds '\n' bytes with an AVX2 or SSE2 kernel, chosen once at runtime from the CPU features,
+ * or with a scalar memchr() loop on other CPUs. Lines may end with "\n" or "\r\n"; the scanner
+ * records where every line starts and keeps track of the longest line without its terminator.
+ *
+ * A scanner is stateful so that a buffer can be scanned in consecutive chunks, or a stream
+ * of unknown length in consecutive buffers.
+ */
+class LineScanner
+{
+public:
+    /**
+     * @brief Kernels the scanner can dispatch to.
+     */
+    enum Kernel {
+        Scalar, ///< Portable memchr() loop.
+        SSE2,   ///< 16 bytes per iteration.
+        AVX2    ///< 32 bytes per iteration.
+    };
+
+    /**
+     * @brief Creates a scanner over a buffer.
+     * @param data Start of the buffer; it must stay valid while scanning.
+     * @param size Size of the whole buffer in bytes.
+     */
+    LineScanner(const char *data, qint64 size);
+
+    /**
+     * @brief Creates a scanner over a stream of unknown length, fed through scanBuffer().
+     *
+     * Until finish() is called the scanner cannot know whether a newline is the last byte
+     * of the stream, so it appends a line start for every newline; the caller drops a final
+     * offset equal to the stream length.
+     */
+    LineScanner();
+
+    /**
+     * @brief Scans the range [from, to) and appends the offset of every line starting after a newline in it.
+     *
+     * Ranges must be scanned in order and without gaps. No offset is appended for a newline
+     * that terminates the buffer, so a trailing newline does not produce an empty last line.
+     *
+     * @param from Offset of the first byte to scan.
+     * @param to Offset one past the last byte to scan.
+     * @param lineStarts Receives the line start offsets.
+     */
+    void scan(qint64 from, qint64 to, QVector<quint64> &lineStarts);
+
+    /**
+     * @brief Scans the next buffer of a stream and appends the stream offset of every line starting in it.
+     * @param buffer Bytes directly following the previously scanned ones.
+     * @param length Number of bytes in buffer.
+     * @param lineStarts Receives the line start offsets.
+     */
+    void scanBuffer(const char *buffer, qint64 length, QVector<quint64> &lineStarts);
+
+    /**
+     * @brief Marks the end of a stream, so that longestLine() accounts for an unterminated last line.
+     */
+    void finish();
+
+    /**
+     * @brief Continues scanning from a previously indexed position instead of the start of the buffer.
+     * @param lineStart Offset of the start of the line that was not terminated yet.
+     * @param longestSoFar Length of the longest line before lineStart.
+     */
+    void resume(qint64 lineStart, qint64 longestSoFar);
+
+    /**
+     * @brief Returns the length of the longest line seen so far, including an unterminated last line.
+     */
+    qint64 longestLine() const;
+
+    /**
+     * @brief Returns the kernel selected for this CPU, or the one set by setKernel().
+     */
+    static Kernel kernel();
+
+    /**
+     * @brief Overrides the kernel of all scanners and of TextSearcher, e.g. to compare kernels in a benchmark.
+     *
+     * Kernels the CPU does not support fall back to the best one it does.
+     *
+     * @param kernel Kernel to use from now on.
+     */
+    static void setKernel(Kernel kernel);
+
+    /**
+     * @brief Returns a printable name of the kernel in use.
+     */
+    static const char *kernelName();
+
+private:
+    const char *data;           ///< Buffer being scanned.
+    qint64 size;                ///< Size of the buffer.
+    qint64 lineStart = 0;       ///< Offset where the current, not yet terminated line starts.
+    qint64 longest = 0;         ///< Longest terminated line so far.
+    qint64 scannedEnd = 0;      ///< Offset one past the last scanned byte.
+    char lastByte = '\0';       ///< Last scanned byte, needed for "\r\n" split across buffers.
+
+    /**
+     * @brief Dispatches the range [from, to) of buffer to the selected kernel.
+     */
+    void run(const char *buffer, qint64 base, char previous, qint64 from, qint64 to, QVector<quint64> &lineStarts);
+};
+
+#endif // LINESCANNER_H
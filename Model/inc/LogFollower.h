@@ -0,0 +1,77 @@
+#ifndef LOGFOLLOWER_H
+#define LOGFOLLOWER_H
+
+#include <QObject>
+#include <QFileSystemWatcher>
+#include <QTimer>
+#include <QHash>
+#include <QSet>
+#include <QSharedPointer>
+#include "LogSource.h"
+
+/**
+ * @brief Follows log files that are still being written to, like "tail -f".
+ *
+ * Change notifications from QFileSystemWatcher (inotify on Linux) only mark a file as dirty;
+ * dirty files are refreshed on a short timer, so a writer producing tens of thousands of lines
+ * per second costs one incremental index update per tick instead of one per write. The timer
+ * also polls every followed file, which catches rotated files that the watcher lost track of
+ * and file systems that do not deliver notifications.
+ */
+class LogFollower : public QObject
+{
+    Q_OBJECT
+
+public:
+    /**
+     * @brief Constructs a follower.
+     * @param parent The parent QObject.
+     */
+    explicit LogFollower(QObject *parent = nullptr);
+
+    /**
+     * @brief Starts following a source. The source must be fully indexed.
+     * @param source The source to follow.
+     */
+    void follow(const QSharedPointer<LogSource> &source);
+
+    /**
+     * @brief Stops following a file.
+     * @param filePath Path of the followed file.
+     */
+    void unfollow(const QString &filePath);
+
+    /**
+     * @brief Returns true if the file is being followed.
+     * @param filePath Path of the file.
+     */
+    bool isFollowing(const QString &filePath) const;
+
+signals:
+    /**
+     * @brief Emitted when new lines were appended to a followed file.
+     * @param filePath Path of the file.
+     * @param firstChangedLine First line whose content changed; everything from there on must be redisplayed.
+     */
+    void linesAppended(const QString &filePath, qint64 firstChangedLine);
+
+    /**
+     * @brief Emitted when a followed file was truncated or replaced and has been reindexed from scratch.
+     * @param filePath Path of the file.
+     */
+    void sourceReset(const QString &filePath);
+
+private:
+    QFileSystemWatcher watcher;                         ///< Delivers change notifications.
+    QTimer refreshTimer;                                ///< Coalesces notifications into periodic refreshes.
+    QHash<QString, QSharedPointer<LogSource>> followed; ///< Followed sources, keyed by file path.
+    QSet<QString> dirtyPaths;                           ///< Files changed since the last refresh.
+    int ticksSincePoll = 0;                             ///< Refresh ticks since every file was last polled.
+
+    /**
+     * @brief Refreshes dirty files, or all files when it is time to poll.
+     */
+    void refreshFiles();
+};
+
+#endif // LOGFOLLOWER_H
@@ -14,15 +14,18 @@
 #include <QTextBlock>
 #include <QTextDocumentFragment>
 #include <QVector>
+#include <QHash>
+#include <QSharedPointer>
+#include <QThreadPool>
+#include <QElapsedTimer>
+#include <QMultiHash>
+#include <atomic>
+#include <memory>
+#include "LogSource.h"
+#include "LogFollower.h"
+#include "ArchiveSession.h"
 
-struct LogEntry {
-    QDateTime dateTime;
-    QString text;
-    QList<QTextLayout::FormatRange> formats;
-
-    LogEntry(QDateTime dt, const QString& txt, QList<QTextLayout::FormatRange> fmts)
-        : dateTime(dt), text(txt), formats(fmts) {}
-};
+class IngestTask;
 
 class LogManager : public QObject
 {
@@ -38,32 +41,120 @@ public:
      * @param groupName Name of the group under which the file will be added.
      * @return True if the file is successfully opened and displayed; false otherwise.
      *
-     * Opens the specified file and adds it to a specified group in the tree view. If the
-     * file opens successfully, its content is displayed in the primary text edit widget.
+     * Queues the file on the ingestion thread pool, which memory-maps it and builds its line-offset
+     * index. The file is added to the specified group as soon as its first chunk is indexed, so it
+     * can be browsed while the rest is still loading. The tree item points at the original file; its
+     * content is served from the resulting LogSource, see source().
+     *
+     * @return True if the file was queued or is already open; false if it does not exist.
      */
     bool openAndDisplayFile(const QString &filePath, const QString &groupName);
 
     /**
-     * @brief Sorts logs within a document either in ascending or descending order.
-     * @param document Pointer to the QTextDocument that contains the logs to sort.
-     * @param ascending Boolean flag indicating sorting order; true for ascending, false for descending.
-     * @return Vector of pairs containing sorted logs as plain and HTML text.
+     * @brief Opens a batch of files concurrently under a specific group.
+     *
+     * All files are queued on the ingestion thread pool at once, largest first, so that the
+     * big files do not end up running alone at the end of the batch. Each file shows up in
+     * the group as soon as it can be browsed.
+     *
+     * @param filePaths Paths of the files to open.
+     * @param groupName Name of the group under which the files will be added.
      */
-    QVector<QPair<QString, QString>> sortLogs(QTextDocument* document, bool ascending);
+    void openFiles(const QStringList &filePaths, const QString &groupName);
 
     /**
-     * @brief Extracts a specific file(s) from a ZIP archive and writes it to a temporary location.
+     * @brief Lists the entries of an archive on the ingestion thread pool and emits archiveOpened().
      *
-     * This function opens a ZIP file, locates the specified files within the archive, and extracts
-     * its contents to a temporary file on the disk. It then returns the path to this temporary file.
-     * This is useful when you need to access the contents of a file inside a ZIP archive without
-     * extracting the entire archive.
+     * An up-to-date session of the same archive that is still around is reused. Opening an archive
+     * that is already being listed only adds a request to that listing. Emits errorOccurred() if the
+     * archive cannot be read, but not if listing was cancelled through cancelArchiveListing().
      *
-     * @param zipFilePath The path to the ZIP file from which to extract.
-     * @param fileInsideZip The path of the file inside the ZIP archive to extract.
-     * @return QString The path to the extracted temporary file, or an empty QString if extraction failed.
+     * @param archivePath The path to the ZIP, TAR or 7z archive.
+     * @param groupName Name of the group the entries picked from the archive will be added to.
      */
-    QString extractFileFromZip(const QString &zipFilePath, const QString &fileInsideZip);
+    void openArchive(const QString &archivePath, const QString &groupName);
+
+    /**
+     * @brief Cancels the listing of all archives still being listed.
+     */
+    void cancelArchiveListing();
+
+    /**
+     * @brief Opens entries of an archive concurrently under a specific group.
+     *
+     * Entries are queued on the ingestion thread pool at once, largest first, and read in place
+     * from the archive, see ArchiveSession::createSource(). Each entry shows up in the group as
+     * soon as it can be browsed.
+     *
+     * @param archive Session of the archive.
+     * @param entryPaths Paths of the entries inside the archive.
+     * @param groupName Name of the group under which the entries will be added.
+     */
+    void openArchiveEntries(const QSharedPointer<ArchiveSession> &archive, const QStringList &entryPaths, const QString &groupName);
+
+    /**
+     * @brief Opens a single entry of a ZIP archive like openArchiveEntries(), once the archive is listed.
+     * @param zipFilePath The path to the ZIP file.
+     * @param fileInsideZip The path of the file inside the ZIP archive.
+     * @param groupName Name of the group under which the file will be added.
+     */
+    void openFromZip(const QString &zipFilePath, const QString &fileInsideZip, const QString &groupName);
+
+    /**
+     * @brief Cancels all queued and running ingestion tasks.
+     *
+     * Queued tasks are dropped; running tasks stop after their current chunk. Lines indexed
+     * up to that point stay available.
+     */
+    void cancelIngestion();
+
+    /**
+     * @brief Returns true while ingestion tasks are queued or running.
+     */
+    bool isIngesting() const;
+
+    /**
+     * @brief Returns the indexed source of an opened file.
+     * @param filePath Path of the file as stored in the tree view.
+     * @return The source, or a null pointer if the file was not opened through openAndDisplayFile().
+     */
+    QSharedPointer<LogSource> source(const QString &filePath) const;
+
+    /**
+     * @brief Releases one reference to the source of an opened file.
+     *
+     * The same file can be added to several groups; its mapping and index are dropped
+     * once the last tree item referring to it has been closed.
+     *
+     * @param filePath Path of the file as stored in the tree view.
+     */
+    void releaseSource(const QString &filePath);
+
+    /**
+     * @brief Starts or stops following a file that is still being written to.
+     *
+     * While a file is followed, newly appended bytes are indexed as they arrive and reported
+     * through linesAppended(); truncation or rotation is reported through sourceReset().
+     *
+     * @param filePath Path of the file as stored in the tree view.
+     * @param enabled True to follow the file, false to stop following it.
+     * @return False if the file is not open, is still being loaded or cannot be followed, e.g. because it is compressed.
+     */
+    bool setFollowing(const QString &filePath, bool enabled);
+
+    /**
+     * @brief Returns true if the file is being followed.
+     * @param filePath Path of the file as stored in the tree view.
+     */
+    bool isFollowing(const QString &filePath) const;
+
+    /**
+     * @brief Sorts logs within a document either in ascending or descending order.
+     * @param document Pointer to the QTextDocument that contains the logs to sort.
+     * @param ascending Boolean flag indicating sorting order; true for ascending, false for descending.
+     * @return Vector of pairs containing sorted logs as plain and HTML text.
+     */
+    QVector<QPair<QString, QString>> sortLogs(QTextDocument* document, bool ascending);
 
     /**
      * @brief Adds a file to a specified group in the tree view.
@@ -92,17 +183,145 @@ signals:
      */
     void fileAddedToGroup(const QString &groupName, const QString &fileName, const QString &filePath);
 
+    /**
+     * @brief Signal emitted periodically while files are being ingested.
+     * @param bytesDone Bytes read from disk so far across all queued files.
+     * @param bytesTotal Total bytes on disk known to be queued.
+     * @param linesDone Lines indexed so far across all queued files.
+     * @param bytesPerSecond Average indexing throughput in bytes per second, counting decompressed bytes for compressed files.
+     * @param linesPerSecond Average indexing throughput in lines per second.
+     */
+    void ingestionProgress(qint64 bytesDone, qint64 bytesTotal, qint64 linesDone, double bytesPerSecond, double linesPerSecond);
+
+    /**
+     * @brief Signal emitted when the last queued ingestion task is done.
+     * @param cancelled True if cancelIngestion() was called.
+     * @param filesLoaded Number of files opened since ingestion started.
+     * @param bytesLoaded Number of (decompressed) bytes indexed since ingestion started.
+     * @param elapsedMs Wall-clock duration of the whole run in milliseconds.
+     */
+    void ingestionFinished(bool cancelled, int filesLoaded, qint64 bytesLoaded, qint64 elapsedMs);
+
+    /**
+     * @brief Signal emitted when a source has been fully indexed, or indexing of it stopped.
+     * @param filePath Path of the file as stored in the tree view.
+     */
+    void sourceUpdated(const QString &filePath);
+
+    /**
+     * @brief Signal emitted when lines were appended to a followed file.
+     * @param filePath Path of the file as stored in the tree view.
+     * @param firstChangedLine First line whose content changed.
+     */
+    void linesAppended(const QString &filePath, qint64 firstChangedLine);
+
+    /**
+     * @brief Signal emitted when a followed file was truncated or rotated and has been reindexed.
+     * @param filePath Path of the file as stored in the tree view.
+     */
+    void sourceReset(const QString &filePath);
+
+    /**
+     * @brief Signal emitted periodically while a TAR archive is read through to list it.
+     * @param archivePath Path of the archive.
+     * @param bytesRead Bytes of the archive read so far.
+     * @param bytesTotal Size of the archive.
+     */
+    void archiveListingProgress(const QString &archivePath, qint64 bytesRead, qint64 bytesTotal);
+
+    /**
+     * @brief Signal emitted when an archive opened through openArchive() has been listed.
+     * @param archive Session of the archive, whose entries can be picked and passed to openArchiveEntries().
+     * @param groupName Name of the group passed to openArchive().
+     */
+    void archiveOpened(const QSharedPointer<ArchiveSession> &archive, const QString &groupName);
+
+    /**
+     * @brief Signal emitted when the last archive being listed has been listed, failed or was cancelled.
+     */
+    void archiveListingFinished();
+
 private:
     /**
-     * @brief Writes a list of lines to a temporary file.
-     *
-     * This function creates a new temporary file and writes the provided list of lines to it.
-     * The function returns the path to the created file, allowing further manipulation or display.
-     *
-     * @param lines QStringList containing all lines to be written to the file.
-     * @param fileName The name to be assigned to the temporary file.
-     * @return QString The path to the newly created temporary file.
+     * @brief Something to do with an archive once it has been listed.
      */
-    QString writeLinesToFile(const QStringList &lines, const QString &fileName);};
+    struct ArchiveRequest {
+        QString groupName;      ///< Group the entries are added to.
+        QStringList entryPaths; ///< Entries to open right away; if empty, archiveOpened() is emitted.
+    };
+
+    /**
+     * @brief Lists an archive on the ingestion thread pool, or joins its listing if it is already running.
+     */
+    void listArchive(const QString &archivePath, const ArchiveRequest &request);
+
+    /**
+     * @brief Stores the session of a listed archive and serves the requests waiting for it. Runs on the owning thread.
+     * @param archivePath Path of the archive.
+     * @param archive The session, null if listing failed or was cancelled.
+     * @param error Description of the error, empty if listing succeeded or was cancelled.
+     */
+    void onArchiveListed(const QString &archivePath, const QSharedPointer<ArchiveSession> &archive, const QString &error);
+
+    /**
+     * @brief Adds a file that is already open to a group, or queues the group for a file that is still being opened.
+     * @param filePath Path of the file as stored in the tree view.
+     * @param fileName Name of the file as shown in the tree view.
+     * @param groupName Name of the group.
+     * @return False if the file is neither open nor queued.
+     */
+    bool joinOpenFile(const QString &filePath, const QString &fileName, const QString &groupName);
+
+    /**
+     * @brief Connects a task to the manager and queues it on the thread pool.
+     * @param task The task to start; the manager takes ownership.
+     * @param filePath Path of the file as stored in the tree view, under which groups wait for it in pendingGroups.
+     * @param expectedSize Number of bytes the task is expected to index, 0 if unknown.
+     */
+    void startTask(IngestTask *task, const QString &filePath, qint64 expectedSize);
+
+    /**
+     * @brief Registers the source of a task once its first chunk is indexed and adds it to its group.
+     */
+    void onTaskSourceReady(IngestTask *task);
+
+    /**
+     * @brief Accounts a finished (or dropped) task and emits ingestionFinished() after the last one.
+     */
+    void onTaskFinished(IngestTask *task);
+
+    /**
+     * @brief Emits ingestionProgress() with totals aggregated over all tasks of the current run.
+     */
+    void reportProgress();
+
+    QThreadPool ingestionPool; ///< Worker threads running ingestion tasks.
+    LogFollower follower; ///< Watches followed files for appended lines.
+    QList<IngestTask *> activeTasks; ///< Tasks queued or running.
+    /**
+     * @brief Progress of one ingestion task.
+     */
+    struct TaskProgress {
+        qint64 bytesRead = 0;    ///< Bytes read from disk.
+        qint64 bytesIndexed = 0; ///< Bytes indexed, decompressed bytes for compressed files.
+        qint64 lines = 0;        ///< Lines indexed.
+    };
+
+    QHash<IngestTask *, QString> taskPaths; ///< Path of every active task whose source is not ready yet.
+    QHash<IngestTask *, qint64> taskSizes; ///< Size on disk of the file of every active task.
+    QHash<IngestTask *, TaskProgress> taskProgress; ///< Progress of every active task.
+    QMultiHash<QString, QString> pendingGroups; ///< Groups waiting for a file that is still being queued.
+    qint64 finishedBytesRead = 0; ///< Bytes read from disk by finished tasks of the current run.
+    qint64 finishedBytesIndexed = 0; ///< Bytes indexed by finished tasks of the current run.
+    qint64 finishedLines = 0; ///< Lines indexed by finished tasks of the current run.
+    int finishedFiles = 0; ///< Files successfully opened by finished tasks of the current run.
+    QElapsedTimer ingestionTimer; ///< Measures the duration of the current run.
+    bool ingestionCancelled = false; ///< Set by cancelIngestion() until the current run is over.
+    QHash<QString, QSharedPointer<LogSource>> sources; ///< Indexed sources of opened files, keyed by file path.
+    QHash<QString, int> sourceRefs; ///< Number of tree items referring to each source.
+    QHash<QString, QSharedPointer<ArchiveSession>> archives; ///< Sessions of opened archives, keyed by archive path.
+    QHash<QString, QList<ArchiveRequest>> archiveRequests; ///< Requests waiting for every archive being listed.
+    QHash<QString, std::shared_ptr<std::atomic<bool>>> archiveListings; ///< Cancellation flag of every archive being listed.
+};
 
 #endif // LOGMANAGER_H
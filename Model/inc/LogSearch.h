@@ -0,0 +1,183 @@
+#ifndef LOGSEARCH_H
+#define LOGSEARCH_H
+
+#include <QObject>
+#include <QString>
+#include <QVector>
+#include <QSharedPointer>
+#include <QThreadPool>
+#include <atomic>
+#include <memory>
+#include "LogSource.h"
+#include "LineMatcher.h"
+
+/**
+ * @brief Finds all occurrences of a text or regular expression in the indexed lines of a LogSource, in parallel.
+ *
+ * The lines are split into chunks of about chunkSize bytes at line boundaries, and every
+ * chunk is searched in its raw bytes on a thread pool, its own or a shared one, for the literal of a
+ * LineMatcher. Lines are only counted, never decoded, as long as the literal is all there is
+ * to match, except for the prefix of a line before a match when it holds non-ASCII
+ * characters, to turn the byte offset into a column. Otherwise only the lines containing the
+ * literal are decoded and matched, and all lines if there is no literal. The result is a
+ * sorted vector of 16-byte hits, so a search over gigabytes costs memory in proportion to
+ * its matches only.
+ *
+ * The lines matched by the last complete search are kept. A query that narrows it down, like
+ * "timeout" after "time", only looks at those lines again, which makes searching as the user
+ * types cheap once the first few characters have been searched.
+ *
+ * Sources that decompress on the fly serialize their reads, so the scan of those runs at the
+ * speed of one reader. Workers hold a LogSource::BytesLease on the bytes they scan, so a
+ * followed file refreshed meanwhile keeps its previous mapping until they are done with it.
+ */
+class LogSearch : public QObject
+{
+    Q_OBJECT
+
+public:
+    /**
+     * @brief Occurrence of the text.
+     */
+    struct Hit {
+        qint64 line = 0;    ///< Zero-based line number.
+        qint32 column = 0;  ///< Column of the match within the decoded line.
+        qint32 length = 0;  ///< Length of the match in the decoded line.
+    };
+
+    /**
+     * @brief Order in which occurrences are wanted.
+     */
+    enum Direction {
+        Forward,    ///< The first occurrences of the range, in file order.
+        Backward    ///< The last occurrences of the range, the last one first.
+    };
+
+    /**
+     * @brief Bytes of log text searched by one task.
+     */
+    static constexpr qint64 chunkSize = 16 * 1024 * 1024;
+
+    /**
+     * @brief Lines searched by one task when narrowing down the last search.
+     */
+    static constexpr int refineChunkLines = 4096;
+
+    /**
+     * @brief Constructs an idle search.
+     * @param parent The parent QObject.
+     */
+    explicit LogSearch(QObject *parent = nullptr);
+
+    /**
+     * @brief Constructs an idle search running its tasks on a pool shared with other searches.
+     *
+     * The owner of the pool has to wait for it before the search is destroyed.
+     *
+     * @param sharedPool Pool to run the tasks on.
+     * @param parent The parent QObject.
+     */
+    explicit LogSearch(QThreadPool *sharedPool, QObject *parent = nullptr);
+
+    /**
+     * @brief Cancels a running search and waits for its workers, if they run on a pool of its own.
+     */
+    ~LogSearch() override;
+
+    /**
+     * @brief Starts searching the lines indexed so far, cancelling a search that is still running.
+     *
+     * If the matcher narrows down the last complete search of the same source, see
+     * LineMatcher::narrows(), and no lines were indexed since, only the lines it matched are searched.
+     *
+     * @param source Log to search.
+     * @param matcher Text or regular expression to search for.
+     * @param maxHits Number of occurrences kept; the first ones in the file are.
+     */
+    void start(const QSharedPointer<LogSource> &source, const LineMatcher &matcher, qint64 maxHits = 1000000);
+
+    /**
+     * @brief Starts searching a range of lines, cancelling a search that is still running.
+     *
+     * Used by Find Next and Find Previous with maxHits 1: chunks are searched in parallel,
+     * starting with the ones nearest to where the search starts, and chunks past a chunk
+     * that found enough occurrences are skipped.
+     *
+     * @param source Log to search.
+     * @param matcher Text or regular expression to search for.
+     * @param firstLine First line to search.
+     * @param endLine Line after the last one to search; -1 for all lines indexed so far.
+     * @param direction Whether the first or the last occurrences of the range are kept.
+     * @param maxHits Number of occurrences kept.
+     */
+    void start(const QSharedPointer<LogSource> &source, const LineMatcher &matcher, qint64 firstLine, qint64 endLine,
+               Direction direction, qint64 maxHits);
+
+    /**
+     * @brief Stops the search; chunks being searched stop at their next candidate.
+     */
+    void cancel();
+
+    /**
+     * @brief Returns true while a search is running.
+     */
+    bool isRunning() const;
+
+    /**
+     * @brief Returns the occurrences found by the last finished search, sorted by line and column in its direction.
+     */
+    const QVector<Hit> &hits() const;
+
+    /**
+     * @brief Returns true if the last finished search found more than maxHits occurrences; always false for a range search.
+     */
+    bool isTruncated() const;
+
+signals:
+    /**
+     * @brief Emitted after every searched chunk.
+     * @param chunksDone Chunks searched so far.
+     * @param chunksTotal Chunks to search.
+     * @param hitsFound Occurrences found so far, at most maxHits.
+     */
+    void progress(int chunksDone, int chunksTotal, qint64 hitsFound);
+
+    /**
+     * @brief Emitted when all chunks have been searched or the search was cancelled.
+     * @param cancelled True if cancel() was called.
+     */
+    void finished(bool cancelled);
+
+private:
+    QThreadPool ownPool;                            ///< Worker threads searching chunks, unless a shared pool is used.
+    QThreadPool *pool;                              ///< Pool the chunks are searched on, ownPool or a shared one.
+    std::shared_ptr<std::atomic<bool>> stop;        ///< Cancellation flag of the current search, shared with its workers.
+    std::shared_ptr<std::atomic<int>> firstFull;    ///< Lowest chunk that found maxHits occurrences; later chunks are not needed.
+    int generation = 0;                             ///< Number of the current search, results of older ones are dropped.
+    QVector<QVector<Hit>> chunkHits;                ///< Occurrences per chunk of the current search.
+    int chunksDone = 0;                             ///< Chunks of the current search searched so far.
+    qint64 hitsFound = 0;                           ///< Occurrences found by the current search so far.
+    qint64 hitLimit = 0;                            ///< maxHits of the current search.
+    QSharedPointer<LogSource> searchedSource;       ///< Source of the current search.
+    LineMatcher searchedMatcher;                    ///< Matcher of the current search.
+    QVector<Hit> results;                           ///< Occurrences found by the last finished search.
+    bool truncated = false;                         ///< True if results stopped at hitLimit.
+    bool running = false;                           ///< True while the current search has unfinished chunks.
+    bool wholeSearch = false;                       ///< True if the current search runs forward over all lines.
+    QWeakPointer<LogSource> completedSource;        ///< Source of the last complete search.
+    qint64 completedLineCount = 0;                  ///< Lines of completedSource when it was searched.
+    LineMatcher completedMatcher;                   ///< Matcher of the last complete search.
+    QVector<qint64> completedLines;                 ///< Lines matched by the last complete search, sorted.
+
+    /**
+     * @brief Accounts the occurrences of a chunk on the owning thread and emits the signals.
+     */
+    void onChunkSearched(int searchGeneration, int chunk, const QVector<Hit> &hits);
+
+    /**
+     * @brief Collects the occurrences of all chunks, remembers a complete result and emits finished().
+     */
+    void finish();
+};
+
+#endif // LOGSEARCH_H
@@ -0,0 +1,366 @@
+#ifndef LOGSOURCE_H
+#define LOGSOURCE_H
+
+#include <QString>
+#include <QByteArray>
+#include <QVector>
+#include <QStringList>
+#include <QReadWriteLock>
+#include <QSharedPointer>
+#include <functional>
+#include <memory>
+#include "TimestampParser.h"
+
+/**
+ * @brief One log line, referenced by its UTF-8 byte range inside a LogSource.
+ *
+ * Entries are 24 bytes regardless of the line length and hold no text; the text is decoded
+ * from the source only when the line is rendered or matched.
+ */
+struct LogEntry {
+    qint64 line = -1;                                   ///< Zero-based line number, -1 for an invalid entry.
+    quint64 offset = 0;                                 ///< Offset of the first byte of the line.
+    qint64 timestamp = TimestampParser::NoTimestamp;    ///< Leading timestamp, see TimestampParser.
+
+    /**
+     * @brief Returns true if the entry refers to a line.
+     */
+    bool isValid() const { return line >= 0; }
+};
+
+/**
+ * @brief Read-only view of a log file with a line-offset index.
+ *
+ * The file is scanned in a single pass that records the byte offset of every line start.
+ * Lines are handed out as UTF-8 bytes or decoded to QString on demand, so the log is never
+ * copied to a temporary file and memory use stays close to 16 bytes of index per line.
+ *
+ * This class holds the index and serves lines from it; where the bytes come from is up to
+ * the subclasses: MappedLogSource maps plain files into memory, CompressedLogSource inflates
+ * gzip, bzip2, xz and zstd files on the fly. Use create() to get the right one for a file.
+ *
+ * The index may be built on a worker thread while the GUI thread already reads the
+ * lines indexed so far; all accessors are safe to call concurrently with buildIndex().
+ */
+class LogSource
+{
+public:
+    /**
+     * @brief Callback invoked after every indexed chunk.
+     *
+     * Receives the number of bytes read from the file on disk, the number of (decompressed)
+     * bytes and lines indexed so far. Returning false cancels indexing.
+     */
+    using ProgressCallback = std::function<bool(qint64 bytesRead, qint64 bytesIndexed, qint64 linesIndexed)>;
+
+    /**
+     * @brief Keeps the bytes handed out by lineBytes() and linesBytes() valid for as long as it is held.
+     *
+     * A MappedLogSource hands out arrays referencing its mapping, which refresh() replaces when a
+     * followed file changes. Threads other than the one refreshing the source take a lease along
+     * with the bytes; a mapping is unmapped once neither the source nor any lease refers to it.
+     * Sources handing out copies leave the lease empty.
+     */
+    using BytesLease = std::shared_ptr<const void>;
+
+    /**
+     * @brief Creates the source matching a file, a CompressedLogSource for compressed files
+     *        and a MappedLogSource for everything else. Nothing is read until open() is called.
+     * @param filePath Path of the log file on disk.
+     */
+    static QSharedPointer<LogSource> create(const QString &filePath);
+
+    /**
+     * @brief Closes the underlying file.
+     */
+    virtual ~LogSource();
+
+    /**
+     * @brief Opens the file.
+     * @return True on success; false otherwise, in which case errorString() describes the failure.
+     */
+    virtual bool open() = 0;
+
+    /**
+     * @brief Builds the line-offset index in a single pass over the file.
+     *
+     * Line boundaries are found by the vectorized LineScanner. The file is scanned in chunks;
+     * lines become visible to readers as soon as the chunk containing their terminator has
+     * been indexed. The leading timestamp of every line is parsed along the way.
+     *
+     * @param progress Optional callback invoked after every chunk.
+     * @return True if the whole file was indexed; false if the source is not open, reading failed or indexing was cancelled.
+     */
+    virtual bool buildIndex(const ProgressCallback &progress = ProgressCallback()) = 0;
+
+    /**
+     * @brief Outcome of refresh().
+     */
+    enum RefreshResult {
+        Unchanged,  ///< The file did not change.
+        Appended,   ///< New bytes were appended and indexed.
+        Reset       ///< The file was truncated or replaced and has been indexed from scratch, or emptied if it cannot be read.
+    };
+
+    /**
+     * @brief Picks up changes of a fully indexed file that is still being written to.
+     *
+     * Only sources for which isFollowable() returns true pick up changes; the default
+     * implementation always reports Unchanged. Readers on other threads see either the old
+     * lines or the new ones, never a partly rebuilt index or a shrunken source.
+     *
+     * @param firstChangedLine Receives the first line whose content changed: the previous last
+     *        line if it was not terminated yet, otherwise the first new line; 0 after a reset.
+     * @return What changed.
+     */
+    virtual RefreshResult refresh(qint64 &firstChangedLine);
+
+    /**
+     * @brief Prepares the source for being followed, before refresh() is first called.
+     *
+     * The default implementation does nothing.
+     */
+    virtual void startFollowing();
+
+    /**
+     * @brief Returns true if refresh() can pick up lines appended to the file.
+     */
+    virtual bool isFollowable() const;
+
+    /**
+     * @brief Returns the size of the file on disk, which is what reading it costs.
+     */
+    virtual qint64 inputSize() const = 0;
+
+    /**
+     * @brief Returns the path of the file backing this source.
+     */
+    QString filePath() const;
+
+    /**
+     * @brief Returns a description of the last error.
+     */
+    QString errorString() const;
+
+    /**
+     * @brief Returns the size of the log text in bytes; for compressed files, the decompressed bytes seen so far.
+     */
+    qint64 size() const;
+
+    /**
+     * @brief Returns the number of bytes covered by complete, indexed lines.
+     */
+    qint64 indexedSize() const;
+
+    /**
+     * @brief Returns true once buildIndex() has scanned the whole file.
+     */
+    bool isIndexComplete() const;
+
+    /**
+     * @brief Returns the number of indexed lines.
+     */
+    qint64 lineCount() const;
+
+    /**
+     * @brief Returns the number of lines the source is expected to have once it is fully indexed.
+     *
+     * While indexing, the lines indexed so far are extrapolated to the expected size of the
+     * text; once the index is complete this is lineCount().
+     */
+    qint64 estimatedLineCount() const;
+
+    /**
+     * @brief Returns the length in bytes of the longest indexed line, without its terminator.
+     */
+    qint64 longestLine() const;
+
+    /**
+     * @brief Returns the timestamp a line starts with.
+     * @param line Zero-based line number.
+     * @return Milliseconds since the epoch, or TimestampParser::NoTimestamp.
+     */
+    qint64 timestamp(qint64 line) const;
+
+    /**
+     * @brief Returns true if the timestamps of the indexed lines never decrease.
+     *
+     * Lines without a timestamp are ignored.
+     */
+    bool timestampsSorted() const;
+
+    /**
+     * @brief Returns the first line whose timestamp is at or after the given time.
+     *
+     * Lines are grouped in blocks of timeBlockLines, and the latest timestamp up to the end of
+     * every block is kept while indexing. That sequence never decreases, sorted log or not, so
+     * the block holding the line is found by binary search and only that block is scanned.
+     *
+     * @param timestamp Milliseconds since the epoch, as returned by TimestampParser.
+     * @return Zero-based line number, or -1 if no indexed line is that late.
+     */
+    qint64 lineAtTimestamp(qint64 timestamp) const;
+
+    /**
+     * @brief Number of lines per block of the time lookup, see lineAtTimestamp().
+     */
+    static constexpr qint64 timeBlockLines = 1024;
+
+    /**
+     * @brief Returns true if the index was restored from the on-disk cache instead of being built from scratch.
+     */
+    bool isRestoredFromCache() const;
+
+    /**
+     * @brief Returns the raw UTF-8 bytes of a line, without its line terminator.
+     *
+     * A MappedLogSource returns an array referencing the mapping directly, which stays valid
+     * for as long as the source is alive and not refreshed, or as long as lease is held; other
+     * sources return a copy.
+     *
+     * @param line Zero-based line number.
+     * @param lease Optional; receives the lease keeping the bytes valid across refresh().
+     * @return The bytes of the line, or an empty QByteArray if the line is out of range.
+     */
+    QByteArray lineBytes(qint64 line, BytesLease *lease = nullptr) const;
+
+    /**
+     * @brief Returns the raw UTF-8 bytes of consecutive lines, including their line terminators.
+     *
+     * Like lineBytes(), a MappedLogSource returns an array referencing the mapping directly.
+     *
+     * @param firstLine Zero-based number of the first line.
+     * @param endLine Zero-based number of the line after the last one; clamped to lineCount().
+     * @param lease Optional; receives the lease keeping the bytes valid across refresh().
+     * @return The bytes of the lines, or an empty QByteArray if the range holds no indexed line.
+     */
+    QByteArray linesBytes(qint64 firstLine, qint64 endLine, BytesLease *lease = nullptr) const;
+
+    /**
+     * @brief Returns the line containing a byte offset.
+     * @param offset Byte offset into the log text.
+     * @return Zero-based line number, clamped to the indexed lines; 0 if there are none.
+     */
+    qint64 lineAtOffset(qint64 offset) const;
+
+    /**
+     * @brief Returns a line decoded from UTF-8.
+     * @param line Zero-based line number.
+     */
+    QString lineText(qint64 line) const;
+
+    /**
+     * @brief Decodes a window of consecutive lines, e.g. the rows currently on screen.
+     * @param firstLine Zero-based number of the first line.
+     * @param count Maximum number of lines to decode.
+     * @return The decoded lines, without terminators; shorter than count at the end of the index.
+     */
+    QStringList lineTexts(qint64 firstLine, qint64 count) const;
+
+    /**
+     * @brief Decodes lines of a region the index has not reached yet, e.g. to paint them before they are indexed.
+     *
+     * Lines are found by scanning the bytes from offset on, starting with the first line that
+     * starts at or after offset. Lines longer than the bytes looked at are cut.
+     *
+     * @param offset Byte offset the region starts at, usually estimated from the average line length.
+     * @param count Maximum number of lines to decode.
+     * @return The decoded lines, empty if the source cannot read ahead of its index.
+     */
+    QStringList previewLines(qint64 offset, qint64 count) const;
+
+    /**
+     * @brief Returns a reference to a line that can be stored without holding its text.
+     * @param line Zero-based line number.
+     * @return The entry, invalid if the line is out of range.
+     */
+    LogEntry entry(qint64 line) const;
+
+    /**
+     * @brief Returns the indexed lines from firstLine on, decoded from UTF-8 with their line terminators.
+     * @param firstLine Zero-based number of the first line to return.
+     */
+    QString text(qint64 firstLine = 0) const;
+
+protected:
+    /**
+     * @brief Constructs a source for the given file.
+     * @param filePath Path of the log file on disk.
+     */
+    explicit LogSource(const QString &filePath);
+
+    /**
+     * @brief Returns the log bytes in [offset, offset + length).
+     *
+     * Called without the index lock held; offset and length always lie within indexed lines.
+     *
+     * @param lease If not nullptr, receives what keeps the returned bytes valid, see BytesLease.
+     */
+    virtual QByteArray readRange(qint64 offset, qint64 length, BytesLease *lease) const = 0;
+
+    /**
+     * @brief Returns the bytes of a line in [offset, offset + length), without its "\n" or "\r\n".
+     *
+     * Called like readRange(). The default implementation chops the terminator off what
+     * readRange() returns, which suits sources handing out copies; sources handing out
+     * raw-data arrays trim the range before wrapping it, as truncating would deep-copy it.
+     */
+    virtual QByteArray readLine(qint64 offset, qint64 length, BytesLease *lease) const;
+
+    /**
+     * @brief Returns the bytes in [offset, offset + length) whether they are indexed or not.
+     *
+     * Called without the index lock held, with the range inside size(). The default
+     * implementation returns nothing, for sources that can only read what they have indexed.
+     */
+    virtual QByteArray readAhead(qint64 offset, qint64 length) const;
+
+    /**
+     * @brief Returns the size the log text is expected to have once indexed. The caller must hold the lock.
+     *
+     * The default implementation returns dataSize, for sources that know their size up front.
+     */
+    virtual qint64 expectedSize() const;
+
+    /**
+     * @brief Drops the index, ready to be rebuilt for a file of the given size.
+     */
+    void clearIndex(qint64 expectedSize);
+
+    /**
+     * @brief Publishes a chunk of line starts and their timestamps to readers.
+     * @param chunkOffsets Offsets of the lines starting in the chunk.
+     * @param chunkTimestamps Timestamp of every line in chunkOffsets.
+     * @param longestLine Length of the longest line indexed so far.
+     * @param complete True if this is the last chunk of the file.
+     * @return The number of complete lines after the chunk.
+     */
+    qint64 appendChunk(const QVector<quint64> &chunkOffsets, const QVector<qint64> &chunkTimestamps, qint64 longestLine, bool complete);
+
+    /**
+     * @brief Returns the number of complete lines. The caller must hold the lock.
+     */
+    qint64 completeLineCount() const;
+
+    /**
+     * @brief Brings the time lookup up to date after timestamps from a line on were added or changed.
+     *        The caller must hold the lock for writing.
+     * @param fromLine First line whose timestamp is new or changed.
+     */
+    void updateTimeLookup(qint64 fromLine);
+
+    QString path;                   ///< Path of the log file.
+    qint64 dataSize = 0;            ///< Number of bytes of log text.
+    QVector<quint64> lineOffsets;   ///< Byte offset of the first character of every line.
+    QVector<qint64> timestamps;     ///< Leading timestamp of every line, see TimestampParser.
+    QVector<qint64> latestByBlock;  ///< Latest timestamp up to the end of every block of timeBlockLines lines.
+    bool indexComplete = false;     ///< Set once the last chunk has been indexed.
+    qint64 longest = 0;             ///< Length of the longest indexed line.
+    bool sorted = true;             ///< False once a timestamp lower than its predecessor was seen.
+    mutable QReadWriteLock lock;    ///< Guards the index against concurrent indexing.
+    qint64 lastTimestamp = TimestampParser::NoTimestamp; ///< Last timestamp seen while indexing.
+    bool restoredFromCache = false; ///< Set if the index came from IndexCache.
+    QString error;                  ///< Description of the last error.
+};
+
+#endif // LOGSOURCE_H
@@ -0,0 +1,226 @@
+#ifndef MAPPEDLOGSOURCE_H
+#define MAPPEDLOGSOURCE_H
+
+#include <QFile>
+#include <QMutex>
+#include <memory>
+#include "LogSource.h"
+
+/**
+ * @brief LogSource over a plain log file that is memory-mapped.
+ *
+ * Lines are handed out straight from the mapping, so resident memory stays close to the
+ * file size plus the index. Indexes of large files are persisted in the IndexCache, and
+ * files still being written to can be followed with refresh().
+ *
+ * The mapping is shared with the leases handed out along with line bytes, see BytesLease,
+ * and unmapped once the last lease on it is released. Followed files are not read through
+ * a mapping: a copytruncate rotation shrinks the file under it, and touching the pages past
+ * the new end raises SIGBUS. Once following starts, lines are copied out of the file
+ * instead, which merely come back short if the file shrinks. refresh() opens and indexes the
+ * changed file on the side and publishes the new file and index in one step, so readers
+ * never see a partial index.
+ *
+ * A source can also cover just a range of a file, e.g. an entry stored uncompressed inside
+ * a ZIP archive, which is then mapped straight from the archive. Such sources are not followed.
+ */
+class MappedLogSource : public LogSource
+{
+public:
+    /**
+     * @brief Constructs a source for the given file. Nothing is read until open() is called.
+     * @param filePath Path of the log file on disk.
+     */
+    explicit MappedLogSource(const QString &filePath);
+
+    /**
+     * @brief Constructs a source for a range of a file, such as an entry stored inside an archive.
+     * @param filePath Path identifying the source, e.g. the archive path followed by the entry path.
+     * @param containerPath Path of the file on disk holding the range.
+     * @param offset Offset of the range in the container.
+     * @param length Length of the range.
+     */
+    MappedLogSource(const QString &filePath, const QString &containerPath, qint64 offset, qint64 length);
+
+    /**
+     * @brief Releases the mapping, which is unmapped once no lease refers to it any more.
+     */
+    ~MappedLogSource() override;
+
+    /**
+     * @brief Opens and memory-maps the file.
+     * @return True on success; false otherwise, in which case errorString() describes the failure.
+     */
+    bool open() override;
+
+    /**
+     * @brief Builds the line-offset index in a single pass over the mapped bytes.
+     *
+     * Indexes of files of at least IndexCache::minimumFileSize bytes are persisted. If the
+     * file is unchanged since, the cached index is used as is; if it was only appended to,
+     * only the new bytes are scanned.
+     *
+     * @param progress Optional callback invoked after every chunk.
+     * @return True if the whole file was indexed; false if the source is not open or indexing was cancelled.
+     */
+    bool buildIndex(const ProgressCallback &progress = ProgressCallback()) override;
+
+    /**
+     * @brief Picks up changes of a fully indexed file that is still being written to.
+     *
+     * The file counts as changed if its size or modification time differs from when it was
+     * last indexed. It is then reopened by path. If it only grew, just the new bytes are
+     * indexed. If it shrank, kept its size, or its first bytes no longer hash to what they
+     * did when indexed, as happens after log rotation by truncation or renaming, the index
+     * is rebuilt. Either way the new file and index replace the old ones at once, when all
+     * scanning is done; if the file changes again while being scanned, nothing is replaced
+     * and the next refresh tries again.
+     *
+     * @param firstChangedLine Receives the first line whose content changed: the previous last
+     *        line if it was not terminated yet, otherwise the first new line; 0 after a reset.
+     * @return Appended if the file only grew, Reset if it was replaced or can no longer be
+     *         mapped, in which case the source is left empty, Unchanged otherwise.
+     */
+    RefreshResult refresh(qint64 &firstChangedLine) override;
+
+    /**
+     * @brief Stops reading through the mapping, which a rotation of the file could shrink.
+     */
+    void startFollowing() override;
+
+    /**
+     * @brief Returns true unless the source is a range of another file; mapped files can be followed.
+     */
+    bool isFollowable() const override;
+
+    /**
+     * @brief Returns the size of the mapped file in bytes.
+     */
+    qint64 inputSize() const override;
+
+protected:
+    /**
+     * @brief Returns a raw-data array referencing the mapping, or a copy once the file is followed; the lease is the mapping.
+     */
+    QByteArray readRange(qint64 offset, qint64 length, BytesLease *lease) const override;
+
+    /**
+     * @brief Returns the line like readRange(); a mapped line is trimmed before it is wrapped.
+     */
+    QByteArray readLine(qint64 offset, qint64 length, BytesLease *lease) const override;
+
+    /**
+     * @brief Returns the bytes like readRange(); all of the file is mapped, indexed or not.
+     */
+    QByteArray readAhead(qint64 offset, qint64 length) const override;
+
+private:
+    /**
+     * @brief Open file and its mapped bytes, unmapped and closed when the last owner lets go of them.
+     */
+    struct Mapping {
+        QFile file;                     ///< File the bytes are read from.
+        const uchar *data = nullptr;    ///< Start of the mapped bytes, nullptr for empty files and files read with QFile::read().
+        qint64 size = 0;                ///< Number of bytes the index covers.
+        qint64 modified = 0;            ///< Modification time of the file when it was opened, in ms since the epoch.
+        QMutex readMutex;               ///< Serializes the seek and read of unmapped files.
+
+        /**
+         * @brief Returns bytes in [offset, offset + length): a raw-data array if mapped, a copy otherwise.
+         *
+         * A copy is shorter than asked for if the file shrank meanwhile.
+         */
+        QByteArray read(qint64 offset, qint64 length);
+
+        /**
+         * @brief Unmaps the bytes and closes the file.
+         */
+        ~Mapping();
+    };
+
+    /**
+     * @brief Lines found by scanning part of a mapping, not yet published to readers.
+     */
+    struct Scan {
+        QVector<quint64> lineOffsets;   ///< Start of every line, beginning with the line scanning started at.
+        QVector<qint64> timestamps;     ///< Leading timestamp of every line.
+        qint64 longest = 0;             ///< Length of the longest line, including the lines before.
+    };
+
+    QString containerPath;              ///< Path of the file on disk holding the log.
+    std::shared_ptr<Mapping> mapping;   ///< Current mapping, replaced under the lock; nullptr until opened.
+    bool following = false;             ///< True once startFollowing() stopped reading through the mapping.
+    quint64 headHash = 0;               ///< Hash of the first headLength bytes when the file was last indexed.
+    qint64 headLength = 0;              ///< Number of bytes headHash covers, at most IndexCache::headTailSize.
+    qint64 rangeOffset = 0;             ///< Offset of the mapped range in the file.
+    qint64 rangeLength = -1;            ///< Length of the mapped range, -1 to map the whole file.
+
+    /**
+     * @brief Parses the timestamp of the line starting at the given offset of the current mapping.
+     */
+    qint64 parseTimestamp(qint64 offset) const;
+
+    /**
+     * @brief Opens the file and maps a range of it.
+     * @param length Number of bytes to map, -1 for the rest of the file.
+     * @param map False to read the file with QFile::read() instead of mapping it.
+     * @return The mapping, or nullptr on failure, in which case error describes it.
+     */
+    std::shared_ptr<Mapping> mapFile(qint64 offset, qint64 length, bool map = true);
+
+    /**
+     * @brief Remembers the hash of the first bytes of the file, as indexed, for refresh() to compare against.
+     * @param head First bytes of the file, at most IndexCache::headTailSize of them.
+     */
+    void rememberHead(const QByteArray &head);
+
+    /**
+     * @brief Scans a file chunk by chunk from the start of a line to its end, without touching the index.
+     * @param lineStart Start of the first line to scan.
+     * @param longestSoFar Length of the longest line before lineStart.
+     * @param scan Receives the lines found.
+     * @return False if the file shrank while it was scanned.
+     */
+    static bool scanMapping(Mapping &mapping, qint64 lineStart, qint64 longestSoFar, Scan &scan);
+
+    /**
+     * @brief Replaces the mapping and the lines from a line on by those of a scan, in one step.
+     * @param remapped Mapping the scan was made on.
+     * @param firstLine First line replaced by the scan; 0 replaces the whole index.
+     * @param scan Lines from firstLine on.
+     */
+    void publish(const std::shared_ptr<Mapping> &remapped, qint64 firstLine, const Scan &scan);
+
+    /**
+     * @brief Adopts the cached index if it still matches the file.
+     * @param resumeFrom Receives the offset scanning must continue from; the file size if nothing is left to scan.
+     * @return True if the cached index was adopted.
+     */
+    bool restoreFromCache(qint64 &resumeFrom);
+
+    /**
+     * @brief Persists the complete index to the on-disk cache.
+     */
+    void saveToCache() const;
+
+    /**
+     * @brief Drops the index and seeds it with the first line of the current mapping.
+     */
+    void resetIndex();
+
+    /**
+     * @brief Prepares appending to the index by rescanning its last line.
+     * @return Offset of the last indexed line, where scanning must resume.
+     */
+    qint64 resumeAtLastLine();
+
+    /**
+     * @brief Indexes the mapped bytes from resumeFrom to the end, chunk by chunk.
+     * @param resumeFrom Start of the line scanning resumes at.
+     * @param progress Optional callback invoked after every chunk.
+     * @return False if indexing was cancelled.
+     */
+    bool scanFrom(qint64 resumeFrom, const ProgressCallback &progress);
+};
+
+#endif // MAPPEDLOGSOURCE_H
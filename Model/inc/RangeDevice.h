@@ -0,0 +1,53 @@
+#ifndef RANGEDEVICE_H
+#define RANGEDEVICE_H
+
+#include <QIODevice>
+
+/**
+ * @brief Read-only, random-access device over a range of another device, e.g. one entry inside an archive file.
+ */
+class RangeDevice : public QIODevice
+{
+    Q_OBJECT
+
+public:
+    /**
+     * @brief Constructs a device over [offset, offset + length) of base.
+     * @param base Random-access device, opened for reading; not owned.
+     * @param offset Offset of the range in base.
+     * @param length Length of the range.
+     * @param parent The parent QObject.
+     */
+    RangeDevice(QIODevice *base, qint64 offset, qint64 length, QObject *parent = nullptr);
+
+    /**
+     * @brief Opens the device; only ReadOnly is supported.
+     */
+    bool open(OpenMode mode) override;
+
+    /**
+     * @brief Returns false; the range can be read at any position.
+     */
+    bool isSequential() const override;
+
+    /**
+     * @brief Returns the length of the range.
+     */
+    qint64 size() const override;
+
+    /**
+     * @brief Moves to a position within the range.
+     */
+    bool seek(qint64 pos) override;
+
+protected:
+    qint64 readData(char *data, qint64 maxSize) override;
+    qint64 writeData(const char *data, qint64 maxSize) override;
+
+private:
+    QIODevice *base;    ///< Device the range belongs to.
+    qint64 offset;      ///< Start of the range in base.
+    qint64 length;      ///< Length of the range.
+};
+
+#endif // RANGEDEVICE_H
@@ -0,0 +1,54 @@
+#ifndef TEXTSEARCHER_H
+#define TEXTSEARCHER_H
+
+#include <QString>
+#include <QByteArray>
+#include <QByteArrayMatcher>
+
+/**
+ * @brief Search kernel finding a literal pattern in UTF-8 text, without decoding it.
+ *
+ * The pattern is encoded once and searched for in the raw bytes of a log, so buffers never
+ * have to be converted to QString. Candidates are found by comparing the first and the last
+ * byte of the pattern against 32 or 16 positions at a time, with the AVX2 or SSE2 kernel that
+ * LineScanner selected for this CPU; only those are compared in full. Case-insensitive searches
+ * accept both cases of the two bytes and fold ASCII letters only; other characters of the
+ * pattern have to match exactly, so callers match such patterns in decoded text instead.
+ * Without a kernel, and for the tail of a buffer, case-sensitive searches use Boyer-Moore
+ * through QByteArrayMatcher.
+ */
+class TextSearcher
+{
+public:
+    /**
+     * @brief Creates a searcher for a pattern.
+     * @param pattern Text to search for.
+     * @param caseSensitivity Whether letters have to match in case.
+     */
+    TextSearcher(const QString &pattern, Qt::CaseSensitivity caseSensitivity);
+
+    /**
+     * @brief Returns true if the pattern is empty, in which case nothing matches.
+     */
+    bool isEmpty() const;
+
+    /**
+     * @brief Returns the length of the encoded pattern in bytes.
+     */
+    qint64 patternLength() const;
+
+    /**
+     * @brief Returns the offset of the first match at or after from, or -1 if there is none.
+     * @param data Bytes to search.
+     * @param length Number of bytes in data.
+     * @param from Offset to start searching at.
+     */
+    qint64 indexIn(const char *data, qint64 length, qint64 from = 0) const;
+
+private:
+    QByteArray needle;                      ///< Pattern encoded as UTF-8, ASCII letters lowercased if case-insensitive.
+    Qt::CaseSensitivity caseSensitivity;    ///< Whether letters have to match in case.
+    QByteArrayMatcher matcher;              ///< Boyer-Moore tables for case-sensitive searches without SIMD and for the tail of a buffer.
+};
+
+#endif // TEXTSEARCHER_H
@@ -0,0 +1,43 @@
+#ifndef TIMESTAMPPARSER_H
+#define TIMESTAMPPARSER_H
+
+#include <QtGlobal>
+#include <limits>
+
+/**
+ * @brief Parses the timestamp a log line starts with, without going through QDateTime.
+ *
+ * Recognizes "YYYY-MM-DD HH:MM:SS" with an optional leading '[', a 'T' instead of the space
+ * and an optional ".mmm" or ",mmm" fraction, which covers the bracketed format used by
+ * sorting as well as ISO 8601 logs. The result is the number of milliseconds since
+ * 1970-01-01 00:00:00 in the log's own (unspecified) time zone, which is all that is needed
+ * to order and look up lines.
+ */
+class TimestampParser
+{
+public:
+    /**
+     * @brief Value returned for lines that do not start with a timestamp.
+     */
+    static constexpr qint64 NoTimestamp = std::numeric_limits<qint64>::min();
+
+    /**
+     * @brief Maximum number of bytes parse() looks at.
+     */
+    static constexpr qint64 maxLength = 24;
+
+    /**
+     * @brief Parses the timestamp at the start of a line.
+     * @param text Start of the line; at most the first maxLength bytes are read.
+     * @param length Number of bytes available at text.
+     * @return Milliseconds since the epoch, or NoTimestamp.
+     */
+    static qint64 parse(const char *text, qint64 length);
+
+    /**
+     * @brief Converts a calendar date and time to milliseconds since the epoch.
+     */
+    static qint64 toMSecs(int year, int month, int day, int hour, int minute, int second, int msec = 0);
+};
+
+#endif // TIMESTAMPPARSER_H
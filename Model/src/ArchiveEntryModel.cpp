@@ -0,0 +1,449 @@
+#include "ArchiveEntryModel.h"
+#include <QLocale>
+#include <QRegularExpression>
+#include <algorithm>
+#include <numeric>
+
+namespace {
+// Fenwick tree helpers; tree[0] is unused
+void fenwickAdd(QVector<int> &tree, int position, int delta) {
+    for (int i = position + 1; i < tree.size(); i += i & -i) {
+        tree[i] += delta;
+    }
+}
+
+int fenwickSumBefore(const QVector<int> &tree, int position) {
+    int sum = 0;
+    for (int i = position; i > 0; i -= i & -i) {
+        sum += tree.at(i);
+    }
+    return sum;
+}
+
+bool isGlob(const QString &pattern) {
+    return pattern.contains('*') || pattern.contains('?') || pattern.contains('[');
+}
+}
+
+ArchiveEntryModel::ArchiveEntryModel(const QSharedPointer<ArchiveSession> &archive, QObject *parent)
+    : QAbstractItemModel(parent), archive(archive),
+      folderIcon(":/Resources/Icons/folder.png"), fileIcon(":/Resources/Icons/file.png") {
+    const QVector<ArchiveSession::Entry> &entries = archive->entries();
+    const int count = entries.size();
+
+    // Sorted by path, every directory covers a contiguous range of entries
+    order.resize(count);
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [&entries](int a, int b) {
+        return entries.at(a).path < entries.at(b).path;
+    });
+
+    sizeBefore.resize(count + 1);
+    compressedBefore.resize(count + 1);
+    sizeBefore[0] = 0;
+    compressedBefore[0] = 0;
+    for (int i = 0; i < count; ++i) {
+        sizeBefore[i + 1] = sizeBefore.at(i) + entryAt(i).size;
+        compressedBefore[i + 1] = compressedBefore.at(i) + entryAt(i).compressedSize;
+    }
+
+    checked.resize(count);
+    checkedTree.fill(0, count + 1);
+
+    Node root;
+    root.end = count;
+    nodes.append(root);
+    populate(0);
+    nodes[0].populated = true;
+}
+
+const ArchiveSession::Entry &ArchiveEntryModel::entryAt(int position) const {
+    return archive->entries().at(order.at(position));
+}
+
+QModelIndex ArchiveEntryModel::index(int row, int column, const QModelIndex &parent) const {
+    if (row < 0 || column < 0 || column >= ColumnCount) {
+        return QModelIndex();
+    }
+    if (isFiltered()) {
+        if (parent.isValid() || row >= matches.size()) {
+            return QModelIndex();
+        }
+        return createIndex(row, column, static_cast<quintptr>(matches.at(row)));
+    }
+
+    const Node &node = nodes.at(parent.isValid() ? static_cast<int>(parent.internalId()) : 0);
+    if (row >= node.children.size()) {
+        return QModelIndex();
+    }
+    return createIndex(row, column, static_cast<quintptr>(node.children.at(row)));
+}
+
+QModelIndex ArchiveEntryModel::parent(const QModelIndex &child) const {
+    if (!child.isValid() || isFiltered()) {
+        return QModelIndex();
+    }
+    const int parentNode = nodes.at(static_cast<int>(child.internalId())).parent;
+    if (parentNode <= 0) {
+        return QModelIndex();
+    }
+    return createIndex(nodes.at(parentNode).row, 0, static_cast<quintptr>(parentNode));
+}
+
+int ArchiveEntryModel::rowCount(const QModelIndex &parent) const {
+    if (parent.column() > 0) {
+        return 0;
+    }
+    if (isFiltered()) {
+        return parent.isValid() ? 0 : matches.size();
+    }
+    const Node &node = nodes.at(parent.isValid() ? static_cast<int>(parent.internalId()) : 0);
+    return node.populated ? node.children.size() : 0;
+}
+
+int ArchiveEntryModel::columnCount(const QModelIndex &parent) const {
+    Q_UNUSED(parent);
+    return ColumnCount;
+}
+
+bool ArchiveEntryModel::hasChildren(const QModelIndex &parent) const {
+    if (!parent.isValid()) {
+        return isFiltered() ? !matches.isEmpty() : !order.isEmpty();
+    }
+    if (isFiltered() || parent.column() > 0) {
+        return false;
+    }
+    return nodes.at(static_cast<int>(parent.internalId())).prefixLength > 0;
+}
+
+bool ArchiveEntryModel::canFetchMore(const QModelIndex &parent) const {
+    if (isFiltered() || !parent.isValid()) {
+        return false;
+    }
+    const Node &node = nodes.at(static_cast<int>(parent.internalId()));
+    return node.prefixLength > 0 && !node.populated;
+}
+
+void ArchiveEntryModel::fetchMore(const QModelIndex &parent) {
+    if (!canFetchMore(parent)) {
+        return;
+    }
+    const int node = static_cast<int>(parent.internalId());
+    populate(node); // Children are created but not visible until populated is set
+    beginInsertRows(parent, 0, nodes.at(node).children.size() - 1);
+    nodes[node].populated = true;
+    endInsertRows();
+}
+
+void ArchiveEntryModel::populate(int node) {
+    const int begin = nodes.at(node).begin;
+    const int end = nodes.at(node).end;
+    const int prefixLength = nodes.at(node).prefixLength;
+
+    QVector<int> children;
+    for (int i = begin; i < end;) {
+        const QString &path = entryAt(i).path;
+        Node child;
+        child.parent = node;
+        child.row = children.size();
+        child.begin = i;
+
+        const int slash = path.indexOf('/', prefixLength);
+        if (slash < 0) {
+            child.end = ++i;
+        } else {
+            // All entries of the subdirectory follow each other in sorted order
+            const QStringView directory = QStringView(path).left(slash + 1);
+            child.prefixLength = slash + 1;
+            for (++i; i < end && entryAt(i).path.startsWith(directory); ++i) {
+            }
+            child.end = i;
+        }
+        children.append(nodes.size());
+        nodes.append(child);
+    }
+    nodes[node].children = children;
+}
+
+QVariant ArchiveEntryModel::data(const QModelIndex &index, int role) const {
+    if (!index.isValid()) {
+        return QVariant();
+    }
+
+    int begin;
+    int end;
+    bool isFile;
+    QString name;
+    if (isFiltered()) {
+        begin = static_cast<int>(index.internalId());
+        end = begin + 1;
+        isFile = true;
+        name = entryAt(begin).path;
+    } else {
+        const Node &node = nodes.at(static_cast<int>(index.internalId()));
+        begin = node.begin;
+        end = node.end;
+        isFile = node.prefixLength == 0;
+        const QString &path = entryAt(begin).path;
+        const int nameEnd = isFile ? path.size() : node.prefixLength - 1;
+        const int nameStart = path.lastIndexOf('/', nameEnd - 1) + 1;
+        name = path.mid(nameStart, nameEnd - nameStart);
+    }
+
+    switch (role) {
+    case Qt::DisplayRole:
+        if (index.column() == NameColumn) {
+            return name;
+        }
+        if (index.column() == SizeColumn) {
+            return QLocale().formattedDataSize(sizeBefore.at(end) - sizeBefore.at(begin));
+        }
+        return QLocale().formattedDataSize(compressedBefore.at(end) - compressedBefore.at(begin));
+    case Qt::DecorationRole:
+        if (index.column() == NameColumn) {
+            return isFile ? fileIcon : folderIcon;
+        }
+        break;
+    case Qt::CheckStateRole:
+        if (index.column() == NameColumn) {
+            const int count = checkedIn(begin, end);
+            return count == 0 ? Qt::Unchecked : (count == end - begin ? Qt::Checked : Qt::PartiallyChecked);
+        }
+        break;
+    case Qt::TextAlignmentRole:
+        if (index.column() != NameColumn) {
+            return int(Qt::AlignRight | Qt::AlignVCenter);
+        }
+        break;
+    case Qt::ToolTipRole:
+        if (isFile) {
+            return entryAt(begin).path;
+        }
+        break;
+    case EntryPathRole:
+        return isFile ? entryAt(begin).path : QString();
+    default:
+        break;
+    }
+    return QVariant();
+}
+
+bool ArchiveEntryModel::setData(const QModelIndex &index, const QVariant &value, int role) {
+    if (!index.isValid() || index.column() != NameColumn || role != Qt::CheckStateRole) {
+        return false;
+    }
+
+    const bool check = static_cast<Qt::CheckState>(value.toInt()) == Qt::Checked;
+    const int id = static_cast<int>(index.internalId());
+    if (isFiltered()) {
+        setCheckedRange(id, id + 1, check);
+        emit dataChanged(index, index, {Qt::CheckStateRole});
+    } else {
+        // Checking a directory checks everything below it
+        setCheckedRange(nodes.at(id).begin, nodes.at(id).end, check);
+        emit dataChanged(index, index, {Qt::CheckStateRole});
+        notifyDescendants(id);
+        notifyAncestors(id);
+    }
+    emit checkedChanged();
+    return true;
+}
+
+Qt::ItemFlags ArchiveEntryModel::flags(const QModelIndex &index) const {
+    if (!index.isValid()) {
+        return Qt::NoItemFlags;
+    }
+    Qt::ItemFlags itemFlags = Qt::ItemIsEnabled | Qt::ItemIsSelectable;
+    if (index.column() == NameColumn) {
+        itemFlags |= Qt::ItemIsUserCheckable;
+    }
+    if (isFiltered() || nodes.at(static_cast<int>(index.internalId())).prefixLength == 0) {
+        itemFlags |= Qt::ItemNeverHasChildren;
+    }
+    return itemFlags;
+}
+
+QVariant ArchiveEntryModel::headerData(int section, Qt::Orientation orientation, int role) const {
+    if (orientation != Qt::Horizontal || role != Qt::DisplayRole) {
+        return QVariant();
+    }
+    switch (section) {
+    case NameColumn:
+        return tr("Name");
+    case SizeColumn:
+        return tr("Size");
+    case CompressedSizeColumn:
+        return tr("Compressed");
+    default:
+        return QVariant();
+    }
+}
+
+void ArchiveEntryModel::setFilter(const QString &pattern) {
+    const QString trimmed = pattern.trimmed();
+    if (trimmed == filter) {
+        return;
+    }
+
+    beginResetModel();
+    if (trimmed.isEmpty()) {
+        matches.clear();
+    } else if (isGlob(trimmed)) {
+        const QRegularExpression expression = QRegularExpression::fromWildcard(trimmed, Qt::CaseInsensitive);
+        const bool matchPath = trimmed.contains('/');
+        matches.clear();
+        for (int i = 0; i < order.size(); ++i) {
+            const QString &path = entryAt(i).path;
+            if (expression.match(matchPath ? path : path.mid(path.lastIndexOf('/') + 1)).hasMatch()) {
+                matches.append(i);
+            }
+        }
+    } else {
+        // Typing on narrows the previous matches instead of searching everything again
+        const bool narrowing = substringFilter && !filter.isEmpty() && trimmed.contains(filter, Qt::CaseInsensitive);
+        QVector<int> candidates;
+        if (narrowing) {
+            candidates.swap(matches);
+        } else {
+            candidates.resize(order.size());
+            std::iota(candidates.begin(), candidates.end(), 0);
+        }
+        matches.clear();
+        for (int position : std::as_const(candidates)) {
+            if (entryAt(position).path.contains(trimmed, Qt::CaseInsensitive)) {
+                matches.append(position);
+            }
+        }
+    }
+    filter = trimmed;
+    substringFilter = !trimmed.isEmpty() && !isGlob(trimmed);
+    endResetModel();
+}
+
+bool ArchiveEntryModel::isFiltered() const {
+    return !filter.isEmpty();
+}
+
+int ArchiveEntryModel::matchCount() const {
+    return isFiltered() ? matches.size() : order.size();
+}
+
+void ArchiveEntryModel::setMatchingChecked(bool check) {
+    if (isFiltered()) {
+        for (int position : std::as_const(matches)) {
+            setCheckedRange(position, position + 1, check);
+        }
+        if (!matches.isEmpty()) {
+            emit dataChanged(index(0, NameColumn), index(matches.size() - 1, NameColumn), {Qt::CheckStateRole});
+        }
+    } else {
+        setCheckedRange(0, order.size(), check);
+        notifyDescendants(0);
+    }
+    emit checkedChanged();
+}
+
+QStringList ArchiveEntryModel::checkedEntries() const {
+    QStringList paths;
+    paths.reserve(checkedTotal);
+    for (int i = 0; i < order.size(); ++i) {
+        if (checked.testBit(i)) {
+            paths.append(entryAt(i).path);
+        }
+    }
+    return paths;
+}
+
+void ArchiveEntryModel::setCheckedEntries(const QStringList &entryPaths) {
+    setCheckedRange(0, order.size(), false);
+
+    QVector<int> positions(order.size());
+    for (int i = 0; i < order.size(); ++i) {
+        positions[order.at(i)] = i;
+    }
+    const QVector<ArchiveSession::Entry> &entries = archive->entries();
+    for (const QString &entryPath : entryPaths) {
+        const ArchiveSession::Entry *entry = archive->entry(entryPath);
+        if (entry) {
+            const int position = positions.at(static_cast<int>(entry - entries.constData()));
+            setCheckedRange(position, position + 1, true);
+        }
+    }
+
+    if (!isFiltered()) {
+        notifyDescendants(0);
+    } else if (!matches.isEmpty()) {
+        emit dataChanged(index(0, NameColumn), index(matches.size() - 1, NameColumn), {Qt::CheckStateRole});
+    }
+    emit checkedChanged();
+}
+
+QStringList ArchiveEntryModel::matchingEntries() const {
+    QStringList paths;
+    if (isFiltered()) {
+        paths.reserve(matches.size());
+        for (int position : matches) {
+            paths.append(entryAt(position).path);
+        }
+    } else {
+        paths.reserve(order.size());
+        for (int i = 0; i < order.size(); ++i) {
+            paths.append(entryAt(i).path);
+        }
+    }
+    return paths;
+}
+
+int ArchiveEntryModel::checkedCount() const {
+    return checkedTotal;
+}
+
+qint64 ArchiveEntryModel::checkedSize() const {
+    return checkedBytes;
+}
+
+qint64 ArchiveEntryModel::checkedCompressedSize() const {
+    return checkedCompressedBytes;
+}
+
+int ArchiveEntryModel::checkedIn(int begin, int end) const {
+    return fenwickSumBefore(checkedTree, end) - fenwickSumBefore(checkedTree, begin);
+}
+
+void ArchiveEntryModel::setCheckedRange(int begin, int end, bool value) {
+    for (int i = begin; i < end; ++i) {
+        if (checked.testBit(i) == value) {
+            continue;
+        }
+        checked.setBit(i, value);
+        const int delta = value ? 1 : -1;
+        fenwickAdd(checkedTree, i, delta);
+        checkedTotal += delta;
+        checkedBytes += delta * entryAt(i).size;
+        checkedCompressedBytes += delta * entryAt(i).compressedSize;
+    }
+}
+
+void ArchiveEntryModel::notifyDescendants(int node) {
+    const Node &current = nodes.at(node);
+    if (!current.populated || current.children.isEmpty()) {
+        return;
+    }
+    const QModelIndex parentIndex = node == 0 ? QModelIndex() : createIndex(current.row, 0, static_cast<quintptr>(node));
+    emit dataChanged(index(0, NameColumn, parentIndex), index(current.children.size() - 1, NameColumn, parentIndex),
+                     {Qt::CheckStateRole});
+
+    const QVector<int> children = current.children;
+    for (int child : children) {
+        if (nodes.at(child).prefixLength > 0) {
+            notifyDescendants(child);
+        }
+    }
+}
+
+void ArchiveEntryModel::notifyAncestors(int node) {
+    for (int ancestor = nodes.at(node).parent; ancestor > 0; ancestor = nodes.at(ancestor).parent) {
+        const QModelIndex ancestorIndex = createIndex(nodes.at(ancestor).row, 0, static_cast<quintptr>(ancestor));
+        emit dataChanged(ancestorIndex, ancestorIndex, {Qt::CheckStateRole});
+    }
+}
@@ -0,0 +1,172 @@
+#include "ArchiveSearch.h"
+#include <QIODevice>
+#include <algorithm>
+#include <cstring>
+#include "LineMatcher.h"
+
+namespace {
+const qint64 readBufferSize = 1024 * 1024;          // Uncompressed bytes read from an entry at a time
+const qint64 maxLineBufferSize = 64 * 1024 * 1024;  // Longer lines are searched in pieces
+const qint64 maxHitBytes = 4096;                    // Bytes of a matching line kept for display
+
+// Searches a stream line by line; returns the number of bytes read, or -1 on errors
+qint64 searchStream(QIODevice *device, const LineMatcher &matcher, int maxHits, const std::atomic<bool> &stop,
+                    ArchiveSearch::Result &result) {
+    const TextSearcher &searcher = matcher.literal();
+    QByteArray buffer(readBufferSize, Qt::Uninitialized);
+    qint64 carry = 0;   // Unterminated line kept from the previous read
+    qint64 line = 0;    // Line number of buffer[0]
+    qint64 total = 0;
+    while (!stop) {
+        const qint64 read = device->read(buffer.data() + carry, buffer.size() - carry);
+        if (read < 0) {
+            result.error = QObject::tr("Unable to read the file from the archive: %1").arg(device->errorString());
+            return -1;
+        }
+        total += read;
+        const bool atEnd = read == 0;
+        const qint64 valid = carry + read;
+
+        // Only whole lines are searched, the unterminated rest waits for the next read
+        qint64 end = valid;
+        if (!atEnd) {
+            while (end > 0 && buffer.at(end - 1) != '\n') {
+                --end;
+            }
+            if (end == 0) {
+                if (buffer.size() < maxLineBufferSize) {
+                    carry = valid;
+                    buffer.resize(buffer.size() * 2);
+                    continue;
+                }
+                end = valid;
+            }
+        }
+
+        const char *data = buffer.constData();
+        qint64 position = 0;    // Always at the start of a line
+        qint64 counted = 0;     // Newlines before this offset are included in line
+        qint64 match;
+        // Without a literal every line is a candidate
+        while ((match = matcher.hasLiteral() ? searcher.indexIn(data, end, position) : (position < end ? position : -1)) >= 0) {
+            qint64 lineStart = match;
+            while (lineStart > position && data[lineStart - 1] != '\n') {
+                --lineStart;
+            }
+            const char *newline = static_cast<const char *>(std::memchr(data + match, '\n', static_cast<size_t>(end - match)));
+            const qint64 lineEnd = newline ? newline - data : end;
+            qint64 length = lineEnd - lineStart;
+            if (length > 0 && data[lineEnd - 1] == '\r') {
+                --length;
+            }
+            position = lineEnd + 1;
+
+            // A candidate the literal does not settle is decoded and matched as a whole, e.g. non-ASCII text ignoring case
+            if (!matcher.isLiteralExact()) {
+                qsizetype matchLength = 0;
+                if (matcher.indexIn(QString::fromUtf8(data + lineStart, length), 0, &matchLength) < 0) {
+                    continue;
+                }
+            }
+
+            ++result.matchingLines;
+            if (result.hits.size() < maxHits) {
+                line += std::count(data + counted, data + lineStart, '\n');
+                counted = lineStart;
+                result.hits.append(ArchiveSearch::Hit{line, QString::fromUtf8(data + lineStart, qMin(length, maxHitBytes))});
+            }
+        }
+        if (atEnd) {
+            break;
+        }
+
+        if (result.hits.size() < maxHits) {
+            line += std::count(data + counted, data + end, '\n');
+        }
+        carry = valid - end;
+        std::memmove(buffer.data(), data + end, static_cast<size_t>(carry));
+    }
+    return total;
+}
+}
+
+ArchiveSearch::ArchiveSearch(const QSharedPointer<ArchiveSession> &archive, QObject *parent)
+    : QObject(parent), archive(archive), stop(std::make_shared<std::atomic<bool>>(false)) {}
+
+ArchiveSearch::~ArchiveSearch() {
+    stop->store(true);
+    pool.clear();
+    pool.waitForDone();
+}
+
+void ArchiveSearch::start(const QStringList &entryPaths, const QString &text, Qt::CaseSensitivity caseSensitivity, int maxHits) {
+    cancel();
+
+    ++generation;
+    stop = std::make_shared<std::atomic<bool>>(false);
+    entriesTotal = entryPaths.size();
+    entriesDone = 0;
+    bytesSearched = 0;
+    if (entryPaths.isEmpty() || text.isEmpty()) {
+        emit finished(false);
+        return;
+    }
+    running = true;
+
+    // Longest job first, as for ingestion, so one big entry does not run on alone at the end
+    QStringList bySize = entryPaths;
+    std::stable_sort(bySize.begin(), bySize.end(), [this](const QString &a, const QString &b) {
+        const ArchiveSession::Entry *entryA = archive->entry(a);
+        const ArchiveSession::Entry *entryB = archive->entry(b);
+        return (entryA ? entryA->size : 0) > (entryB ? entryB->size : 0);
+    });
+    archive->prepare(bySize);
+
+    const LineMatcher matcher(text, caseSensitivity, false);
+    const int searchGeneration = generation;
+    for (const QString &entryPath : std::as_const(bySize)) {
+        pool.start([this, session = archive, flag = stop, matcher, entryPath, maxHits, searchGeneration]() {
+            Result result;
+            result.entryPath = entryPath;
+            qint64 bytes = 0;
+            if (!*flag) {
+                std::unique_ptr<QIODevice> device(session->openEntry(entryPath, &result.error));
+                if (device) {
+                    bytes = qMax<qint64>(searchStream(device.get(), matcher, maxHits, *flag, result), 0);
+                }
+            }
+            QMetaObject::invokeMethod(this, [this, searchGeneration, result, bytes]() {
+                onEntrySearched(searchGeneration, result, bytes);
+            }, Qt::QueuedConnection);
+        });
+    }
+}
+
+void ArchiveSearch::cancel() {
+    if (!running) {
+        return;
+    }
+    stop->store(true);
+    pool.clear();
+    ++generation; // Workers still running report to a search that is over
+    running = false;
+    emit finished(true);
+}
+
+bool ArchiveSearch::isRunning() const {
+    return running;
+}
+
+void ArchiveSearch::onEntrySearched(int searchGeneration, const Result &result, qint64 bytes) {
+    if (searchGeneration != generation) {
+        return;
+    }
+    ++entriesDone;
+    bytesSearched += bytes;
+    emit entrySearched(result);
+    emit progress(entriesDone, entriesTotal, bytesSearched);
+    if (entriesDone == entriesTotal) {
+        running = false;
+        emit finished(false);
+    }
+}
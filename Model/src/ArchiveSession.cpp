@@ -0,0 +1,718 @@
+#include "ArchiveSession.h"
+#include <QObject>
+#include <QFile>
+#include <QFileInfo>
+#include <QDateTime>
+#include <QTemporaryDir>
+#include <QMutexLocker>
+#include <KZip>
+#include <KZipFileEntry>
+#include <K7Zip>
+#include <KArchiveDirectory>
+#include <KArchiveFile>
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include "MappedLogSource.h"
+#include "CompressedLogSource.h"
+#include "RangeDevice.h"
+
+namespace {
+const int methodStored = 0;
+const int methodDeflated = 8;
+
+const qint64 tarBlockSize = 512;
+const qint64 tarMaxExtendedHeader = 1024 * 1024;    // Longest GNU long name or pax header accepted
+const qint64 progressInterval = 4 * 1024 * 1024;    // Compressed bytes read between two progress reports
+const qint64 spoolChunkSize = 1024 * 1024;          // Bytes copied at a time when spooling a 7z entry
+
+// Reads until length bytes are read or the device is exhausted; returns -1 on errors
+qint64 readFully(QIODevice *device, char *buffer, qint64 length) {
+    qint64 total = 0;
+    while (total < length) {
+        qint64 read = device->read(buffer + total, length - total);
+        if (read < 0) {
+            return -1;
+        }
+        if (read == 0) {
+            break;
+        }
+        total += read;
+    }
+    return total;
+}
+
+// Appends the file entries of a directory and its subdirectories
+void collectEntries(const KArchiveDirectory *directory, const QString &prefix, int container, bool zip,
+                    QVector<ArchiveSession::Entry> &entries) {
+    const QStringList names = directory->entries();
+    for (const QString &name : names) {
+        const KArchiveEntry *archiveEntry = directory->entry(name);
+        if (archiveEntry->isDirectory()) {
+            collectEntries(static_cast<const KArchiveDirectory *>(archiveEntry), prefix + name + "/", container, zip, entries);
+            continue;
+        }
+
+        const KArchiveFile *file = static_cast<const KArchiveFile *>(archiveEntry);
+        ArchiveSession::Entry entry;
+        entry.path = prefix + name;
+        entry.size = file->size();
+        entry.compressedSize = file->size();
+        entry.container = container;
+        if (zip) {
+            const KZipFileEntry *zipFile = static_cast<const KZipFileEntry *>(file);
+            entry.compressedSize = zipFile->compressedSize();
+            entry.position = zipFile->position();
+            entry.encoding = zipFile->encoding();
+        }
+        entries.append(entry);
+    }
+}
+
+// Parses a numeric TAR header field, octal or GNU base-256; returns -1 if it is malformed
+qint64 tarNumber(const char *field, int length) {
+    const unsigned char *bytes = reinterpret_cast<const unsigned char *>(field);
+    if (bytes[0] & 0x80) {
+        qint64 value = bytes[0] & 0x3f;
+        for (int i = 1; i < length; ++i) {
+            if (value > (std::numeric_limits<qint64>::max() >> 8)) {
+                return -1;
+            }
+            value = (value << 8) | bytes[i];
+        }
+        return value;
+    }
+
+    int i = 0;
+    while (i < length && (field[i] == ' ' || field[i] == '\0')) {
+        ++i;
+    }
+    qint64 value = 0;
+    bool digits = false;
+    for (; i < length && field[i] >= '0' && field[i] <= '7'; ++i) {
+        value = value * 8 + (field[i] - '0');
+        digits = true;
+    }
+    return digits ? value : -1;
+}
+
+// Returns a NUL-terminated or full-length TAR header field as a string
+QString tarString(const char *field, int length) {
+    return QString::fromUtf8(field, static_cast<int>(qstrnlen(field, length)));
+}
+
+bool tarChecksumMatches(const char *header) {
+    const qint64 expected = tarNumber(header + 148, 8);
+    qint64 unsignedSum = 0;
+    qint64 signedSum = 0;   // Some old tar implementations summed signed chars
+    for (int i = 0; i < tarBlockSize; ++i) {
+        const char byte = (i >= 148 && i < 156) ? ' ' : header[i];
+        unsignedSum += static_cast<unsigned char>(byte);
+        signedSum += static_cast<signed char>(byte);
+    }
+    return expected == unsignedSum || expected == signedSum;
+}
+
+// Reads the path and size records of a pax extended header
+void parsePaxHeader(const QByteArray &data, QString &path, qint64 &size) {
+    qint64 position = 0;
+    while (position < data.size()) {
+        const qint64 space = data.indexOf(' ', position);
+        if (space < 0) {
+            return;
+        }
+        const qint64 recordLength = data.mid(position, space - position).toLongLong();
+        if (recordLength <= 0 || position + recordLength > data.size()) {
+            return;
+        }
+        const QByteArray record = data.mid(space + 1, position + recordLength - space - 2); // Without the newline
+        const qint64 equals = record.indexOf('=');
+        if (equals > 0) {
+            const QByteArray key = record.left(equals);
+            if (key == "path") {
+                path = QString::fromUtf8(record.mid(equals + 1));
+            } else if (key == "size") {
+                size = record.mid(equals + 1).toLongLong();
+            }
+        }
+        position += recordLength;
+    }
+}
+}
+
+ArchiveSession::ArchiveSession(const QString &archivePath) : path(archivePath) {}
+
+ArchiveSession::~ArchiveSession() {}
+
+bool ArchiveSession::isArchive(const QString &filePath) {
+    DecompressingDevice::Compression compression;
+    return formatForPath(filePath, compression) != NoArchive;
+}
+
+ArchiveSession::Format ArchiveSession::formatForPath(const QString &filePath, DecompressingDevice::Compression &compression) {
+    const QString name = QFileInfo(filePath).fileName().toLower();
+    compression = DecompressingDevice::None;
+    if (name.endsWith(".zip")) {
+        return Zip;
+    }
+    if (name.endsWith(".7z")) {
+        return SevenZip;
+    }
+    if (name.endsWith(".tar")) {
+        return Tar;
+    }
+
+    // Compressed TARs: .tar.gz and the like, or the short forms .tgz, .tbz2, .txz and .tzst
+    const int dot = name.lastIndexOf('.');
+    if (dot < 0) {
+        return NoArchive;
+    }
+    const QString suffix = name.mid(dot + 1);
+    if (!name.left(dot).endsWith(".tar") && !suffix.startsWith('t')) {
+        return NoArchive;
+    }
+    compression = DecompressingDevice::compressionForPath(name);
+    return compression == DecompressingDevice::None ? NoArchive : Tar;
+}
+
+QSharedPointer<ArchiveSession> ArchiveSession::open(const QString &archivePath, QString *errorString, const ProgressCallback &progress) {
+    DecompressingDevice::Compression compression;
+    const Format format = formatForPath(archivePath, compression);
+    if (format == NoArchive) {
+        if (errorString) *errorString = QObject::tr("Unsupported archive format.");
+        return QSharedPointer<ArchiveSession>();
+    }
+
+    const QFileInfo fileInfo(archivePath);
+    if (!fileInfo.isFile()) {
+        if (errorString) *errorString = QObject::tr("Unable to open file.");
+        return QSharedPointer<ArchiveSession>();
+    }
+
+    QSharedPointer<ArchiveSession> session(new ArchiveSession(archivePath));
+    session->archiveSize = fileInfo.size();
+    session->modified = fileInfo.lastModified().toMSecsSinceEpoch();
+
+    int container = session->addContainer(-1, 0, session->archiveSize, DecompressingDevice::None, session->archiveSize);
+    if (compression != DecompressingDevice::None) {
+        container = session->addContainer(container, 0, session->archiveSize, compression, -1);
+    }
+    QSet<int> expanded;
+    if (!session->list(container, format, QString(), 0, progress, expanded, errorString)) {
+        return QSharedPointer<ArchiveSession>();
+    }
+
+    // Archives that were listed show up as directories instead
+    if (!expanded.isEmpty()) {
+        QVector<Entry> files;
+        files.reserve(session->entryList.size() - expanded.size());
+        for (int i = 0; i < session->entryList.size(); ++i) {
+            if (!expanded.contains(i)) {
+                files.append(session->entryList.at(i));
+            }
+        }
+        session->entryList = std::move(files);
+    }
+
+    QSet<QString> names;
+    for (int i = 0; i < session->entryList.size(); ++i) {
+        const QString &entryPath = session->entryList.at(i).path;
+        session->entryIndex.insert(entryPath, i);
+        const QString name = QFileInfo(entryPath).fileName();
+        if (names.contains(name)) {
+            session->sharedNames.insert(name);
+        }
+        names.insert(name);
+    }
+    return session;
+}
+
+int ArchiveSession::addContainer(int parent, qint64 offset, qint64 length, DecompressingDevice::Compression compression, qint64 size) {
+    Container container;
+    container.parent = parent;
+    container.offset = offset;
+    container.length = length;
+    container.compression = compression;
+    container.size = size;
+    containers.append(container);
+    return containers.size() - 1;
+}
+
+bool ArchiveSession::list(int container, Format format, const QString &prefix, int depth, const ProgressCallback &progress,
+                          QSet<int> &expanded, QString *errorString) {
+    containers[container].prefix = prefix;
+    const int first = entryList.size();
+    const bool listed = format == Tar ? listTar(container, prefix, progress, errorString)
+                                      : listKArchive(container, format, prefix, errorString);
+    if (!listed) {
+        return false;
+    }
+    if (format == SevenZip || depth + 1 >= maxNestingDepth) {
+        return true; // 7z entries have no position to read a nested archive from
+    }
+
+    // The outer archive has been read by now, nested ones only check for cancellation
+    ProgressCallback nestedProgress;
+    if (progress) {
+        const qint64 total = containers.at(0).length;
+        nestedProgress = [progress, total](qint64, qint64) { return progress(total, total); };
+    }
+
+    const int last = entryList.size();
+    for (int i = first; i < last; ++i) {
+        const Entry entry = entryList.at(i);
+        DecompressingDevice::Compression compression;
+        const Format nestedFormat = formatForPath(entry.path, compression);
+        if (nestedFormat == NoArchive || (entry.encoding != methodStored && entry.encoding != methodDeflated)) {
+            continue;
+        }
+
+        const int containerCount = containers.size();
+        const int entryCount = entryList.size();
+        int nested = addContainer(container, entry.position, entry.compressedSize,
+                                  entry.encoding == methodDeflated ? DecompressingDevice::RawDeflate : DecompressingDevice::None, entry.size);
+        if (compression != DecompressingDevice::None) {
+            nested = addContainer(nested, 0, entry.size, compression, -1);
+        }
+        QSet<int> nestedExpanded;
+        QString nestedError;
+        if (list(nested, nestedFormat, entry.path + "/", depth + 1, nestedProgress, nestedExpanded, &nestedError)) {
+            expanded.insert(i);
+            expanded.unite(nestedExpanded);
+        } else if (nestedError.isEmpty()) {
+            if (errorString) *errorString = QString();
+            return false; // Cancelled
+        } else {
+            // Not readable as an archive after all; it stays a plain entry
+            containers.resize(containerCount);
+            entryList.resize(entryCount);
+        }
+    }
+    return true;
+}
+
+bool ArchiveSession::listKArchive(int container, Format format, const QString &prefix, QString *errorString) {
+    std::unique_ptr<QIODevice> device(openContainer(container));
+    if (!device) {
+        if (errorString) *errorString = QObject::tr("Unable to read the archive.");
+        return false;
+    }
+
+    std::unique_ptr<KArchive> archive;
+    if (format == Zip) {
+        archive.reset(new KZip(device.get()));
+    } else {
+        archive.reset(new K7Zip(device.get()));
+        containers[container].sevenZip = true;
+    }
+    if (!archive->open(QIODevice::ReadOnly)) {
+        if (errorString) {
+            *errorString = format == Zip ? QObject::tr("Failed to open ZIP file.") : QObject::tr("Failed to open 7z archive.");
+        }
+        return false;
+    }
+    collectEntries(archive->directory(), prefix, container, format == Zip, entryList);
+    archive->close();
+
+    // Nested ZIPs are read backwards from their central directory, which the checkpoints make cheap later on
+    if (DecompressingDevice *decompressing = qobject_cast<DecompressingDevice *>(device.get())) {
+        containers[container].checkpoints = decompressing->checkpoints();
+    }
+    return true;
+}
+
+bool ArchiveSession::listTar(int container, const QString &prefix, const ProgressCallback &progress, QString *errorString) {
+    std::unique_ptr<QIODevice> device(openContainer(container));
+    if (!device) {
+        if (errorString) *errorString = QObject::tr("Unable to read the archive.");
+        return false;
+    }
+    DecompressingDevice *decompressing = qobject_cast<DecompressingDevice *>(device.get());
+    const QString corrupt = QObject::tr("The TAR archive is corrupt.");
+
+    // KTar is not used: it decompresses compressed archives to a temporary file before reading them
+    char header[tarBlockSize];
+    qint64 position = 0;
+    qint64 reported = 0;
+    int zeroBlocks = 0;
+    QString longName;
+    QString paxPath;
+    qint64 paxSize = -1;
+    for (;;) {
+        if (!device->seek(position)) {
+            if (errorString) *errorString = corrupt;
+            return false;
+        }
+        const qint64 read = readFully(device.get(), header, tarBlockSize);
+        if (read < 0) {
+            if (errorString) *errorString = QObject::tr("Unable to read the archive: %1").arg(device->errorString());
+            return false;
+        }
+        if (read < tarBlockSize) {
+            break; // Some writers omit the end-of-archive blocks
+        }
+        position += tarBlockSize;
+
+        const qint64 inputPosition = decompressing ? decompressing->inputPosition() : position;
+        if (progress && inputPosition - reported >= progressInterval) {
+            reported = inputPosition;
+            if (!progress(inputPosition, containers.at(0).length)) {
+                if (errorString) *errorString = QString();
+                return false;
+            }
+        }
+
+        if (std::all_of(header, header + tarBlockSize, [](char byte) { return byte == '\0'; })) {
+            if (++zeroBlocks == 2) {
+                break;
+            }
+            continue;
+        }
+        zeroBlocks = 0;
+
+        const qint64 headerSize = tarNumber(header + 124, 12);
+        if (!tarChecksumMatches(header) || headerSize < 0) {
+            if (errorString) *errorString = corrupt;
+            return false;
+        }
+        const char type = header[156];
+        const qint64 dataStart = position;
+
+        if (type == 'L' || type == 'x') {
+            // GNU long name or pax extended header, applying to the next entry
+            if (headerSize > tarMaxExtendedHeader) {
+                if (errorString) *errorString = corrupt;
+                return false;
+            }
+            QByteArray data(headerSize, Qt::Uninitialized);
+            if (readFully(device.get(), data.data(), headerSize) != headerSize) {
+                if (errorString) *errorString = corrupt;
+                return false;
+            }
+            if (type == 'L') {
+                longName = QString::fromUtf8(data.constData(), static_cast<int>(qstrnlen(data.constData(), data.size())));
+            } else {
+                parsePaxHeader(data, paxPath, paxSize);
+            }
+            position = dataStart + (headerSize + tarBlockSize - 1) / tarBlockSize * tarBlockSize;
+            continue;
+        }
+
+        const qint64 size = paxSize >= 0 ? paxSize : headerSize;
+        const bool regular = type == '0' || type == '\0' || type == '7';
+        if (regular) {
+            QString name = paxPath;
+            if (name.isEmpty()) {
+                name = longName;
+            }
+            if (name.isEmpty()) {
+                name = tarString(header, 100);
+                if (std::memcmp(header + 257, "ustar", 5) == 0 && header[345] != '\0') {
+                    name = tarString(header + 345, 155) + "/" + name;
+                }
+            }
+            while (name.startsWith("./")) {
+                name.remove(0, 2);
+            }
+            if (!name.isEmpty() && !name.endsWith('/')) {
+                Entry entry;
+                entry.path = prefix + name;
+                entry.size = size;
+                entry.compressedSize = size;
+                entry.position = dataStart;
+                entry.container = container;
+                entryList.append(entry);
+            }
+        }
+        // Directories, links and the like carry no data worth listing; 'g' applies to the whole archive
+        longName.clear();
+        paxPath.clear();
+        paxSize = -1;
+        position = dataStart + (size + tarBlockSize - 1) / tarBlockSize * tarBlockSize;
+    }
+
+    if (decompressing) {
+        containers[container].checkpoints = decompressing->checkpoints();
+    }
+    if (progress && !progress(containers.at(0).length, containers.at(0).length)) {
+        if (errorString) *errorString = QString();
+        return false;
+    }
+    return true;
+}
+
+QIODevice *ArchiveSession::openRange(int parent, qint64 offset, qint64 length, DecompressingDevice::Compression compression,
+                                     qint64 size, const QVector<GzipCheckpoint> &checkpoints) const {
+    QIODevice *base = nullptr;
+    if (parent < 0) {
+        QFile *file = new QFile(path);
+        if (!file->open(QIODevice::ReadOnly)) {
+            delete file;
+            return nullptr;
+        }
+        base = file;
+    } else {
+        base = openContainer(parent);
+        if (!base) {
+            return nullptr;
+        }
+    }
+
+    RangeDevice *range = new RangeDevice(base, offset, length);
+    base->setParent(range);
+    range->open(QIODevice::ReadOnly);
+    if (compression == DecompressingDevice::None) {
+        return range;
+    }
+
+    DecompressingDevice *device = new DecompressingDevice(range, compression);
+    device->setCheckpoints(checkpoints);
+    if (size >= 0) {
+        device->setSize(size);
+    }
+    if (!device->open(QIODevice::ReadOnly)) {
+        delete device;
+        return nullptr;
+    }
+    return device;
+}
+
+QIODevice *ArchiveSession::openContainer(int container) const {
+    const Container &data = containers.at(container);
+    return openRange(data.parent, data.offset, data.length, data.compression, data.size, data.checkpoints);
+}
+
+bool ArchiveSession::diskOffset(int container, qint64 offset, qint64 &result) const {
+    for (int index = container; index >= 0; index = containers.at(index).parent) {
+        const Container &data = containers.at(index);
+        if (data.compression != DecompressingDevice::None || data.sevenZip) {
+            return false;
+        }
+        offset += data.offset;
+    }
+    result = offset;
+    return true;
+}
+
+QString ArchiveSession::archivePath() const {
+    return path;
+}
+
+bool ArchiveSession::isCurrent() const {
+    const QFileInfo fileInfo(path);
+    return fileInfo.size() == archiveSize && fileInfo.lastModified().toMSecsSinceEpoch() == modified;
+}
+
+const QVector<ArchiveSession::Entry> &ArchiveSession::entries() const {
+    return entryList;
+}
+
+const ArchiveSession::Entry *ArchiveSession::entry(const QString &entryPath) const {
+    auto it = entryIndex.constFind(entryPath);
+    return it == entryIndex.constEnd() ? nullptr : &entryList.at(it.value());
+}
+
+QString ArchiveSession::sourcePath(const QString &entryPath) const {
+    return path + "/" + entryPath;
+}
+
+QString ArchiveSession::displayName(const QString &entryPath) const {
+    const QString name = QFileInfo(entryPath).fileName();
+    return sharedNames.contains(name) ? entryPath : name;
+}
+
+void ArchiveSession::prepare(const QStringList &entryPaths) {
+    QMutexLocker locker(&spoolMutex);
+    for (const QString &entryPath : entryPaths) {
+        const Entry *found = entry(entryPath);
+        if (found && containers.at(found->container).sevenZip && !spooled.contains(entryPath)) {
+            requested.insert(entryPath);
+        }
+    }
+}
+
+QString ArchiveSession::spool(const Entry &entry, QString *errorString) const {
+    QMutexLocker locker(&spoolMutex);
+    auto it = spooled.constFind(entry.path);
+    if (it != spooled.constEnd()) {
+        return it.value();
+    }
+
+    if (!spoolDir) {
+        spoolDir.reset(new QTemporaryDir());
+    }
+    if (!spoolDir->isValid()) {
+        if (errorString) *errorString = QObject::tr("Unable to create temporary file for archive contents.");
+        return QString();
+    }
+
+    std::unique_ptr<QIODevice> device(openContainer(entry.container));
+    if (!device) {
+        if (errorString) *errorString = QObject::tr("Unable to read the archive.");
+        return QString();
+    }
+    K7Zip archive(device.get());
+    if (!archive.open(QIODevice::ReadOnly)) {
+        if (errorString) *errorString = QObject::tr("Failed to open 7z archive.");
+        return QString();
+    }
+
+    // The whole archive has been decoded now, so every requested entry of it is spooled at once
+    const Container &container = containers.at(entry.container);
+    QStringList wanted{entry.path};
+    for (const QString &entryPath : std::as_const(requested)) {
+        const Entry *other = this->entry(entryPath);
+        if (entryPath != entry.path && other && other->container == entry.container) {
+            wanted.append(entryPath);
+        }
+    }
+
+    QByteArray buffer(spoolChunkSize, Qt::Uninitialized);
+    for (const QString &entryPath : std::as_const(wanted)) {
+        requested.remove(entryPath);
+        const KArchiveEntry *archiveEntry = archive.directory()->entry(entryPath.mid(container.prefix.size()));
+        if (!archiveEntry || !archiveEntry->isFile()) {
+            continue;
+        }
+        std::unique_ptr<QIODevice> input(static_cast<const KArchiveFile *>(archiveEntry)->createDevice());
+        const QString spooledPath = spoolDir->filePath(QString::number(spooled.size()));
+        QFile output(spooledPath);
+        if (!input || (!input->isOpen() && !input->open(QIODevice::ReadOnly)) || !output.open(QIODevice::WriteOnly)) {
+            continue;
+        }
+        bool complete = true;
+        for (;;) {
+            const qint64 read = input->read(buffer.data(), spoolChunkSize);
+            if (read == 0) {
+                break;
+            }
+            if (read < 0 || output.write(buffer.constData(), read) != read) {
+                complete = false;
+                break;
+            }
+        }
+        output.close();
+        if (complete) {
+            spooled.insert(entryPath, spooledPath);
+        } else {
+            output.remove();
+        }
+    }
+    archive.close();
+
+    it = spooled.constFind(entry.path);
+    if (it == spooled.constEnd()) {
+        if (errorString) *errorString = QObject::tr("Unable to read the file from the 7z archive.");
+        return QString();
+    }
+    return it.value();
+}
+
+QSharedPointer<LogSource> ArchiveSession::createSource(const QString &entryPath, QString *errorString) const {
+    const Entry *found = entry(entryPath);
+    if (!found) {
+        if (errorString) *errorString = QObject::tr("The specified file does not exist within the archive.");
+        return QSharedPointer<LogSource>();
+    }
+    const Entry entry = *found;
+
+    if (containers.at(entry.container).sevenZip) {
+        const QString spooledPath = spool(entry, errorString);
+        if (spooledPath.isEmpty()) {
+            return QSharedPointer<LogSource>();
+        }
+        const DecompressingDevice::Compression spooledCompression = DecompressingDevice::compressionForPath(entryPath);
+        if (spooledCompression == DecompressingDevice::None) {
+            return QSharedPointer<LogSource>(new MappedLogSource(sourcePath(entryPath), spooledPath, 0, entry.size));
+        }
+
+        // A compressed file inside the 7z archive, such as app.log.gz, is decompressed from its spooled copy
+        CompressedLogSource::Input input;
+        input.open = [spooledPath]() -> QIODevice * {
+            return new QFile(spooledPath);
+        };
+        input.length = entry.size;
+        input.diskPath = spooledPath;
+        input.diskLength = entry.size;
+        return QSharedPointer<LogSource>(new CompressedLogSource(sourcePath(entryPath), input, spooledCompression));
+    }
+
+    if (entry.encoding != methodStored && entry.encoding != methodDeflated) {
+        if (errorString) {
+            *errorString = QObject::tr("Unsupported compression method %1 for %2 in the ZIP archive.").arg(entry.encoding).arg(entryPath);
+        }
+        return QSharedPointer<LogSource>();
+    }
+
+    const DecompressingDevice::Compression layer = entry.encoding == methodDeflated ? DecompressingDevice::RawDeflate
+                                                                                    : DecompressingDevice::None;
+    const DecompressingDevice::Compression fileCompression = DecompressingDevice::compressionForPath(entryPath);
+    qint64 offset = 0;
+    const bool onDisk = diskOffset(entry.container, entry.position, offset);
+    if (onDisk && layer == DecompressingDevice::None && fileCompression == DecompressingDevice::None) {
+        return QSharedPointer<LogSource>(new MappedLogSource(sourcePath(entryPath), path, offset, entry.size));
+    }
+
+    // A deflated entry that is a compressed file itself is decompressed twice; the outer
+    // layer then becomes the input of the source
+    CompressedLogSource::Input input;
+    QSharedPointer<const ArchiveSession> self = sharedFromThis();
+    const bool twoLayers = layer != DecompressingDevice::None && fileCompression != DecompressingDevice::None;
+    input.open = [self, entry, layer, twoLayers]() -> QIODevice * {
+        return twoLayers ? self->openRange(entry.container, entry.position, entry.compressedSize, layer, entry.size)
+                         : self->openRange(entry.container, entry.position, entry.compressedSize, DecompressingDevice::None, -1);
+    };
+    input.length = twoLayers ? entry.size : entry.compressedSize;
+    input.diskPath = path;
+    input.diskOffset = onDisk ? offset : 0;
+    input.diskLength = onDisk ? entry.compressedSize : archiveSize;
+
+    const DecompressingDevice::Compression compression = fileCompression != DecompressingDevice::None ? fileCompression : layer;
+    return QSharedPointer<LogSource>(new CompressedLogSource(sourcePath(entryPath), input, compression));
+}
+
+QIODevice *ArchiveSession::openEntry(const QString &entryPath, QString *errorString) const {
+    const Entry *found = entry(entryPath);
+    if (!found) {
+        if (errorString) *errorString = QObject::tr("The specified file does not exist within the archive.");
+        return nullptr;
+    }
+
+    QIODevice *device = nullptr;
+    if (containers.at(found->container).sevenZip) {
+        const QString spooledPath = spool(*found, errorString);
+        if (spooledPath.isEmpty()) {
+            return nullptr;
+        }
+        device = new QFile(spooledPath);
+        if (!device->open(QIODevice::ReadOnly)) {
+            if (errorString) *errorString = device->errorString();
+            delete device;
+            return nullptr;
+        }
+    } else if (found->encoding == methodStored || found->encoding == methodDeflated) {
+        device = openRange(found->container, found->position, found->compressedSize,
+                           found->encoding == methodDeflated ? DecompressingDevice::RawDeflate : DecompressingDevice::None, found->size);
+        if (!device) {
+            if (errorString) *errorString = QObject::tr("Unable to read the archive.");
+            return nullptr;
+        }
+    } else {
+        if (errorString) {
+            *errorString = QObject::tr("Unsupported compression method %1 for %2 in the ZIP archive.").arg(found->encoding).arg(entryPath);
+        }
+        return nullptr;
+    }
+
+    const DecompressingDevice::Compression fileCompression = DecompressingDevice::compressionForPath(entryPath);
+    if (fileCompression == DecompressingDevice::None) {
+        return device;
+    }
+    DecompressingDevice *text = new DecompressingDevice(device, fileCompression);
+    if (!text->open(QIODevice::ReadOnly)) {
+        if (errorString) *errorString = text->errorString();
+        delete text;
+        return nullptr;
+    }
+    return text;
+}
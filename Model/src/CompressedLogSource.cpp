@@ -0,0 +1,327 @@
+#include "CompressedLogSource.h"
+#include <QObject>
+#include <QFile>
+#include <QFileInfo>
+#include <QDateTime>
+#include <QMutexLocker>
+#include <QReadLocker>
+#include <QWriteLocker>
+#include <cstring>
+#include "LineScanner.h"
+#include "IndexCache.h"
+
+namespace {
+const qint64 readChunkSize = 4 * 1024 * 1024; // Decompressed bytes indexed between two progress reports
+const qint64 firstReadSize = 256 * 1024;      // Decompressed bytes indexed before the first report, enough for the first screens
+const qint64 blockSize = 1024 * 1024;         // Granularity of reads for readRange()
+const int cachedBlockCount = 16;              // Decompressed blocks kept for readRange()
+
+// Reads until length bytes are read or the device is exhausted; returns -1 on errors
+qint64 readFully(QIODevice *device, char *buffer, qint64 length) {
+    qint64 total = 0;
+    while (total < length) {
+        qint64 read = device->read(buffer + total, length - total);
+        if (read < 0) {
+            return -1;
+        }
+        if (read == 0) {
+            break;
+        }
+        total += read;
+    }
+    return total;
+}
+}
+
+bool CompressedLogSource::isCompressed(const QString &filePath) {
+    return DecompressingDevice::compressionForPath(filePath) != DecompressingDevice::None;
+}
+
+CompressedLogSource::CompressedLogSource(const QString &filePath)
+    : LogSource(filePath), compression(DecompressingDevice::compressionForPath(filePath)), wholeFile(true),
+      blocks(cachedBlockCount) {
+    input.open = [filePath]() -> QIODevice * {
+        return new QFile(filePath);
+    };
+    input.diskPath = filePath;
+}
+
+CompressedLogSource::CompressedLogSource(const QString &filePath, const Input &input, DecompressingDevice::Compression compression)
+    : LogSource(filePath), input(input), compression(compression), blocks(cachedBlockCount) {}
+
+CompressedLogSource::~CompressedLogSource() {}
+
+bool CompressedLogSource::open() {
+    if (wholeFile && compression == DecompressingDevice::None) {
+        error = QObject::tr("Unsupported compression format.");
+        return false;
+    }
+
+    QFileInfo fileInfo(input.diskPath);
+    if (!fileInfo.isFile()) {
+        error = QObject::tr("Unable to open file.");
+        return false;
+    }
+    if (wholeFile) {
+        input.length = fileInfo.size();
+        input.diskLength = input.length;
+    }
+    modified = fileInfo.lastModified().toMSecsSinceEpoch();
+
+    return openText(&error) != nullptr;
+}
+
+bool CompressedLogSource::buildIndex(const ProgressCallback &progress) {
+    restoredFromCache = false;
+    if (restoreFromCache()) {
+        if (progress) {
+            progress(input.length, size(), lineCount());
+        }
+        return true;
+    }
+
+    // Logs typically compress by a factor of 5 to 20
+    clearIndex(compression == DecompressingDevice::None ? input.length : input.length * 8);
+    {
+        QWriteLocker locker(&lock);
+        dataSize = 0;
+        checkpoints.clear();
+        inputRead = 0;
+    }
+    std::unique_ptr<DecompressingDevice> device = openText(&error);
+    if (!device) {
+        return false;
+    }
+
+    // The buffer starts with the last bytes of the previous chunk, so that the timestamp of a
+    // line starting near the end of a chunk can be parsed once the next chunk has been read
+    const qint64 lookahead = TimestampParser::maxLength;
+    QByteArray buffer(readChunkSize + lookahead, Qt::Uninitialized);
+    qint64 carry = 0;
+    qint64 bufferBase = 0;  // Decompressed offset of buffer[0]
+
+    LineScanner scanner;
+    QVector<quint64> pending(1, 0);  // Line starts whose timestamp was not parsed yet
+    QVector<quint64> chunkOffsets;
+    QVector<qint64> chunkTimestamps;
+
+    // A small first chunk gets the file on screen before the bulk of it is inflated
+    qint64 chunkSize = firstReadSize;
+    for (;;) {
+        const qint64 read = readFully(device.get(), buffer.data() + carry, chunkSize);
+        chunkSize = readChunkSize;
+        if (read < 0) {
+            error = QObject::tr("Unable to decompress file: %1").arg(device->errorString());
+            return false;
+        }
+
+        const bool atEnd = read == 0;
+        const qint64 end = bufferBase + carry + read;
+        if (atEnd) {
+            scanner.finish();
+            if (!pending.isEmpty() && static_cast<qint64>(pending.last()) == end) {
+                pending.removeLast(); // A trailing newline does not start another line
+            }
+        } else {
+            scanner.scanBuffer(buffer.constData() + carry, read, pending);
+        }
+
+        chunkOffsets.clear();
+        chunkTimestamps.clear();
+        int ready = 0;
+        for (; ready < pending.size(); ++ready) {
+            const qint64 offset = static_cast<qint64>(pending.at(ready));
+            const qint64 available = end - offset;
+            if (!atEnd && available < lookahead) {
+                break;
+            }
+            chunkOffsets.append(pending.at(ready));
+            chunkTimestamps.append(TimestampParser::parse(buffer.constData() + (offset - bufferBase), qMin(available, lookahead)));
+        }
+        pending.remove(0, ready);
+
+        {
+            QWriteLocker locker(&lock);
+            dataSize = end;
+            checkpoints = device->checkpoints();
+            inputRead = device->inputPosition();
+        }
+        qint64 lines = appendChunk(chunkOffsets, chunkTimestamps, scanner.longestLine(), atEnd);
+
+        if (progress && !progress(device->inputPosition(), end, lines)) {
+            return false;
+        }
+        if (atEnd) {
+            saveToCache();
+            return true;
+        }
+
+        const qint64 valid = carry + read;
+        carry = qMin(lookahead, valid);
+        std::memmove(buffer.data(), buffer.constData() + valid - carry, static_cast<size_t>(carry));
+        bufferBase = end - carry;
+    }
+}
+
+qint64 CompressedLogSource::expectedSize() const {
+    if (indexComplete || inputRead <= 0) {
+        return dataSize;
+    }
+    return static_cast<qint64>(static_cast<double>(dataSize) * input.length / inputRead);
+}
+
+qint64 CompressedLogSource::inputSize() const {
+    return input.length;
+}
+
+std::unique_ptr<DecompressingDevice> CompressedLogSource::openText(QString *errorString) const {
+    QIODevice *device = input.open ? input.open() : nullptr;
+    if (!device) {
+        if (errorString) *errorString = QObject::tr("Unable to read the compressed data.");
+        return nullptr;
+    }
+
+    std::unique_ptr<DecompressingDevice> text(new DecompressingDevice(device, compression));
+    {
+        QReadLocker locker(&lock);
+        text->setCheckpoints(checkpoints);
+    }
+    if (!text->open(QIODevice::ReadOnly)) {
+        if (errorString) *errorString = text->errorString();
+        return nullptr;
+    }
+    return text;
+}
+
+QByteArray CompressedLogSource::readRange(qint64 offset, qint64 length, BytesLease *lease) const {
+    Q_UNUSED(lease); // Copies need no lease
+    if (length <= 0) {
+        return QByteArray();
+    }
+
+    QMutexLocker locker(&readMutex);
+    const qint64 firstBlock = offset / blockSize;
+    const qint64 lastBlock = (offset + length - 1) / blockSize;
+    QByteArray bytes;
+    bytes.reserve(length);
+    for (qint64 index = firstBlock; index <= lastBlock; ++index) {
+        const QByteArray *data = block(index);
+        if (!data) {
+            return QByteArray();
+        }
+        const qint64 blockStart = index * blockSize;
+        const qint64 from = qMax(offset, blockStart) - blockStart;
+        const qint64 to = qMin<qint64>(qMin(offset + length, blockStart + blockSize) - blockStart, data->size());
+        if (to > from) {
+            bytes.append(data->constData() + from, to - from);
+        }
+    }
+    return bytes;
+}
+
+const QByteArray *CompressedLogSource::block(qint64 index) const {
+    if (const QByteArray *cached = blocks.object(index)) {
+        return cached;
+    }
+
+    if (!reader) {
+        reader = openText(nullptr);
+    } else {
+        QReadLocker locker(&lock);
+        if (checkpoints.size() > reader->checkpoints().size()) {
+            reader->setCheckpoints(checkpoints); // Indexing got further since the reader was opened
+        }
+    }
+
+    // Start at the nearest checkpoint, or where the reader is if that is closer
+    const qint64 blockStart = index * blockSize;
+    qint64 readerPosition = reader ? reader->restartBefore(blockStart) : -1;
+    if (readerPosition < 0) {
+        reader.reset();
+        return nullptr;
+    }
+
+    // Read up to the requested block, keeping whole blocks passed on the way that are close
+    // enough to it to be scrolled to next
+    for (;;) {
+        const qint64 current = readerPosition / blockSize;
+        const qint64 currentStart = current * blockSize;
+        const qint64 wanted = currentStart + blockSize - readerPosition;
+        QByteArray *data = new QByteArray(wanted, Qt::Uninitialized);
+        const qint64 read = readFully(reader.get(), data->data(), wanted);
+        if (read <= 0) {
+            delete data;
+            reader.reset();
+            return nullptr;
+        }
+        data->resize(read);
+        const bool wholeBlock = readerPosition == currentStart;
+        readerPosition += read;
+
+        if (current == index && wholeBlock) {
+            blocks.insert(current, data);
+            return data;
+        }
+        if (wholeBlock && current < index && index - current < cachedBlockCount / 2) {
+            blocks.insert(current, data);
+        } else {
+            delete data;
+        }
+    }
+}
+
+bool CompressedLogSource::restoreFromCache() {
+    if (input.length < IndexCache::minimumFileSize) {
+        return false;
+    }
+
+    IndexCache::Entry entry;
+    if (!IndexCache::load(filePath(), entry)
+        || static_cast<qint64>(entry.fileSize) != input.diskLength || entry.modified != modified) {
+        return false;
+    }
+
+    // A compressed file cannot be extended in place like a plain log, so only an exact match counts
+    quint64 headHash = 0;
+    quint64 tailHash = 0;
+    if (!IndexCache::hashFile(input.diskPath, input.diskOffset, input.diskLength, headHash, tailHash)
+        || headHash != entry.headHash || tailHash != entry.tailHash) {
+        return false;
+    }
+
+    QWriteLocker locker(&lock);
+    dataSize = static_cast<qint64>(entry.textSize);
+    lineOffsets = std::move(entry.lineOffsets);
+    timestamps = std::move(entry.timestamps);
+    updateTimeLookup(0);
+    checkpoints = std::move(entry.checkpoints);
+    longest = entry.longestLine;
+    sorted = entry.timestampsSorted;
+    indexComplete = true;
+    restoredFromCache = true;
+    return true;
+}
+
+void CompressedLogSource::saveToCache() const {
+    if (input.length < IndexCache::minimumFileSize) {
+        return;
+    }
+
+    IndexCache::Entry entry;
+    entry.filePath = filePath();
+    entry.fileSize = static_cast<quint64>(input.diskLength);
+    entry.modified = modified;
+    if (!IndexCache::hashFile(input.diskPath, input.diskOffset, input.diskLength, entry.headHash, entry.tailHash)) {
+        return;
+    }
+    {
+        QReadLocker locker(&lock);
+        entry.textSize = static_cast<quint64>(dataSize);
+        entry.longestLine = longest;
+        entry.timestampsSorted = sorted;
+        entry.lineOffsets = lineOffsets; // Implicitly shared, no copy
+        entry.timestamps = timestamps;
+        entry.checkpoints = checkpoints;
+    }
+    IndexCache::save(entry);
+}
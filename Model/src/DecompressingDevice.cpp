@@ -0,0 +1,214 @@
+#include "DecompressingDevice.h"
+#include <QFileInfo>
+#include <KCompressionDevice>
+#include <algorithm>
+
+namespace {
+const qint64 skipBufferSize = 256 * 1024; // Decompressed bytes discarded at a time when seeking forward
+}
+
+DecompressingDevice::Compression DecompressingDevice::compressionForPath(const QString &filePath) {
+    const QString suffix = QFileInfo(filePath).suffix().toLower();
+    if (suffix == "gz" || suffix == "tgz") {
+        return Gzip;
+    }
+    if (suffix == "bz2" || suffix == "tbz2" || suffix == "tbz") {
+        return BZip2;
+    }
+    if (suffix == "xz" || suffix == "txz") {
+        return Xz;
+    }
+    if (suffix == "zst" || suffix == "tzst") {
+        return Zstd;
+    }
+    return None;
+}
+
+DecompressingDevice::DecompressingDevice(QIODevice *input, Compression compression, QObject *parent)
+    : QIODevice(parent), input(input), compression(compression) {
+    input->setParent(this);
+}
+
+DecompressingDevice::~DecompressingDevice() {
+    decompressor.reset(); // Before the input, which is deleted with the children
+}
+
+bool DecompressingDevice::open(OpenMode mode) {
+    if ((mode & ReadWrite) != ReadOnly) {
+        setErrorString(tr("DecompressingDevice is read-only."));
+        return false;
+    }
+    if (!input->isOpen() && !input->open(QIODevice::ReadOnly)) {
+        setErrorString(input->errorString());
+        return false;
+    }
+    if (compression != None && !startOver()) {
+        return false;
+    }
+    return QIODevice::open(mode | Unbuffered);
+}
+
+bool DecompressingDevice::isSequential() const {
+    return false;
+}
+
+qint64 DecompressingDevice::size() const {
+    if (compression == None) {
+        return input->size();
+    }
+    return knownSize >= 0 ? knownSize : furthest;
+}
+
+void DecompressingDevice::setSize(qint64 size) {
+    knownSize = size;
+}
+
+void DecompressingDevice::setCheckpoints(const QVector<GzipCheckpoint> &checkpoints) {
+    points = checkpoints;
+}
+
+QVector<GzipCheckpoint> DecompressingDevice::checkpoints() const {
+    return points;
+}
+
+qint64 DecompressingDevice::inputPosition() const {
+    return compression == None ? pos() : input->pos();
+}
+
+qint64 DecompressingDevice::restartBefore(qint64 target) {
+    const qint64 position = reposition(target);
+    if (position < 0 || !QIODevice::seek(position)) {
+        return -1;
+    }
+    return position;
+}
+
+bool DecompressingDevice::startOver() {
+    decompressor.reset();
+    streamPosition = 0;
+    if (!input->seek(0)) {
+        setErrorString(input->errorString());
+        return false;
+    }
+
+    if (compression == Gzip || compression == RawDeflate) {
+        GzipDevice *gzip = new GzipDevice(input, compression == Gzip ? GzipDevice::Gzip : GzipDevice::RawDeflate);
+        gzip->setRecordCheckpoints(true);
+        decompressor.reset(gzip);
+    } else {
+        KCompressionDevice::CompressionType type = KCompressionDevice::BZip2;
+        if (compression == Xz) {
+            type = KCompressionDevice::Xz;
+        } else if (compression == Zstd) {
+            type = KCompressionDevice::Zstd;
+        }
+        decompressor.reset(new KCompressionDevice(input, false, type));
+    }
+
+    if (!decompressor->open(QIODevice::ReadOnly)) {
+        setErrorString(tr("Unable to decompress data; the format is not supported by this build."));
+        decompressor.reset();
+        return false;
+    }
+    return true;
+}
+
+qint64 DecompressingDevice::reposition(qint64 target) {
+    if (compression == None) {
+        return target;
+    }
+
+    auto it = std::upper_bound(points.cbegin(), points.cend(), static_cast<quint64>(target),
+                               [](quint64 value, const GzipCheckpoint &point) { return value < point.output; });
+    const GzipCheckpoint *checkpoint = it != points.cbegin() ? &*(it - 1) : nullptr;
+
+    const bool readOn = decompressor && streamPosition <= target
+                        && (!checkpoint || static_cast<qint64>(checkpoint->output) <= streamPosition);
+    if (readOn) {
+        return streamPosition; // Reading on is at least as cheap as jumping
+    }
+
+    // Inflating only goes forward; without a checkpoint going back means starting over
+    if (!checkpoint) {
+        return startOver() ? 0 : -1;
+    }
+    if (!decompressor && !startOver()) {
+        return -1; // restartAt() needs an open GzipDevice
+    }
+    GzipDevice *gzip = qobject_cast<GzipDevice *>(decompressor.get());
+    if (!gzip || !gzip->restartAt(*checkpoint)) {
+        setErrorString(tr("Unable to resume decompressing at a checkpoint."));
+        decompressor.reset();
+        return -1;
+    }
+    streamPosition = static_cast<qint64>(checkpoint->output);
+    return streamPosition;
+}
+
+void DecompressingDevice::collectCheckpoints() {
+    GzipDevice *gzip = qobject_cast<GzipDevice *>(decompressor.get());
+    if (!gzip) {
+        return;
+    }
+    const QVector<GzipCheckpoint> recorded = gzip->takeCheckpoints();
+    for (const GzipCheckpoint &checkpoint : recorded) {
+        if (points.isEmpty() || checkpoint.output > points.last().output) {
+            points.append(checkpoint); // Passing a region again records the same checkpoints again
+        }
+    }
+}
+
+qint64 DecompressingDevice::readData(char *data, qint64 maxSize) {
+    const qint64 target = pos();
+    if (compression == None) {
+        if (!input->seek(target)) {
+            setErrorString(input->errorString());
+            return -1;
+        }
+        const qint64 read = input->read(data, maxSize);
+        if (read < 0) {
+            setErrorString(input->errorString());
+        }
+        return read;
+    }
+
+    if (!decompressor || streamPosition != target) {
+        if (reposition(target) < 0) {
+            return -1;
+        }
+        QByteArray skipped(skipBufferSize, Qt::Uninitialized);
+        while (streamPosition < target) {
+            const qint64 read = decompressor->read(skipped.data(), qMin(skipBufferSize, target - streamPosition));
+            if (read < 0) {
+                setErrorString(decompressor->errorString());
+                return -1;
+            }
+            if (read == 0) {
+                knownSize = streamPosition;
+                return 0; // Seeked past the end
+            }
+            streamPosition += read;
+            furthest = qMax(furthest, streamPosition);
+            collectCheckpoints();
+        }
+    }
+
+    const qint64 read = decompressor->read(data, maxSize);
+    if (read < 0) {
+        setErrorString(decompressor->errorString());
+        return -1;
+    }
+    streamPosition += read;
+    furthest = qMax(furthest, streamPosition);
+    if (read == 0) {
+        knownSize = streamPosition;
+    }
+    collectCheckpoints();
+    return read;
+}
+
+qint64 DecompressingDevice::writeData(const char *data, qint64 maxSize) {
+    Q_UNUSED(data);
+    Q_UNUSED(maxSize);
+    return -1;
+}
@@ -0,0 +1,121 @@
+#include "FindResultsModel.h"
+#include <QFileInfo>
+#include <algorithm>
+#include <numeric>
+
+FindResultsModel::FindResultsModel(QObject *parent)
+    : QAbstractListModel(parent) {}
+
+void FindResultsModel::setResults(const QSharedPointer<LogSource> &source, const QString &filePath, const QVector<LogSearch::Hit> &hits) {
+    QVector<File> single;
+    if (source) {
+        single.append(File{filePath, source, hits});
+    }
+    setFiles(single, ByFileAndLine, false);
+}
+
+void FindResultsModel::setResults(const QVector<File> &files, Order order) {
+    setFiles(files, order, true);
+}
+
+void FindResultsModel::setFiles(const QVector<File> &files, Order order, bool crossFile) {
+    beginResetModel();
+    this->files.clear();
+    rows.clear();
+    this->crossFile = crossFile;
+
+    QVector<qint64> rowTimestamps;
+    for (const File &file : files) {
+        if (file.hits.isEmpty() || !file.source) continue;
+        const qint32 fileIndex = this->files.size();
+        this->files.append(file);
+
+        qint64 timestamp = TimestampParser::NoTimestamp;
+        for (qint32 i = 0; i < file.hits.size(); ++i) {
+            if (i > 0 && file.hits.at(i).line == file.hits.at(i - 1).line) continue; // A line is shown once however often it matches
+            rows.append(Row{fileIndex, i});
+            if (order == ByTimestamp) {
+                const qint64 lineTimestamp = file.source->timestamp(file.hits.at(i).line);
+                if (lineTimestamp != TimestampParser::NoTimestamp) {
+                    timestamp = lineTimestamp; // Continuation lines stay after the line they continue
+                }
+                rowTimestamps.append(timestamp);
+            }
+        }
+    }
+
+    if (order == ByTimestamp) {
+        QVector<qint32> permutation(rows.size());
+        std::iota(permutation.begin(), permutation.end(), 0);
+        std::stable_sort(permutation.begin(), permutation.end(), [&rowTimestamps](qint32 a, qint32 b) {
+            return rowTimestamps.at(a) < rowTimestamps.at(b);
+        });
+        QVector<Row> sorted;
+        sorted.reserve(rows.size());
+        for (qint32 row : std::as_const(permutation)) {
+            sorted.append(rows.at(row));
+        }
+        rows = sorted;
+    }
+    endResetModel();
+}
+
+void FindResultsModel::clear() {
+    setResults(QSharedPointer<LogSource>(), QString(), QVector<LogSearch::Hit>());
+}
+
+QString FindResultsModel::filePath() const {
+    return crossFile || files.isEmpty() ? QString() : files.first().filePath;
+}
+
+bool FindResultsModel::isCrossFile() const {
+    return crossFile;
+}
+
+QVector<LogSearch::Hit> FindResultsModel::hits() const {
+    return crossFile || files.isEmpty() ? QVector<LogSearch::Hit>() : files.first().hits;
+}
+
+int FindResultsModel::rowCount(const QModelIndex &parent) const {
+    return parent.isValid() ? 0 : rows.size();
+}
+
+QVariant FindResultsModel::data(const QModelIndex &index, int role) const {
+    if (!index.isValid() || index.row() >= rows.size()) {
+        return QVariant();
+    }
+    const Row &row = rows.at(index.row());
+    const File &file = files.at(row.file);
+    const LogSearch::Hit &hit = file.hits.at(row.firstHit);
+
+    switch (role) {
+    case Qt::DisplayRole: {
+        const QByteArray bytes = file.source->lineBytes(hit.line);
+        const QString text = QString::fromUtf8(bytes.constData(), qMin<qint64>(bytes.size(), maxDisplayBytes));
+        return crossFile ? QStringLiteral("%1:%2: %3").arg(QFileInfo(file.filePath).fileName(), QString::number(hit.line + 1), text) : text;
+    }
+    case Qt::ToolTipRole: {
+        const QString lineInfo = tr("Line %1, %n match(es)", nullptr, hitCount(row)).arg(hit.line + 1);
+        return crossFile ? file.filePath + QLatin1Char('\n') + lineInfo : lineInfo;
+    }
+    case LineRole:
+        return hit.line;
+    case ColumnRole:
+        return hit.column;
+    case LengthRole:
+        return hit.length;
+    case FilePathRole:
+        return file.filePath;
+    default:
+        return QVariant();
+    }
+}
+
+qint32 FindResultsModel::hitCount(const Row &row) const {
+    const QVector<LogSearch::Hit> &hits = files.at(row.file).hits;
+    qint32 end = row.firstHit + 1;
+    while (end < hits.size() && hits.at(end).line == hits.at(row.firstHit).line) {
+        ++end;
+    }
+    return end - row.firstHit;
+}
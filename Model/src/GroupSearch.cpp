@@ -0,0 +1,78 @@
+#include "GroupSearch.h"
+
+GroupSearch::GroupSearch(QObject *parent)
+    : QObject(parent) {}
+
+GroupSearch::~GroupSearch() {
+    running = false;
+    for (LogSearch *search : std::as_const(searches)) {
+        search->cancel();
+    }
+    pool.clear();
+    pool.waitForDone(); // Before the searches, which the tasks report to, are deleted with the children
+}
+
+void GroupSearch::start(const QVector<Target> &targets, const LineMatcher &matcher, qint64 maxHitsPerFile) {
+    cancel();
+
+    fileResults.clear();
+    for (const Target &target : targets) {
+        fileResults.append(FileResult{target.filePath, target.source, QVector<LogSearch::Hit>(), false});
+    }
+    filesDone = 0;
+    hitsFound = 0;
+    if (targets.isEmpty()) {
+        emit finished(false);
+        return;
+    }
+
+    while (searches.size() < targets.size()) {
+        LogSearch *search = new LogSearch(&pool, this);
+        const int file = searches.size();
+        connect(search, &LogSearch::finished, this, [this, file](bool cancelled) { onFileSearched(file, cancelled); });
+        searches.append(search);
+    }
+
+    // All files are counted as pending before the first one is started, as empty ones finish at once
+    running = true;
+    for (int file = 0; file < targets.size() && running; ++file) {
+        searches.at(file)->start(targets.at(file).source, matcher, maxHitsPerFile);
+    }
+}
+
+void GroupSearch::cancel() {
+    if (!running) {
+        return;
+    }
+    running = false; // Before the searches report their cancellation, which is not a result
+    for (LogSearch *search : std::as_const(searches)) {
+        search->cancel();
+    }
+    pool.clear();
+    emit finished(true);
+}
+
+bool GroupSearch::isRunning() const {
+    return running;
+}
+
+const QVector<GroupSearch::FileResult> &GroupSearch::results() const {
+    return fileResults;
+}
+
+void GroupSearch::onFileSearched(int file, bool cancelled) {
+    if (!running || cancelled || file >= fileResults.size()) {
+        return;
+    }
+    FileResult &result = fileResults[file];
+    result.hits = searches.at(file)->hits();
+    result.truncated = searches.at(file)->isTruncated();
+    ++filesDone;
+    hitsFound += result.hits.size();
+    emit fileSearched(result.filePath, result.hits.size());
+    emit progress(filesDone, fileResults.size(), hitsFound);
+    if (filesDone == fileResults.size()) {
+        running = false;
+        emit finished(false);
+    }
+}
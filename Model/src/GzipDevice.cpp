@@ -0,0 +1,202 @@
+#include "GzipDevice.h"
+#include <zlib.h>
+
+namespace {
+const int inputBufferSize = 256 * 1024;
+const int windowSize = 32768;       // Maximum distance a deflate block can refer back to
+const int gzipWindowBits = 15 + 16; // Expect a gzip header and trailer
+const int rawWindowBits = -15;      // Plain deflate data, as in ZIP entries and after restarting at a checkpoint
+const int gzipTrailerSize = 8;      // CRC-32 and size that follow the deflate data of a member
+}
+
+GzipDevice::GzipDevice(QIODevice *input, Format format, QObject *parent)
+    : QIODevice(parent), input(input), format(format), stream(new z_stream), inputBuffer(inputBufferSize, Qt::Uninitialized) {
+    stream->zalloc = Z_NULL;
+    stream->zfree = Z_NULL;
+    stream->opaque = Z_NULL;
+    stream->next_in = Z_NULL;
+    stream->avail_in = 0;
+    inflateInit2(stream.get(), gzipWindowBits);
+}
+
+GzipDevice::~GzipDevice() {
+    inflateEnd(stream.get());
+}
+
+bool GzipDevice::open(OpenMode mode) {
+    if ((mode & ReadWrite) != ReadOnly) {
+        setErrorString(tr("GzipDevice is read-only."));
+        return false;
+    }
+    if (!input->isOpen() && !input->open(QIODevice::ReadOnly)) {
+        setErrorString(input->errorString());
+        return false;
+    }
+    if (!input->seek(0) || inflateReset2(stream.get(), format == RawDeflate ? rawWindowBits : gzipWindowBits) != Z_OK) {
+        setErrorString(tr("Unable to rewind compressed data."));
+        return false;
+    }
+
+    stream->avail_in = 0;
+    inputEnd = 0;
+    output = 0;
+    lastCheckpoint = 0;
+    raw = format == RawDeflate;
+    memberEnded = false;
+    trailerToSkip = 0;
+    finished = false;
+    // Unbuffered: QIODevice's own buffer would survive restartAt() with stale bytes
+    return QIODevice::open(mode | Unbuffered);
+}
+
+void GzipDevice::close() {
+    QIODevice::close();
+}
+
+bool GzipDevice::isSequential() const {
+    return true;
+}
+
+void GzipDevice::setRecordCheckpoints(bool enabled) {
+    recordCheckpoints = enabled;
+}
+
+QVector<GzipCheckpoint> GzipDevice::takeCheckpoints() {
+    QVector<GzipCheckpoint> checkpoints;
+    checkpoints.swap(recorded);
+    return checkpoints;
+}
+
+bool GzipDevice::restartAt(const GzipCheckpoint &checkpoint) {
+    const qint64 position = static_cast<qint64>(checkpoint.input) - (checkpoint.bits ? 1 : 0);
+    if (!isOpen() || !input->seek(position) || inflateReset2(stream.get(), rawWindowBits) != Z_OK) {
+        return false;
+    }
+
+    stream->avail_in = 0;
+    inputEnd = position;
+    if (checkpoint.bits) {
+        // The block starts in the middle of this byte; feed zlib its remaining high bits
+        char partial;
+        if (input->read(&partial, 1) != 1) {
+            return false;
+        }
+        ++inputEnd;
+        inflatePrime(stream.get(), checkpoint.bits, static_cast<uchar>(partial) >> (8 - checkpoint.bits));
+    }
+    inflateSetDictionary(stream.get(), reinterpret_cast<const Bytef *>(checkpoint.window.constData()),
+                         static_cast<uInt>(checkpoint.window.size()));
+
+    output = static_cast<qint64>(checkpoint.output);
+    lastCheckpoint = output;
+    raw = true;
+    memberEnded = false;
+    trailerToSkip = 0;
+    finished = false;
+    return true;
+}
+
+qint64 GzipDevice::outputPosition() const {
+    return output;
+}
+
+qint64 GzipDevice::readData(char *data, qint64 maxSize) {
+    if (finished) {
+        return 0;
+    }
+
+    z_stream *zs = stream.get();
+    zs->next_out = reinterpret_cast<Bytef *>(data);
+    zs->avail_out = static_cast<uInt>(qMin<qint64>(maxSize, 1 << 30));
+
+    while (zs->avail_out > 0) {
+        bool inputExhausted = false;
+        if (zs->avail_in == 0) {
+            const qint64 read = input->read(inputBuffer.data(), inputBuffer.size());
+            if (read < 0) {
+                setErrorString(input->errorString());
+                return -1;
+            }
+            inputExhausted = read == 0;
+            inputEnd += read;
+            zs->next_in = reinterpret_cast<Bytef *>(inputBuffer.data());
+            zs->avail_in = static_cast<uInt>(read);
+        }
+
+        if (inputExhausted && (memberEnded || trailerToSkip > 0)) {
+            finished = true;
+            break;
+        }
+
+        if (trailerToSkip > 0) {
+            const uInt skipped = static_cast<uInt>(qMin<qint64>(trailerToSkip, zs->avail_in));
+            zs->next_in += skipped;
+            zs->avail_in -= skipped;
+            trailerToSkip -= skipped;
+            continue;
+        }
+
+        if (memberEnded) {
+            // More input after the end of a member: another member follows
+            if (inflateReset2(zs, gzipWindowBits) != Z_OK) {
+                setErrorString(tr("Unable to decompress the next gzip member."));
+                return -1;
+            }
+            raw = false;
+        }
+
+        // Even without new input zlib may still have to finish the last block it has seen
+        const uInt before = zs->avail_out;
+        int result = inflate(zs, Z_BLOCK);
+        output += before - zs->avail_out;
+        if (inputExhausted && result == Z_BUF_ERROR) {
+            setErrorString(tr("Compressed data ends unexpectedly."));
+            return -1;
+        }
+
+        if (result == Z_NEED_DICT || result == Z_DATA_ERROR || result == Z_STREAM_ERROR || result == Z_MEM_ERROR) {
+            if (memberEnded) {
+                finished = true; // Trailing garbage, such as zero padding, after the last member
+                break;
+            }
+            setErrorString(tr("Corrupt compressed data: %1").arg(QString::fromUtf8(zs->msg ? zs->msg : "")));
+            return -1;
+        }
+        memberEnded = false;
+
+        if (result == Z_STREAM_END) {
+            if (format == RawDeflate) {
+                finished = true; // Whatever follows the deflate stream belongs to someone else
+                break;
+            }
+            memberEnded = true;
+            if (raw) {
+                trailerToSkip = gzipTrailerSize; // Raw inflate stops before the trailer gzip mode would consume
+            }
+            continue;
+        }
+
+        // Bit 128: stopped at a block boundary (or after the header); bit 64: in the last block
+        const bool atBoundary = (zs->data_type & 128) && !(zs->data_type & 64);
+        if (recordCheckpoints && atBoundary && (output == 0 || output - lastCheckpoint >= checkpointSpan)) {
+            GzipCheckpoint checkpoint;
+            checkpoint.input = static_cast<quint64>(inputEnd - zs->avail_in);
+            checkpoint.output = static_cast<quint64>(output);
+            checkpoint.bits = zs->data_type & 7;
+            checkpoint.window.resize(windowSize);
+            uInt length = windowSize;
+            inflateGetDictionary(zs, reinterpret_cast<Bytef *>(checkpoint.window.data()), &length);
+            checkpoint.window.resize(length);
+            recorded.append(checkpoint);
+            lastCheckpoint = output;
+        }
+    }
+
+    return static_cast<qint64>(zs->next_out - reinterpret_cast<Bytef *>(data));
+}
+
+qint64 GzipDevice::writeData(const char *data, qint64 maxSize) {
+    Q_UNUSED(data);
+    Q_UNUSED(maxSize);
+    return -1;
+}
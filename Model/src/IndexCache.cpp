@@ -0,0 +1,225 @@
+#include "IndexCache.h"
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QSaveFile>
+#include <QStandardPaths>
+
+namespace {
+const quint32 cacheMagic = 0x4C5A4958; // "LZIX"
+const quint32 cacheVersion = 2;
+const quint32 byteOrderMark = 0x01020304; // Offsets are stored in native byte order, written raw
+
+QMutex pruneMutex; // Files are indexed, and their sidecars saved, on several threads at once
+qint64 cacheSize = -1; // Bytes of all sidecars, guarded by pruneMutex; -1 until the directory has been scanned
+
+QString cacheDirectory() {
+    return QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + "/index";
+}
+
+// Reads the header of a sidecar up to the path of the indexed file
+bool readHeader(QFile &file, QDataStream &in, QString &filePath) {
+    quint32 magic = 0, version = 0, byteOrder = 0;
+    in >> magic >> version;
+    if (in.status() != QDataStream::Ok || magic != cacheMagic || version != cacheVersion) {
+        return false;
+    }
+    if (file.read(reinterpret_cast<char *>(&byteOrder), sizeof(byteOrder)) != sizeof(byteOrder) || byteOrder != byteOrderMark) {
+        return false;
+    }
+    in >> filePath;
+    return in.status() == QDataStream::Ok;
+}
+
+// Entries of an archive are indexed under the archive path followed by the entry path, so the
+// source exists if the nearest existing ancestor of the path is a file rather than a directory
+bool sourceExists(const QString &filePath) {
+    QFileInfo info(filePath);
+    while (!info.exists()) {
+        const QString parent = info.path();
+        if (parent == info.filePath()) {
+            return false;
+        }
+        info = QFileInfo(parent);
+    }
+    return info.isFile();
+}
+}
+
+QString IndexCache::cachePath(const QString &filePath) {
+    QByteArray key = QCryptographicHash::hash(QFileInfo(filePath).absoluteFilePath().toUtf8(), QCryptographicHash::Sha1).toHex();
+    return cacheDirectory() + "/" + QString::fromLatin1(key) + ".lzi";
+}
+
+bool IndexCache::load(const QString &filePath, Entry &entry) {
+    QFile file(cachePath(filePath));
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+
+    QDataStream in(&file);
+    in.setVersion(QDataStream::Qt_5_15);
+    if (!readHeader(file, in, entry.filePath)) {
+        return false;
+    }
+
+    quint64 lineCount = 0;
+    in >> entry.fileSize >> entry.textSize >> entry.modified >> entry.headHash >> entry.tailHash
+        >> entry.longestLine >> entry.timestampsSorted >> lineCount;
+    if (in.status() != QDataStream::Ok || entry.filePath != QFileInfo(filePath).absoluteFilePath()) {
+        return false;
+    }
+
+    // Checked before multiplying, so that a corrupt count can neither overflow nor allocate more than the file holds
+    if (lineCount > static_cast<quint64>(file.size() - file.pos()) / (2 * sizeof(quint64))) {
+        return false; // Truncated or foreign file
+    }
+    const qint64 arrayBytes = static_cast<qint64>(lineCount * sizeof(quint64));
+
+    entry.lineOffsets.resize(lineCount);
+    entry.timestamps.resize(lineCount);
+    if (file.read(reinterpret_cast<char *>(entry.lineOffsets.data()), arrayBytes) != arrayBytes
+        || file.read(reinterpret_cast<char *>(entry.timestamps.data()), arrayBytes) != arrayBytes) {
+        return false;
+    }
+
+    quint32 checkpointCount = 0;
+    in >> checkpointCount;
+    entry.checkpoints.clear();
+    for (quint32 i = 0; i < checkpointCount && in.status() == QDataStream::Ok; ++i) {
+        GzipCheckpoint checkpoint;
+        qint32 bits = 0;
+        in >> checkpoint.input >> checkpoint.output >> bits >> checkpoint.window;
+        checkpoint.bits = bits;
+        entry.checkpoints.append(checkpoint);
+    }
+    if (in.status() != QDataStream::Ok) {
+        return false;
+    }
+
+    // The modification time of a sidecar records when it was last used, for prune()
+    file.close();
+    if (file.open(QIODevice::Append)) {
+        file.setFileTime(QDateTime::currentDateTimeUtc(), QFileDevice::FileModificationTime);
+    }
+    return true;
+}
+
+bool IndexCache::save(const Entry &entry) {
+    if (entry.lineOffsets.size() != entry.timestamps.size()) {
+        return false;
+    }
+
+    QString path = cachePath(entry.filePath);
+    if (!QDir().mkpath(QFileInfo(path).absolutePath())) {
+        return false;
+    }
+
+    const qint64 previousSize = QFileInfo(path).size(); // 0 if there is none
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) {
+        return false;
+    }
+
+    QDataStream out(&file);
+    out.setVersion(QDataStream::Qt_5_15);
+    out << cacheMagic << cacheVersion;
+    file.write(reinterpret_cast<const char *>(&byteOrderMark), sizeof(byteOrderMark));
+    out << QFileInfo(entry.filePath).absoluteFilePath() << entry.fileSize << entry.textSize << entry.modified
+        << entry.headHash << entry.tailHash << entry.longestLine << entry.timestampsSorted
+        << static_cast<quint64>(entry.lineOffsets.size());
+
+    const qint64 arrayBytes = static_cast<qint64>(entry.lineOffsets.size() * sizeof(quint64));
+    file.write(reinterpret_cast<const char *>(entry.lineOffsets.constData()), arrayBytes);
+    file.write(reinterpret_cast<const char *>(entry.timestamps.constData()), arrayBytes);
+
+    out << static_cast<quint32>(entry.checkpoints.size());
+    for (const GzipCheckpoint &checkpoint : entry.checkpoints) {
+        out << checkpoint.input << checkpoint.output << static_cast<qint32>(checkpoint.bits) << checkpoint.window;
+    }
+
+    if (out.status() != QDataStream::Ok) {
+        file.cancelWriting();
+    }
+    if (!file.commit()) {
+        return false;
+    }
+
+    // Scanning the directory on every save would make opening a batch of files quadratic
+    QMutexLocker locker(&pruneMutex);
+    if (cacheSize >= 0) {
+        cacheSize += QFileInfo(path).size() - previousSize;
+    }
+    if (cacheSize < 0 || cacheSize > maximumCacheSize) {
+        locker.unlock();
+        prune(path);
+    }
+    return true;
+}
+
+void IndexCache::prune(const QString &keepPath) {
+    QMutexLocker locker(&pruneMutex);
+    QFileInfoList sidecars = QDir(cacheDirectory()).entryInfoList(QStringList{"*.lzi"}, QDir::Files, QDir::Time); // Most recently used first
+
+    qint64 totalSize = 0;
+    QFileInfoList kept;
+    for (const QFileInfo &sidecar : std::as_const(sidecars)) {
+        QFile file(sidecar.absoluteFilePath());
+        QString filePath;
+        if (sidecar.absoluteFilePath() != QFileInfo(keepPath).absoluteFilePath() && file.open(QIODevice::ReadOnly)) {
+            QDataStream in(&file);
+            in.setVersion(QDataStream::Qt_5_15);
+            bool valid = readHeader(file, in, filePath);
+            file.close();
+            if (!valid || !sourceExists(filePath)) {
+                QFile::remove(sidecar.absoluteFilePath()); // Stale version, or the file was rotated or deleted
+                continue;
+            }
+        }
+        totalSize += sidecar.size();
+        kept.append(sidecar);
+    }
+
+    // Least recently used first out, never the one to keep
+    for (auto sidecar = kept.crbegin(); sidecar != kept.crend() && totalSize > maximumCacheSize; ++sidecar) {
+        if (sidecar->absoluteFilePath() != QFileInfo(keepPath).absoluteFilePath() && QFile::remove(sidecar->absoluteFilePath())) {
+            totalSize -= sidecar->size();
+        }
+    }
+    cacheSize = totalSize;
+}
+
+quint64 IndexCache::hash(const uchar *data, qint64 length) {
+    quint64 value = 14695981039346656037ULL;
+    for (qint64 i = 0; i < length; ++i) {
+        value ^= data[i];
+        value *= 1099511628211ULL;
+    }
+    return value;
+}
+
+bool IndexCache::hashFile(const QString &filePath, qint64 offset, qint64 length, quint64 &headHash, quint64 &tailHash) {
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadOnly) || !file.seek(offset)) {
+        return false;
+    }
+
+    const qint64 hashLength = qMin(headTailSize, length);
+    QByteArray head = file.read(hashLength);
+    if (head.size() != hashLength || !file.seek(offset + length - hashLength)) {
+        return false;
+    }
+    QByteArray tail = file.read(hashLength);
+    if (tail.size() != hashLength) {
+        return false;
+    }
+
+    headHash = hash(reinterpret_cast<const uchar *>(head.constData()), hashLength);
+    tailHash = hash(reinterpret_cast<const uchar *>(tail.constData()), hashLength);
+    return true;
+}
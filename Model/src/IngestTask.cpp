@@ -0,0 +1,79 @@
+#include "IngestTask.h"
+#include <QFileInfo>
+
+IngestTask::IngestTask(const QString &filePath, const QString &groupName, QObject *parent)
+    : QObject(parent), filePath(filePath), group(groupName) {
+    setAutoDelete(false);
+}
+
+IngestTask::IngestTask(const QSharedPointer<ArchiveSession> &archive, const QString &entryPath, const QString &groupName, QObject *parent)
+    : QObject(parent), archive(archive), entryPath(entryPath), group(groupName) {
+    setAutoDelete(false);
+}
+
+void IngestTask::run() {
+    if (cancelled) {
+        emit finished();
+        return;
+    }
+
+    QSharedPointer<LogSource> source;
+    if (archive) {
+        // Read in place from the archive, the directory was parsed once for all its entries
+        QString error;
+        source = archive->createSource(entryPath, &error);
+        if (!source) {
+            emit failed(error);
+            emit finished();
+            return;
+        }
+    } else {
+        source = LogSource::create(filePath);
+    }
+
+    if (!source->open()) {
+        emit failed(tr("Unable to open file: %1").arg(source->errorString()));
+        emit finished();
+        return;
+    }
+    logSource = source;
+
+    // The file shows up in the tree right after its first chunk, the rest is indexed while it is browsed
+    bool announced = false;
+    bool indexed = source->buildIndex([this, &announced](qint64 bytesRead, qint64 bytesIndexed, qint64 linesIndexed) {
+        if (!announced && !cancelled) {
+            announced = true;
+            emit sourceReady();
+        }
+        emit progress(bytesRead, bytesIndexed, linesIndexed);
+        return !cancelled;
+    });
+
+    if (!announced && indexed && !cancelled) {
+        emit sourceReady(); // Empty files produce no chunks; failed or cancelled ones are not shown
+    }
+    if (!indexed && !cancelled) {
+        emit failed(tr("Unable to read file: %1").arg(source->errorString()));
+    }
+    emit finished();
+}
+
+void IngestTask::cancel() {
+    cancelled = true;
+}
+
+bool IngestTask::isCancelled() const {
+    return cancelled;
+}
+
+QString IngestTask::groupName() const {
+    return group;
+}
+
+QString IngestTask::displayName() const {
+    return archive ? archive->displayName(entryPath) : QFileInfo(filePath).fileName();
+}
+
+QSharedPointer<LogSource> IngestTask::source() const {
+    return logSource;
+}
@@ -0,0 +1,213 @@
+#include "LineLexer.h"
+#include <cstring>
+
+namespace {
+
+bool isDigit(char16_t c) {
+    return c >= u'0' && c <= u'9';
+}
+
+bool isHexDigit(char16_t c) {
+    return isDigit(c) || (c >= u'a' && c <= u'f') || (c >= u'A' && c <= u'F');
+}
+
+bool isWordCharacter(char16_t c) {
+    if (c < 0x80) {
+        return isDigit(c) || (c >= u'a' && c <= u'z') || (c >= u'A' && c <= u'Z') || c == u'_';
+    }
+    return QChar(c).isLetterOrNumber();
+}
+
+// Number of consecutive digits at text[i], at most max
+int digitsAt(const char16_t *text, int length, int i, int max) {
+    int count = 0;
+    while (i + count < length && count < max && isDigit(text[i + count])) {
+        ++count;
+    }
+    return count;
+}
+
+// Each matcher returns the length of its token at text[i], or 0
+
+int matchTimestamp(const char16_t *text, int length, int i) {
+    static const char pattern[] = "dddd-dd-dd?dd:dd:dd";
+    const int patternLength = sizeof(pattern) - 1;
+    if (length - i < patternLength) {
+        return 0;
+    }
+    for (int k = 0; k < patternLength; ++k) {
+        const char16_t c = text[i + k];
+        const char expected = pattern[k];
+        const bool ok = expected == 'd' ? isDigit(c) : expected == '?' ? (c == u' ' || c == u'T') : c == char16_t(expected);
+        if (!ok) {
+            return 0;
+        }
+    }
+    int end = i + patternLength;
+    if (end + 1 < length && (text[end] == u'.' || text[end] == u',') && isDigit(text[end + 1])) {
+        end += 1 + digitsAt(text, length, end + 1, 9);
+    }
+    return end - i;
+}
+
+int matchAddress(const char16_t *text, int length, int i) {
+    int end = i;
+    for (int group = 0; group < 4; ++group) {
+        if (group > 0) {
+            if (end >= length || text[end] != u'.') {
+                return 0;
+            }
+            ++end;
+        }
+        const int digits = digitsAt(text, length, end, 3);
+        if (digits == 0) {
+            return 0;
+        }
+        end += digits;
+    }
+    if (end < length && (isWordCharacter(text[end]) || (text[end] == u'.' && end + 1 < length && isDigit(text[end + 1])))) {
+        return 0; // A longer dotted number, such as a version
+    }
+    if (end + 1 < length && text[end] == u':' && isDigit(text[end + 1])) {
+        end += 1 + digitsAt(text, length, end + 1, 5);
+    }
+    return end - i;
+}
+
+int matchUuid(const char16_t *text, int length, int i) {
+    static const int groups[] = {8, 4, 4, 4, 12};
+    int end = i;
+    for (int group = 0; group < 5; ++group) {
+        if (group > 0) {
+            if (end >= length || text[end] != u'-') {
+                return 0;
+            }
+            ++end;
+        }
+        for (int k = 0; k < groups[group]; ++k, ++end) {
+            if (end >= length || !isHexDigit(text[end])) {
+                return 0;
+            }
+        }
+    }
+    return end < length && isWordCharacter(text[end]) ? 0 : end - i;
+}
+
+int matchNumber(const char16_t *text, int length, int i) {
+    int end = i;
+    if (text[i] == u'0' && i + 2 < length && (text[i + 1] == u'x' || text[i + 1] == u'X') && isHexDigit(text[i + 2])) {
+        end += 2;
+        while (end < length && isHexDigit(text[end])) {
+            ++end;
+        }
+        return end - i;
+    }
+    end += digitsAt(text, length, end, length);
+    while (end + 1 < length && text[end] == u'.' && isDigit(text[end + 1])) {
+        end += 1 + digitsAt(text, length, end + 1, length);
+    }
+    return end - i;
+}
+
+// Severity of a whole word, or KindCount if it is none
+LineLexer::Kind levelOf(const char16_t *word, int length) {
+    if (length < 3 || length > 8) {
+        return LineLexer::KindCount;
+    }
+    // Compare in upper case, accepting upper and title case only
+    const bool titleCase = word[1] >= u'a' && word[1] <= u'z';
+    char upper[8];
+    for (int k = 0; k < length; ++k) {
+        char16_t c = word[k];
+        if (k > 0 && titleCase) {
+            if (c < u'a' || c > u'z') {
+                return LineLexer::KindCount;
+            }
+            c -= u'a' - u'A';
+        }
+        if (c < u'A' || c > u'Z') {
+            return LineLexer::KindCount;
+        }
+        upper[k] = static_cast<char>(c);
+    }
+
+    static const struct {
+        const char *word;
+        LineLexer::Kind kind;
+    } levels[] = {
+        {"ERROR", LineLexer::Error}, {"ERR", LineLexer::Error}, {"FATAL", LineLexer::Error},
+        {"CRITICAL", LineLexer::Error}, {"SEVERE", LineLexer::Error},
+        {"WARN", LineLexer::Warning}, {"WARNING", LineLexer::Warning},
+        {"INFO", LineLexer::Info}, {"NOTICE", LineLexer::Info},
+        {"DEBUG", LineLexer::Debug}, {"TRACE", LineLexer::Debug}, {"VERBOSE", LineLexer::Debug},
+    };
+    for (const auto &level : levels) {
+        if (std::strlen(level.word) == static_cast<size_t>(length) && std::memcmp(level.word, upper, length) == 0) {
+            return level.kind;
+        }
+    }
+    return LineLexer::KindCount;
+}
+
+} // namespace
+
+LineLexer::Tokens LineLexer::tokenize(const QString &line) {
+    Tokens tokens;
+    const char16_t *text = reinterpret_cast<const char16_t *>(line.constData());
+    const int length = static_cast<int>(line.size());
+
+    int i = 0;
+    while (i < length) {
+        const char16_t c = text[i];
+        if (!isWordCharacter(c)) {
+            ++i;
+            continue;
+        }
+
+        // A word starts here; try the token rules that can start with its first character
+        int tokenLength = 0;
+        Kind kind = KindCount;
+        if (isDigit(c)) {
+            if ((tokenLength = matchTimestamp(text, length, i))) {
+                kind = Timestamp;
+            } else if ((tokenLength = matchUuid(text, length, i))) {
+                kind = Uuid;
+            } else if ((tokenLength = matchAddress(text, length, i))) {
+                kind = Address;
+            } else {
+                tokenLength = matchNumber(text, length, i);
+                kind = Number;
+            }
+        } else if (isHexDigit(c) && (tokenLength = matchUuid(text, length, i))) {
+            kind = Uuid;
+        }
+
+        if (kind != KindCount) {
+            tokens.append(Token{i, tokenLength, kind});
+            i += tokenLength;
+        } else {
+            int end = i + 1;
+            while (end < length && isWordCharacter(text[end])) {
+                ++end;
+            }
+            kind = levelOf(text + i, end - i);
+            if (kind != KindCount) {
+                tokens.append(Token{i, end - i, kind});
+            }
+            // Dotted names such as v1.2.3, host.example.com or com.example.Class are one word
+            while (end + 1 < length && text[end] == u'.' && isWordCharacter(text[end + 1])) {
+                end += 2;
+                while (end < length && isWordCharacter(text[end])) {
+                    ++end;
+                }
+            }
+            i = end;
+        }
+
+        // The rest of a word a token ended inside of is skipped, e.g. the "ms" of "10ms"
+        while (i < length && isWordCharacter(text[i]) && !isDigit(text[i])) {
+            ++i;
+        }
+    }
+    return tokens;
+}
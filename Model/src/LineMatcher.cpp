@@ -0,0 +1,275 @@
+#include "LineMatcher.h"
+#include <algorithm>
+#include <cctype>
+
+namespace {
+bool isAsciiOnly(const QString &text) {
+    return std::all_of(text.cbegin(), text.cend(), [](QChar c) { return c.unicode() < 0x80; });
+}
+
+// Returns the position of the ']' closing the character class opened at start
+qsizetype classEnd(const QString &pattern, qsizetype start) {
+    const qsizetype size = pattern.size();
+    qsizetype i = start + 1;
+    if (i < size && pattern.at(i) == QLatin1Char('^')) {
+        ++i;
+    }
+    if (i < size && pattern.at(i) == QLatin1Char(']')) {
+        ++i; // A leading ] is a member of the class
+    }
+    for (; i < size; ++i) {
+        const QChar c = pattern.at(i);
+        if (c == QLatin1Char('\\')) {
+            ++i;
+        } else if (c == QLatin1Char('[') && i + 1 < size && pattern.at(i + 1) == QLatin1Char(':')) {
+            const qsizetype end = pattern.indexOf(QLatin1String(":]"), i + 2);
+            i = end < 0 ? size : end + 1;
+        } else if (c == QLatin1Char(']')) {
+            return i;
+        }
+    }
+    return size;
+}
+
+// Returns the position of the ')' closing the group opened at start
+qsizetype groupEnd(const QString &pattern, qsizetype start) {
+    int depth = 0;
+    for (qsizetype i = start; i < pattern.size(); ++i) {
+        const QChar c = pattern.at(i);
+        if (c == QLatin1Char('\\')) {
+            ++i;
+        } else if (c == QLatin1Char('[')) {
+            i = classEnd(pattern, i);
+        } else if (c == QLatin1Char('(')) {
+            ++depth;
+        } else if (c == QLatin1Char(')') && --depth == 0) {
+            return i;
+        }
+    }
+    return pattern.size();
+}
+
+// Returns the last position of the argument of an escape like \x{41}, \p{Lu} or \g<name>, whose letter is at start
+qsizetype escapeEnd(const QString &pattern, qsizetype start) {
+    const qsizetype size = pattern.size();
+    const QChar letter = pattern.at(start);
+    qsizetype i = start + 1;
+    if (i < size && (pattern.at(i) == QLatin1Char('{') || pattern.at(i) == QLatin1Char('<') || pattern.at(i) == QLatin1Char('\''))) {
+        static const QString closing = QStringLiteral("}>'");
+        const qsizetype end = pattern.indexOf(closing.at(QStringLiteral("{<'").indexOf(pattern.at(i))), i + 1);
+        return end < 0 ? size - 1 : end;
+    }
+    if (letter == QLatin1Char('c') || letter == QLatin1Char('p') || letter == QLatin1Char('P')) {
+        return qMin(i, size - 1); // One character of argument
+    }
+    if (letter == QLatin1Char('x')) {
+        while (i < size && i < start + 3 && isxdigit(pattern.at(i).toLatin1())) {
+            ++i;
+        }
+        return i - 1;
+    }
+    if (letter.isDigit() || letter == QLatin1Char('g')) {
+        while (i < size && (pattern.at(i).isDigit() || (letter == QLatin1Char('g') && i == start + 1 && pattern.at(i) == QLatin1Char('-')))) {
+            ++i;
+        }
+        return i - 1;
+    }
+    return start;
+}
+}
+
+LineMatcher::LineMatcher(const QString &pattern, Qt::CaseSensitivity caseSensitivity, bool regularExpression)
+    : text(pattern), caseSensitivity(caseSensitivity), searcher(QString(), caseSensitivity) {
+    QString literalText = pattern;
+    if (regularExpression) {
+        QRegularExpression::PatternOptions options = QRegularExpression::NoPatternOption;
+        if (caseSensitivity == Qt::CaseInsensitive) {
+            options |= QRegularExpression::CaseInsensitiveOption;
+        }
+        expression = QRegularExpression(pattern, options);
+        expression.optimize(); // Compiles with the JIT now rather than on the first line matched
+        text.clear();
+        literalText = requiredLiteral(pattern);
+    }
+
+    // Only ASCII is folded byte by byte
+    searcher = TextSearcher(literalText, caseSensitivity);
+    prefilter = !searcher.isEmpty() && (caseSensitivity == Qt::CaseSensitive || isAsciiOnly(literalText));
+    exact = prefilter && !regularExpression;
+}
+
+bool LineMatcher::isValid() const {
+    return expression.isValid();
+}
+
+QString LineMatcher::errorString() const {
+    return expression.errorString();
+}
+
+bool LineMatcher::isEmpty() const {
+    return text.isEmpty() && expression.pattern().isEmpty();
+}
+
+bool LineMatcher::hasLiteral() const {
+    return prefilter;
+}
+
+bool LineMatcher::isLiteralExact() const {
+    return exact;
+}
+
+qsizetype LineMatcher::textLength() const {
+    return text.size();
+}
+
+const TextSearcher &LineMatcher::literal() const {
+    return searcher;
+}
+
+bool LineMatcher::mayMatch(const QByteArray &bytes) const {
+    return !prefilter || searcher.indexIn(bytes.constData(), bytes.size()) >= 0;
+}
+
+qsizetype LineMatcher::indexIn(const QString &line, qsizetype from, qsizetype *length) const {
+    if (!text.isEmpty()) {
+        *length = text.size();
+        return line.indexOf(text, from, caseSensitivity);
+    }
+    const QRegularExpressionMatch match = expression.match(line, from);
+    if (!match.hasMatch()) {
+        return -1;
+    }
+    *length = match.capturedLength();
+    return match.capturedStart();
+}
+
+qsizetype LineMatcher::lastIndexIn(const QString &line, qsizetype before, qsizetype *length) const {
+    if (!text.isEmpty()) {
+        *length = text.size();
+        return before < 0 ? -1 : line.lastIndexOf(text, before, caseSensitivity);
+    }
+    qsizetype found = -1;
+    QRegularExpressionMatchIterator matches = expression.globalMatch(line);
+    while (matches.hasNext()) {
+        const QRegularExpressionMatch match = matches.next();
+        if (match.capturedStart() > before) {
+            break;
+        }
+        found = match.capturedStart();
+        *length = match.capturedLength();
+    }
+    return found;
+}
+
+bool LineMatcher::narrows(const LineMatcher &other) const {
+    return !text.isEmpty() && !other.text.isEmpty() && caseSensitivity == other.caseSensitivity
+           && text.contains(other.text, caseSensitivity);
+}
+
+QString LineMatcher::requiredLiteral(const QString &pattern) {
+    QString longest;
+    QString run;            // Literal characters matched one after the other
+    bool endsRun = false;   // True if the previous atom is the last character of run
+    auto closeRun = [&]() {
+        if (run.size() > longest.size()) {
+            longest = run;
+        }
+        run.clear();
+        endsRun = false;
+    };
+    auto skipModifier = [&](qsizetype &i) {
+        // Lazy and possessive quantifiers match the same characters
+        if (i + 1 < pattern.size() && (pattern.at(i + 1) == QLatin1Char('?') || pattern.at(i + 1) == QLatin1Char('+'))) {
+            ++i;
+        }
+    };
+
+    for (qsizetype i = 0; i < pattern.size(); ++i) {
+        const QChar c = pattern.at(i);
+        switch (c.unicode()) {
+        case '|':
+            return QString(); // Any alternative may match without the literal
+        case '(':
+            if (i + 2 < pattern.size() && pattern.at(i + 1) == QLatin1Char('?')
+                && (pattern.at(i + 2).isLetter() || pattern.at(i + 2) == QLatin1Char('-') || pattern.at(i + 2) == QLatin1Char('^'))) {
+                return QString(); // Inline options like (?i) change how the literal matches
+            }
+            i = groupEnd(pattern, i);
+            closeRun();
+            break;
+        case '[':
+            i = classEnd(pattern, i);
+            closeRun();
+            break;
+        case '.':
+        case '^':
+        case '$':
+            closeRun();
+            break;
+        case '?':
+        case '*':
+            if (endsRun) {
+                run.chop(1); // The character may be missing
+            }
+            closeRun();
+            skipModifier(i);
+            break;
+        case '+':
+            closeRun();
+            skipModifier(i);
+            break;
+        case '{': {
+            // A quantifier is {n}, {n,} or {n,m}; anything else is a literal brace
+            qsizetype end = i + 1;
+            while (end < pattern.size() && pattern.at(end).isDigit()) {
+                ++end;
+            }
+            const bool hasMinimum = end > i + 1;
+            const int minimum = hasMinimum ? pattern.mid(i + 1, end - i - 1).toInt() : 0;
+            if (end < pattern.size() && pattern.at(end) == QLatin1Char(',')) {
+                ++end;
+                while (end < pattern.size() && pattern.at(end).isDigit()) {
+                    ++end;
+                }
+            }
+            if (hasMinimum && end < pattern.size() && pattern.at(end) == QLatin1Char('}')) {
+                if (minimum == 0 && endsRun) {
+                    run.chop(1);
+                }
+                closeRun();
+                i = end;
+                skipModifier(i);
+            } else {
+                run += c;
+                endsRun = true;
+            }
+            break;
+        }
+        case '\\':
+            if (i + 1 >= pattern.size()) {
+                return QString();
+            }
+            ++i;
+            if (pattern.at(i).isLetterOrNumber()) {
+                // Classes, anchors, references and coded characters; \Q...\E quotes are skipped as a whole
+                if (pattern.at(i) == QLatin1Char('Q')) {
+                    const qsizetype end = pattern.indexOf(QLatin1String("\\E"), i + 1);
+                    i = end < 0 ? pattern.size() : end + 1;
+                } else {
+                    i = escapeEnd(pattern, i);
+                }
+                closeRun();
+            } else {
+                run += pattern.at(i); // Escaped punctuation stands for itself
+                endsRun = true;
+            }
+            break;
+        default:
+            run += c;
+            endsRun = true;
+            break;
+        }
+    }
+    closeRun();
+    return longest;
+}
@@ -0,0 +1,230 @@
+#include "LineScanner.h"
+#include <atomic>
+#include <cstring>
+#include <limits>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define LOGZ_X86_SIMD
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#endif
+
+#if defined(__GNUC__) || defined(__clang__)
+#define LOGZ_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define LOGZ_TARGET_AVX2
+#endif
+
+namespace {
+
+// Working copy of the scanner state, kept in registers by the kernels. Kernels work on
+// positions relative to data; base is the offset of data[0] within the whole input.
+struct ScanState {
+    const char *data;
+    qint64 base;
+    char previous;
+    qint64 size;
+    qint64 lineStart;
+    qint64 longest;
+    QVector<quint64> *lineStarts;
+
+    inline void newline(qint64 relative) {
+        const qint64 pos = base + relative;
+        qint64 length = pos - lineStart;
+        const char before = relative > 0 ? data[relative - 1] : previous;
+        if (length > 0 && before == '\r') {
+            --length;
+        }
+        if (length > longest) {
+            longest = length;
+        }
+        lineStart = pos + 1;
+        if (lineStart < size) {
+            lineStarts->append(static_cast<quint64>(lineStart));
+        }
+    }
+};
+
+void scanScalar(ScanState &state, qint64 from, qint64 to) {
+    const char *begin = state.data;
+    const char *pos = begin + from;
+    const char *end = begin + to;
+    while (pos < end) {
+        const char *newline = static_cast<const char *>(std::memchr(pos, '\n', static_cast<size_t>(end - pos)));
+        if (!newline) {
+            break;
+        }
+        state.newline(newline - begin);
+        pos = newline + 1;
+    }
+}
+
+#ifdef LOGZ_X86_SIMD
+inline int countTrailingZeros(quint32 mask) {
+#if defined(_MSC_VER) && !defined(__clang__)
+    unsigned long index;
+    _BitScanForward(&index, mask);
+    return static_cast<int>(index);
+#else
+    return __builtin_ctz(mask);
+#endif
+}
+
+void scanSse2(ScanState &state, qint64 from, qint64 to) {
+    const char *data = state.data;
+    const __m128i newline = _mm_set1_epi8('\n');
+    qint64 pos = from;
+    for (; pos + 16 <= to; pos += 16) {
+        __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + pos));
+        quint32 mask = static_cast<quint32>(_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, newline)));
+        while (mask) {
+            state.newline(pos + countTrailingZeros(mask));
+            mask &= mask - 1;
+        }
+    }
+    scanScalar(state, pos, to);
+}
+
+LOGZ_TARGET_AVX2 void scanAvx2(ScanState &state, qint64 from, qint64 to) {
+    const char *data = state.data;
+    const __m256i newline = _mm256_set1_epi8('\n');
+    qint64 pos = from;
+    for (; pos + 64 <= to; pos += 64) {
+        __m256i low = _mm256_cmpeq_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + pos)), newline);
+        __m256i high = _mm256_cmpeq_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + pos + 32)), newline);
+        if (_mm256_testz_si256(_mm256_or_si256(low, high), _mm256_or_si256(low, high))) {
+            continue; // Most 64-byte blocks of a log contain no newline at all
+        }
+        quint32 mask = static_cast<quint32>(_mm256_movemask_epi8(low));
+        while (mask) {
+            state.newline(pos + countTrailingZeros(mask));
+            mask &= mask - 1;
+        }
+        mask = static_cast<quint32>(_mm256_movemask_epi8(high));
+        while (mask) {
+            state.newline(pos + 32 + countTrailingZeros(mask));
+            mask &= mask - 1;
+        }
+    }
+    scanSse2(state, pos, to);
+}
+#endif
+
+LineScanner::Kernel detectKernel() {
+#ifdef LOGZ_X86_SIMD
+#if defined(_MSC_VER) && !defined(__clang__)
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] >= 7) {
+        __cpuid(info, 1);
+        bool osSavesYmm = (info[2] & (1 << 27)) && (info[2] & (1 << 28)) && (_xgetbv(0) & 6) == 6;
+        __cpuidex(info, 7, 0);
+        if (osSavesYmm && (info[1] & (1 << 5))) {
+            return LineScanner::AVX2;
+        }
+    }
+    return LineScanner::SSE2;
+#else
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2") ? LineScanner::AVX2 : LineScanner::SSE2;
+#endif
+#else
+    return LineScanner::Scalar;
+#endif
+}
+
+LineScanner::Kernel detectedKernel() {
+    static const LineScanner::Kernel detected = detectKernel();
+    return detected;
+}
+
+std::atomic<int> selectedKernel{-1}; // Set by LineScanner::setKernel(), -1 for the detected kernel
+
+} // namespace
+
+LineScanner::LineScanner(const char *data, qint64 size) : data(data), size(size) {}
+
+LineScanner::LineScanner() : data(nullptr), size(std::numeric_limits<qint64>::max()) {}
+
+void LineScanner::scan(qint64 from, qint64 to, QVector<quint64> &lineStarts) {
+    if (to <= from) {
+        return;
+    }
+    run(data, 0, from > 0 ? data[from - 1] : '\0', from, to, lineStarts);
+    lastByte = data[to - 1];
+    scannedEnd = to;
+}
+
+void LineScanner::scanBuffer(const char *buffer, qint64 length, QVector<quint64> &lineStarts) {
+    if (length <= 0) {
+        return;
+    }
+    run(buffer, scannedEnd, lastByte, 0, length, lineStarts);
+    lastByte = buffer[length - 1];
+    scannedEnd += length;
+}
+
+void LineScanner::finish() {
+    size = scannedEnd;
+}
+
+void LineScanner::run(const char *buffer, qint64 base, char previous, qint64 from, qint64 to, QVector<quint64> &lineStarts) {
+    ScanState state{buffer, base, previous, size, lineStart, longest, &lineStarts};
+
+    switch (kernel()) {
+#ifdef LOGZ_X86_SIMD
+    case AVX2:
+        scanAvx2(state, from, to);
+        break;
+    case SSE2:
+        scanSse2(state, from, to);
+        break;
+#endif
+    default:
+        scanScalar(state, from, to);
+        break;
+    }
+
+    lineStart = state.lineStart;
+    longest = state.longest;
+}
+
+void LineScanner::resume(qint64 lineStart, qint64 longestSoFar) {
+    this->lineStart = lineStart;
+    longest = longestSoFar;
+    scannedEnd = lineStart;
+}
+
+qint64 LineScanner::longestLine() const {
+    if (scannedEnd < size || lineStart >= size) {
+        return longest;
+    }
+
+    qint64 lastLength = size - lineStart;
+    if (lastByte == '\r') {
+        --lastLength;
+    }
+    return qMax(longest, lastLength);
+}
+
+LineScanner::Kernel LineScanner::kernel() {
+    const int selected = selectedKernel.load(std::memory_order_relaxed);
+    return selected < 0 ? detectedKernel() : static_cast<Kernel>(selected);
+}
+
+void LineScanner::setKernel(Kernel kernel) {
+    selectedKernel.store(qMin(kernel, detectedKernel()), std::memory_order_relaxed); // Kernels are ordered by the CPU features they need
+}
+
+const char *LineScanner::kernelName() {
+    switch (kernel()) {
+    case AVX2:
+        return "AVX2";
+    case SSE2:
+        return "SSE2";
+    default:
+        return "scalar";
+    }
+}
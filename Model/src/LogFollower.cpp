@@ -0,0 +1,74 @@
+#include "LogFollower.h"
+#include <QFileInfo>
+
+namespace {
+const int refreshIntervalMs = 100; // Upper bound for the delay between a write and its display
+const int ticksPerPoll = 10;       // Every followed file is checked at least once a second
+}
+
+LogFollower::LogFollower(QObject *parent) : QObject(parent) {
+    refreshTimer.setInterval(refreshIntervalMs);
+    connect(&refreshTimer, &QTimer::timeout, this, &LogFollower::refreshFiles);
+    connect(&watcher, &QFileSystemWatcher::fileChanged, this, [this](const QString &path) {
+        dirtyPaths.insert(path);
+    });
+}
+
+void LogFollower::follow(const QSharedPointer<LogSource> &source) {
+    QString filePath = source->filePath();
+    source->startFollowing();
+    followed.insert(filePath, source);
+    watcher.addPath(filePath);
+    dirtyPaths.insert(filePath); // Catch up with anything written since it was indexed
+    if (!refreshTimer.isActive()) {
+        refreshTimer.start();
+    }
+}
+
+void LogFollower::unfollow(const QString &filePath) {
+    followed.remove(filePath);
+    dirtyPaths.remove(filePath);
+    watcher.removePath(filePath);
+    if (followed.isEmpty()) {
+        refreshTimer.stop();
+    }
+}
+
+bool LogFollower::isFollowing(const QString &filePath) const {
+    return followed.contains(filePath);
+}
+
+void LogFollower::refreshFiles() {
+    if (++ticksSincePoll >= ticksPerPoll) {
+        ticksSincePoll = 0;
+        for (auto it = followed.cbegin(); it != followed.cend(); ++it) {
+            dirtyPaths.insert(it.key());
+        }
+    }
+
+    const QSet<QString> paths = dirtyPaths;
+    dirtyPaths.clear();
+    for (const QString &filePath : paths) {
+        QSharedPointer<LogSource> source = followed.value(filePath);
+        if (!source) {
+            continue;
+        }
+
+        // After a rename or delete the watcher drops the path; watch the new file once it appears
+        if (!watcher.files().contains(filePath) && QFileInfo::exists(filePath)) {
+            watcher.addPath(filePath);
+        }
+
+        qint64 firstChangedLine = 0;
+        switch (source->refresh(firstChangedLine)) {
+        case LogSource::Appended:
+            emit linesAppended(filePath, firstChangedLine);
+            break;
+        case LogSource::Reset:
+            emit sourceReset(filePath);
+            break;
+        case LogSource::Unchanged:
+            break;
+        }
+    }
+}
@@ -2,104 +2,323 @@
 #include <QFile>
 #include <QTextStream>
 #include <QStandardPaths>
-#include <KZip>
-#include <KArchiveFile>
 #include <QMessageBox>
 #include <QRegularExpression>
 #include <QTextBlock>
 #include <QTextDocumentFragment>
 #include <QFileInfo>
+#include "IngestTask.h"
+#include <algorithm>
 
-LogManager::LogManager(QObject *parent) : QObject(parent) {}
-LogManager::~LogManager() {}
+LogManager::LogManager(QObject *parent) : QObject(parent) {
+    connect(&follower, &LogFollower::linesAppended, this, &LogManager::linesAppended);
+    connect(&follower, &LogFollower::sourceReset, this, &LogManager::sourceReset);
+}
+
+LogManager::~LogManager() {
+    cancelArchiveListing();
+    cancelIngestion();
+    ingestionPool.waitForDone();
+    qDeleteAll(activeTasks);
+}
 
 bool LogManager::openAndDisplayFile(const QString &filePath, const QString &groupName) {
     QString fileName = QFileInfo(filePath).fileName();
-    QFile file(filePath);
-    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+    if (joinOpenFile(filePath, fileName, groupName)) {
+        return true;
+    }
+
+    QFileInfo fileInfo(filePath);
+    if (!fileInfo.isFile()) {
         emit errorOccurred(tr("Unable to open file."));
         return false;
     }
 
-    QTextStream in(&file);
-    QStringList fileContent;
-    QString line;
-    int lineCount = 0;
-    const int maxLinesPerFile = 100000; // Max number of lines per file
-    int filePartNumber = 1;
+    pendingGroups.insert(filePath, groupName);
+    startTask(new IngestTask(filePath, groupName), filePath, fileInfo.size());
+    return true;
+}
 
-    while (!in.atEnd()) {
-        line = in.readLine();
-        fileContent.append(line);
-        lineCount++;
+void LogManager::openFiles(const QStringList &filePaths, const QString &groupName) {
+    // Longest job first keeps all workers busy until the end of the batch
+    QList<QPair<qint64, QString>> bySize;
+    for (const QString &filePath : filePaths) {
+        bySize.append(qMakePair(QFileInfo(filePath).size(), filePath));
+    }
+    std::stable_sort(bySize.begin(), bySize.end(), [](const QPair<qint64, QString> &a, const QPair<qint64, QString> &b) {
+        return a.first > b.first;
+    });
 
-        if (lineCount >= maxLinesPerFile) {
-            QString partFileName = QString("%1-%2").arg(filePartNumber).arg(fileName);
-            QString tempPath = writeLinesToFile(fileContent, partFileName);
-            addToGroup(groupName, partFileName, tempPath);
+    for (const auto &file : std::as_const(bySize)) {
+        openAndDisplayFile(file.second, groupName);
+    }
+}
+
+void LogManager::openArchive(const QString &archivePath, const QString &groupName) {
+    listArchive(archivePath, ArchiveRequest{groupName, QStringList()});
+}
 
-            fileContent.clear(); // reset for next file
-            lineCount = 0;
-            filePartNumber++;
+void LogManager::cancelArchiveListing() {
+    for (const std::shared_ptr<std::atomic<bool>> &stop : std::as_const(archiveListings)) {
+        stop->store(true);
+    }
+}
+
+void LogManager::listArchive(const QString &archivePath, const ArchiveRequest &request) {
+    const bool listing = archiveRequests.contains(archivePath);
+    archiveRequests[archivePath].append(request);
+    if (listing) {
+        return; // Served when the running listing is done
+    }
+
+    // Even a session that is still current is handed over asynchronously, like a listed one
+    QSharedPointer<ArchiveSession> archive = archives.value(archivePath);
+    if (archive && archive->isCurrent()) {
+        QMetaObject::invokeMethod(this, [this, archivePath, archive]() {
+            onArchiveListed(archivePath, archive, QString());
+        }, Qt::QueuedConnection);
+        return;
+    }
+
+    // Listing reads the archive directory, or all of a TAR archive, so it runs on the pool ahead
+    // of queued ingestion tasks
+    auto stop = std::make_shared<std::atomic<bool>>(false);
+    archiveListings.insert(archivePath, stop);
+    ingestionPool.start([this, archivePath, stop]() {
+        QString error;
+        QSharedPointer<ArchiveSession> archive = ArchiveSession::open(archivePath, &error, [this, archivePath, stop](qint64 bytesRead, qint64 bytesTotal) {
+            emit archiveListingProgress(archivePath, bytesRead, bytesTotal);
+            return !stop->load();
+        });
+        QMetaObject::invokeMethod(this, [this, archivePath, archive, error]() {
+            onArchiveListed(archivePath, archive, error);
+        }, Qt::QueuedConnection);
+    }, 1);
+}
+
+void LogManager::onArchiveListed(const QString &archivePath, const QSharedPointer<ArchiveSession> &archive, const QString &error) {
+    archiveListings.remove(archivePath);
+    const QList<ArchiveRequest> requests = archiveRequests.take(archivePath);
+    if (!archive) {
+        archives.remove(archivePath);
+        if (!error.isEmpty()) {
+            emit errorOccurred(error);
         }
+    } else {
+        archives.insert(archivePath, archive);
+        for (const ArchiveRequest &request : requests) {
+            if (request.entryPaths.isEmpty()) {
+                emit archiveOpened(archive, request.groupName);
+            } else {
+                openArchiveEntries(archive, request.entryPaths, request.groupName);
+            }
+        }
+    }
+    if (archiveRequests.isEmpty()) {
+        emit archiveListingFinished();
     }
+}
 
-    if (!fileContent.isEmpty()) {
-        if (filePartNumber > 1) {
-            QString partFileName = QString("%1-%2").arg(filePartNumber).arg(fileName);
-            QString tempPath = writeLinesToFile(fileContent, partFileName);
-            addToGroup(groupName, partFileName, tempPath);
-        } else {
-            QString tempPath = writeLinesToFile(fileContent, fileName);
-            addToGroup(groupName, fileName, tempPath);
+void LogManager::openArchiveEntries(const QSharedPointer<ArchiveSession> &archive, const QStringList &entryPaths, const QString &groupName) {
+    // Longest job first, as in openFiles()
+    QList<const ArchiveSession::Entry *> bySize;
+    for (const QString &entryPath : entryPaths) {
+        const ArchiveSession::Entry *entry = archive->entry(entryPath);
+        if (!entry) {
+            emit errorOccurred(tr("The specified file does not exist within the archive."));
+            continue;
         }
+        bySize.append(entry);
     }
+    std::stable_sort(bySize.begin(), bySize.end(), [](const ArchiveSession::Entry *a, const ArchiveSession::Entry *b) {
+        return a->size > b->size;
+    });
+    archive->prepare(entryPaths);
 
-    file.close();
-    return true;
+    for (const ArchiveSession::Entry *entry : std::as_const(bySize)) {
+        QString filePath = archive->sourcePath(entry->path);
+        if (joinOpenFile(filePath, archive->displayName(entry->path), groupName)) {
+            continue;
+        }
+        pendingGroups.insert(filePath, groupName);
+        startTask(new IngestTask(archive, entry->path, groupName), filePath, entry->compressedSize);
+    }
 }
 
-QString LogManager::writeLinesToFile(const QStringList &lines, const QString &fileName) {
-    QString tempPath = QStandardPaths::writableLocation(QStandardPaths::TempLocation) + "/" + fileName;
-    QFile tempFile(tempPath);
-    if (tempFile.open(QIODevice::WriteOnly | QIODevice::Text)) {
-        QTextStream out(&tempFile);
-        for (const QString &line : lines) {
-            out << line << "\n";
+void LogManager::openFromZip(const QString &zipFilePath, const QString &fileInsideZip, const QString &groupName) {
+    listArchive(zipFilePath, ArchiveRequest{groupName, QStringList{fileInsideZip}});
+}
+
+void LogManager::cancelIngestion() {
+    if (activeTasks.isEmpty()) {
+        return;
+    }
+
+    ingestionCancelled = true;
+    const QList<IngestTask *> tasks = activeTasks;
+    for (IngestTask *task : tasks) {
+        if (ingestionPool.tryTake(task)) {
+            onTaskFinished(task); // Never started, so no finished() will arrive
+        } else {
+            task->cancel();
         }
-        tempFile.close();
     }
-    return tempPath;
 }
 
-QString LogManager::extractFileFromZip(const QString &zipFilePath, const QString &fileInsideZip) {
-    KZip archive(zipFilePath);
-    if (!archive.open(QIODevice::ReadOnly)) {
-        emit errorOccurred(tr("Failed to open ZIP file."));
-        return QString();
+bool LogManager::isIngesting() const {
+    return !activeTasks.isEmpty();
+}
+
+bool LogManager::joinOpenFile(const QString &filePath, const QString &fileName, const QString &groupName) {
+    if (sources.contains(filePath)) {
+        sourceRefs[filePath]++;
+        addToGroup(groupName, fileName, filePath);
+        return true;
+    }
+
+    if (pendingGroups.contains(filePath)) {
+        pendingGroups.insert(filePath, groupName); // Already queued, add it to this group as well once ready
+        return true;
+    }
+    return false;
+}
+
+void LogManager::startTask(IngestTask *task, const QString &filePath, qint64 expectedSize) {
+    if (activeTasks.isEmpty()) {
+        finishedBytesRead = 0;
+        finishedBytesIndexed = 0;
+        finishedLines = 0;
+        finishedFiles = 0;
+        ingestionCancelled = false;
+        ingestionTimer.start();
     }
 
-    const KArchiveDirectory *rootDir = archive.directory();
-    const KArchiveEntry *entry = rootDir->entry(fileInsideZip);
-    if (!entry || !entry->isFile()) {
-        emit errorOccurred(tr("The specified file does not exist within the ZIP archive."));
-        return QString();
+    activeTasks.append(task);
+    taskPaths.insert(task, filePath);
+    taskSizes.insert(task, expectedSize);
+    taskProgress.insert(task, TaskProgress());
+
+    // Tasks emit from worker threads, everything is handled here on the GUI thread
+    connect(task, &IngestTask::sourceReady, this, [this, task]() {
+        onTaskSourceReady(task);
+    }, Qt::QueuedConnection);
+    connect(task, &IngestTask::progress, this, [this, task](qint64 bytesRead, qint64 bytesIndexed, qint64 linesIndexed) {
+        taskProgress.insert(task, TaskProgress{bytesRead, bytesIndexed, linesIndexed});
+        reportProgress();
+    }, Qt::QueuedConnection);
+    connect(task, &IngestTask::failed, this, &LogManager::errorOccurred, Qt::QueuedConnection);
+    connect(task, &IngestTask::finished, this, [this, task]() {
+        onTaskFinished(task);
+    }, Qt::QueuedConnection);
+
+    ingestionPool.start(task);
+    reportProgress();
+}
+
+void LogManager::onTaskSourceReady(IngestTask *task) {
+    QSharedPointer<LogSource> logSource = task->source();
+    QString filePath = logSource->filePath();
+    taskSizes.insert(task, logSource->inputSize());
+    taskPaths.remove(task); // Its groups are served below
+
+    QStringList groups = pendingGroups.values(filePath);
+    pendingGroups.remove(filePath);
+    if (groups.isEmpty()) {
+        groups.append(task->groupName());
     }
 
-    const KArchiveFile *file = static_cast<const KArchiveFile *>(entry);
-    QString tempPath = QStandardPaths::writableLocation(QStandardPaths::TempLocation) + "/" + fileInsideZip;
+    if (!sources.contains(filePath)) {
+        sources.insert(filePath, logSource);
+    }
+    QString fileName = task->displayName();
+    for (const QString &groupName : groups) {
+        sourceRefs[filePath]++;
+        addToGroup(groupName, fileName, filePath);
+    }
+}
 
-    QFile tempFile(tempPath);
-    if (!tempFile.open(QIODevice::WriteOnly)) {
-        emit errorOccurred(tr("Unable to create temporary file for ZIP contents."));
-        return QString();
+void LogManager::onTaskFinished(IngestTask *task) {
+    if (!activeTasks.removeOne(task)) {
+        return;
     }
 
-    tempFile.write(file->data());
-    tempFile.close();
-    archive.close();
+    TaskProgress done = taskProgress.take(task);
+    finishedBytesRead += done.bytesRead;
+    finishedBytesIndexed += done.bytesIndexed;
+    finishedLines += done.lines;
+    taskSizes.remove(task);
+
+    // A task that failed or was cancelled before its source was ready leaves nothing to join
+    const QString pendingPath = taskPaths.take(task);
+    if (!pendingPath.isNull()) {
+        pendingGroups.remove(pendingPath);
+    }
+
+    if (task->source()) {
+        finishedFiles++;
+        emit sourceUpdated(task->source()->filePath());
+    }
+    task->deleteLater();
+
+    if (activeTasks.isEmpty()) {
+        reportProgress();
+        emit ingestionFinished(ingestionCancelled, finishedFiles, finishedBytesIndexed, ingestionTimer.elapsed());
+        ingestionCancelled = false;
+    } else {
+        reportProgress();
+    }
+}
+
+void LogManager::reportProgress() {
+    qint64 bytesDone = finishedBytesRead;
+    qint64 bytesIndexed = finishedBytesIndexed;
+    qint64 linesDone = finishedLines;
+    qint64 bytesTotal = finishedBytesRead;
+    for (IngestTask *task : std::as_const(activeTasks)) {
+        const TaskProgress done = taskProgress.value(task);
+        bytesDone += done.bytesRead;
+        bytesIndexed += done.bytesIndexed;
+        linesDone += done.lines;
+        bytesTotal += qMax(taskSizes.value(task), done.bytesRead);
+    }
+
+    // Throughput is measured in indexed bytes, i.e. decompressed bytes for compressed files
+    double seconds = qMax<qint64>(ingestionTimer.elapsed(), 1) / 1000.0;
+    emit ingestionProgress(bytesDone, bytesTotal, linesDone, bytesIndexed / seconds, linesDone / seconds);
+}
+
+QSharedPointer<LogSource> LogManager::source(const QString &filePath) const {
+    return sources.value(filePath);
+}
+
+void LogManager::releaseSource(const QString &filePath) {
+    auto it = sourceRefs.find(filePath);
+    if (it == sourceRefs.end()) {
+        return;
+    }
+    if (--it.value() <= 0) {
+        sourceRefs.erase(it);
+        sources.remove(filePath);
+        follower.unfollow(filePath);
+    }
+}
+
+bool LogManager::setFollowing(const QString &filePath, bool enabled) {
+    if (!enabled) {
+        follower.unfollow(filePath);
+        return true;
+    }
+
+    QSharedPointer<LogSource> logSource = sources.value(filePath);
+    if (!logSource || !logSource->isIndexComplete() || !logSource->isFollowable()) {
+        return false;
+    }
+    follower.follow(logSource);
+    return true;
+}
 
-    return tempPath;
+bool LogManager::isFollowing(const QString &filePath) const {
+    return follower.isFollowing(filePath);
 }
 
 QVector<QPair<QString, QString>> LogManager::sortLogs(QTextDocument* document, bool ascending) {
@@ -0,0 +1,253 @@
+#include "LogSearch.h"
+#include <algorithm>
+#include <climits>
+#include <cstring>
+
+namespace {
+// Turns the bytes of a line before a match into the column of the match in the decoded line
+qint32 columnOf(const char *lineStart, qint64 length) {
+    const bool ascii = std::all_of(lineStart, lineStart + length, [](char byte) { return (byte & 0x80) == 0; });
+    return static_cast<qint32>(ascii ? length : QString::fromUtf8(lineStart, length).size());
+}
+
+// Appends the matches in bytes holding whole lines, the first of which is firstLine; stops early
+// after limit hits or once the search is not needed anymore. Searching backward, all of the
+// bytes are searched and the last limit hits are kept, last one first
+void scanLines(const char *data, qint64 length, qint64 firstLine, const LineMatcher &matcher, qint64 limit, bool backward,
+               int chunk, const std::atomic<bool> &stop, const std::atomic<int> &firstFull, QVector<LogSearch::Hit> &hits) {
+    auto needed = [&]() { return !stop && firstFull.load() > chunk; };
+    auto room = [&]() {
+        if (backward && hits.size() >= 2 * limit) {
+            hits.remove(0, hits.size() - limit); // Only the last ones are kept, trimmed now and then
+        }
+        return backward || hits.size() < limit;
+    };
+    const TextSearcher &searcher = matcher.literal();
+
+    qint64 line = firstLine;    // Line number of the bytes from counted on
+    qint64 lineStart = 0;       // Offset where that line starts
+    qint64 counted = 0;         // Newlines before this offset are included in line
+    qint64 position = 0;
+    while (room() && needed()) {
+        // Without a literal every line is a candidate
+        const qint64 match = matcher.hasLiteral() ? searcher.indexIn(data, length, position) : (position < length ? position : -1);
+        if (match < 0) {
+            break;
+        }
+        const char *newline;
+        while ((newline = static_cast<const char *>(std::memchr(data + counted, '\n', static_cast<size_t>(match - counted))))) {
+            ++line;
+            counted = newline - data + 1;
+            lineStart = counted;
+        }
+        counted = match;
+
+        if (matcher.isLiteralExact()) {
+            hits.append(LogSearch::Hit{line, columnOf(data + lineStart, match - lineStart), static_cast<qint32>(matcher.textLength())});
+            position = match + searcher.patternLength();
+            continue;
+        }
+
+        // The candidate's line is decoded and matched as a whole
+        newline = static_cast<const char *>(std::memchr(data + match, '\n', static_cast<size_t>(length - match)));
+        const qint64 lineEnd = newline ? newline - data : length;
+        const qint64 textEnd = lineEnd > lineStart && data[lineEnd - 1] == '\r' ? lineEnd - 1 : lineEnd;
+        const QString lineText = QString::fromUtf8(data + lineStart, textEnd - lineStart);
+        qsizetype matchLength = 0;
+        for (qsizetype found = matcher.indexIn(lineText, 0, &matchLength); found >= 0 && room();
+             found = matcher.indexIn(lineText, found + qMax<qsizetype>(matchLength, 1), &matchLength)) {
+            hits.append(LogSearch::Hit{line, static_cast<qint32>(found), static_cast<qint32>(matchLength)});
+            if (found >= lineText.size()) {
+                break; // An empty match at the end of the line
+            }
+        }
+        position = lineEnd + 1;
+    }
+
+    if (backward) {
+        hits.remove(0, qMax<qint64>(0, hits.size() - limit));
+        std::reverse(hits.begin(), hits.end());
+    }
+}
+}
+
+LogSearch::LogSearch(QObject *parent)
+    : LogSearch(nullptr, parent) {}
+
+LogSearch::LogSearch(QThreadPool *sharedPool, QObject *parent)
+    : QObject(parent), pool(sharedPool ? sharedPool : &ownPool), stop(std::make_shared<std::atomic<bool>>(false)),
+      firstFull(std::make_shared<std::atomic<int>>(INT_MAX)), searchedMatcher(QString(), Qt::CaseSensitive, false),
+      completedMatcher(QString(), Qt::CaseSensitive, false) {}
+
+LogSearch::~LogSearch() {
+    stop->store(true);
+    if (pool == &ownPool) {
+        ownPool.clear();
+        ownPool.waitForDone();
+    }
+}
+
+void LogSearch::start(const QSharedPointer<LogSource> &source, const LineMatcher &matcher, qint64 maxHits) {
+    start(source, matcher, 0, -1, Forward, maxHits);
+}
+
+void LogSearch::start(const QSharedPointer<LogSource> &source, const LineMatcher &matcher, qint64 firstLine, qint64 endLine,
+                      Direction direction, qint64 maxHits) {
+    cancel();
+
+    const qint64 lines = source ? source->lineCount() : 0;
+    endLine = endLine < 0 ? lines : qMin(endLine, lines);
+    firstLine = qMax<qint64>(firstLine, 0);
+    const bool backward = direction == Backward;
+    wholeSearch = firstLine == 0 && endLine == lines && !backward;
+
+    // A query narrowing the last complete one only has to look at the lines that one matched
+    const bool refine = wholeSearch && source && completedSource.toStrongRef() == source && completedLineCount == lines
+                        && matcher.narrows(completedMatcher);
+    const QVector<qint64> candidates = refine ? completedLines : QVector<qint64>();
+
+    ++generation;
+    stop = std::make_shared<std::atomic<bool>>(false);
+    firstFull = std::make_shared<std::atomic<int>>(INT_MAX);
+    results.clear();
+    truncated = false;
+    chunkHits.clear();
+    chunksDone = 0;
+    hitsFound = 0;
+    hitLimit = maxHits;
+    searchedSource = source;
+    searchedMatcher = matcher;
+    if (firstLine >= endLine || matcher.isEmpty() || !matcher.isValid() || maxHits <= 0 || (refine && candidates.isEmpty())) {
+        running = true;
+        finish();
+        return;
+    }
+    running = true;
+
+    // One hit more than kept per chunk tells whether the result had to be cut; a range search
+    // only wants its first hits, so a chunk finding them makes the chunks after it unneeded
+    const qint64 limit = wholeSearch ? maxHits + 1 : maxHits;
+    const int searchGeneration = generation;
+    auto report = [this, full = firstFull, limit, searchGeneration](int chunk, QVector<Hit> &&hits) {
+        if (hits.size() >= limit) {
+            int lowest = full->load();
+            while (chunk < lowest && !full->compare_exchange_weak(lowest, chunk)) {}
+        }
+        QMetaObject::invokeMethod(this, [this, searchGeneration, chunk, hits = std::move(hits)]() {
+            onChunkSearched(searchGeneration, chunk, hits);
+        }, Qt::QueuedConnection);
+    };
+
+    if (refine) {
+        // Candidate lines are scattered, so they are read one by one
+        chunkHits.resize((candidates.size() + refineChunkLines - 1) / refineChunkLines);
+        for (int chunk = 0; chunk < chunkHits.size(); ++chunk) {
+            const QVector<qint64> chunkLines = candidates.mid(chunk * refineChunkLines, refineChunkLines);
+            pool->start([source, flag = stop, full = firstFull, matcher, limit, chunk, chunkLines, report]() {
+                QVector<Hit> hits;
+                LogSource::BytesLease lease; // Keeps the mapping scanned alive if a followed file is refreshed meanwhile
+                for (qint64 line : chunkLines) {
+                    const QByteArray bytes = source->lineBytes(line, &lease);
+                    scanLines(bytes.constData(), bytes.size(), line, matcher, limit, false, chunk, *flag, *full, hits);
+                }
+                report(chunk, std::move(hits));
+            });
+        }
+        return;
+    }
+
+    // Chunks start at the line containing every chunkSize-th byte, so no line is split
+    QVector<qint64> boundaries{firstLine};
+    const qint64 endOffset = endLine < lines ? static_cast<qint64>(source->entry(endLine).offset) : source->indexedSize();
+    for (qint64 offset = static_cast<qint64>(source->entry(firstLine).offset) + chunkSize; offset < endOffset; offset += chunkSize) {
+        const qint64 line = source->lineAtOffset(offset);
+        if (line > boundaries.last() && line < endLine) {
+            boundaries.append(line);
+        }
+    }
+    boundaries.append(endLine);
+    chunkHits.resize(boundaries.size() - 1);
+
+    // Searching backward, chunks are numbered from the end, so the ones nearest to endLine come first
+    for (int chunk = 0; chunk < chunkHits.size(); ++chunk) {
+        const int range = backward ? chunkHits.size() - 1 - chunk : chunk;
+        const qint64 chunkFirstLine = boundaries.at(range);
+        const qint64 chunkEndLine = boundaries.at(range + 1);
+        pool->start([source, flag = stop, full = firstFull, matcher, limit, backward, chunk, chunkFirstLine, chunkEndLine, report]() {
+            QVector<Hit> hits;
+            LogSource::BytesLease lease; // Keeps the mapping scanned alive if a followed file is refreshed meanwhile
+            const QByteArray bytes = source->linesBytes(chunkFirstLine, chunkEndLine, &lease);
+            scanLines(bytes.constData(), bytes.size(), chunkFirstLine, matcher, limit, backward, chunk, *flag, *full, hits);
+            report(chunk, std::move(hits));
+        });
+    }
+}
+
+void LogSearch::cancel() {
+    if (!running) {
+        return;
+    }
+    stop->store(true);
+    if (pool == &ownPool) {
+        ownPool.clear(); // Tasks of a shared pool may belong to other searches, its owner clears it
+    }
+    ++generation; // Workers still running report to a search that is over
+    chunkHits.clear();
+    searchedSource.reset();
+    running = false;
+    emit finished(true);
+}
+
+bool LogSearch::isRunning() const {
+    return running;
+}
+
+const QVector<LogSearch::Hit> &LogSearch::hits() const {
+    return results;
+}
+
+bool LogSearch::isTruncated() const {
+    return truncated;
+}
+
+void LogSearch::onChunkSearched(int searchGeneration, int chunk, const QVector<Hit> &hits) {
+    if (searchGeneration != generation) {
+        return;
+    }
+    chunkHits[chunk] = hits;
+    ++chunksDone;
+    hitsFound += hits.size();
+    emit progress(chunksDone, chunkHits.size(), qMin(hitsFound, hitLimit));
+    if (chunksDone == chunkHits.size()) {
+        finish();
+    }
+}
+
+void LogSearch::finish() {
+    // Chunks are in search order, so concatenating them keeps the hits sorted
+    for (const QVector<Hit> &found : std::as_const(chunkHits)) {
+        results.append(found.mid(0, hitLimit + 1 - results.size()));
+        if (results.size() > hitLimit) {
+            break;
+        }
+    }
+    truncated = results.size() > hitLimit;
+    results.resize(qMin<qint64>(results.size(), hitLimit));
+    chunkHits.clear();
+
+    // Only a complete result over all lines can be narrowed down by the next query
+    if (!truncated && wholeSearch && searchedSource) {
+        completedSource = searchedSource;
+        completedLineCount = searchedSource->lineCount();
+        completedMatcher = searchedMatcher;
+        completedLines.clear();
+        for (const Hit &hit : std::as_const(results)) {
+            if (completedLines.isEmpty() || completedLines.last() != hit.line) {
+                completedLines.append(hit.line);
+            }
+        }
+    }
+    searchedSource.reset();
+    running = false;
+    emit finished(false);
+}
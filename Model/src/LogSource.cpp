@@ -0,0 +1,304 @@
+#include "LogSource.h"
+#include <QReadLocker>
+#include <QWriteLocker>
+#include <algorithm>
+#include "MappedLogSource.h"
+#include "CompressedLogSource.h"
+
+namespace {
+const qint64 previewLimit = 1024 * 1024; // Most bytes previewLines() looks at
+}
+
+QSharedPointer<LogSource> LogSource::create(const QString &filePath) {
+    if (CompressedLogSource::isCompressed(filePath)) {
+        return QSharedPointer<LogSource>(new CompressedLogSource(filePath));
+    }
+    return QSharedPointer<LogSource>(new MappedLogSource(filePath));
+}
+
+LogSource::LogSource(const QString &filePath) : path(filePath) {}
+
+LogSource::~LogSource() {}
+
+LogSource::RefreshResult LogSource::refresh(qint64 &firstChangedLine) {
+    firstChangedLine = 0;
+    return Unchanged;
+}
+
+void LogSource::startFollowing() {}
+
+bool LogSource::isFollowable() const {
+    return false;
+}
+
+QByteArray LogSource::readLine(qint64 offset, qint64 length, BytesLease *lease) const {
+    QByteArray bytes = readRange(offset, length, lease);
+    if (bytes.endsWith('\n')) {
+        bytes.chop(1);
+    }
+    if (bytes.endsWith('\r')) {
+        bytes.chop(1);
+    }
+    return bytes;
+}
+
+QByteArray LogSource::readAhead(qint64 offset, qint64 length) const {
+    Q_UNUSED(offset);
+    Q_UNUSED(length);
+    return QByteArray();
+}
+
+qint64 LogSource::expectedSize() const {
+    return dataSize;
+}
+
+void LogSource::clearIndex(qint64 expectedSize) {
+    QWriteLocker locker(&lock);
+    lineOffsets.clear();
+    timestamps.clear();
+    latestByBlock.clear();
+    longest = 0;
+    sorted = true;
+    lastTimestamp = TimestampParser::NoTimestamp;
+    indexComplete = false;
+
+    // Rough guess of 100 bytes per line keeps reallocations rare; capped so that a batch of
+    // files indexed in parallel does not reserve far more than it ends up using
+    lineOffsets.reserve(qMin<qint64>(expectedSize / 100 + 1, 1 << 20));
+    timestamps.reserve(lineOffsets.capacity());
+}
+
+qint64 LogSource::appendChunk(const QVector<quint64> &chunkOffsets, const QVector<qint64> &chunkTimestamps, qint64 longestLine, bool complete) {
+    bool chunkSorted = true;
+    for (qint64 timestamp : chunkTimestamps) {
+        if (timestamp != TimestampParser::NoTimestamp) {
+            if (lastTimestamp != TimestampParser::NoTimestamp && timestamp < lastTimestamp) {
+                chunkSorted = false;
+            }
+            lastTimestamp = timestamp;
+        }
+    }
+
+    QWriteLocker locker(&lock);
+    const qint64 firstNewLine = timestamps.size();
+    lineOffsets.append(chunkOffsets);
+    timestamps.append(chunkTimestamps);
+    updateTimeLookup(firstNewLine);
+    indexComplete = complete;
+    longest = longestLine;
+    sorted = sorted && chunkSorted;
+    return completeLineCount();
+}
+
+QString LogSource::filePath() const {
+    return path;
+}
+
+QString LogSource::errorString() const {
+    return error;
+}
+
+qint64 LogSource::size() const {
+    QReadLocker locker(&lock);
+    return dataSize;
+}
+
+qint64 LogSource::indexedSize() const {
+    QReadLocker locker(&lock);
+    if (indexComplete) {
+        return dataSize;
+    }
+    return lineOffsets.isEmpty() ? 0 : static_cast<qint64>(lineOffsets.last());
+}
+
+bool LogSource::isIndexComplete() const {
+    QReadLocker locker(&lock);
+    return indexComplete;
+}
+
+qint64 LogSource::lineCount() const {
+    QReadLocker locker(&lock);
+    return completeLineCount();
+}
+
+qint64 LogSource::estimatedLineCount() const {
+    QReadLocker locker(&lock);
+    const qint64 lines = completeLineCount();
+    if (indexComplete || lines == 0) {
+        return lines;
+    }
+    // While indexing, the offset after the complete lines starts the line being scanned
+    const qint64 indexed = static_cast<qint64>(lineOffsets.at(lines));
+    if (indexed == 0) {
+        return lines;
+    }
+    return qMax(lines, static_cast<qint64>(static_cast<double>(lines) * expectedSize() / indexed));
+}
+
+qint64 LogSource::longestLine() const {
+    QReadLocker locker(&lock);
+    return longest;
+}
+
+qint64 LogSource::completeLineCount() const {
+    // While indexing, the last offset belongs to a line whose terminator was not seen yet
+    if (indexComplete) {
+        return lineOffsets.size();
+    }
+    return qMax<qint64>(0, lineOffsets.size() - 1);
+}
+
+qint64 LogSource::timestamp(qint64 line) const {
+    QReadLocker locker(&lock);
+    if (line < 0 || line >= completeLineCount()) {
+        return TimestampParser::NoTimestamp;
+    }
+    return timestamps.at(line);
+}
+
+bool LogSource::timestampsSorted() const {
+    QReadLocker locker(&lock);
+    return sorted;
+}
+
+qint64 LogSource::lineAtTimestamp(qint64 timestamp) const {
+    QReadLocker locker(&lock);
+    auto block = std::lower_bound(latestByBlock.cbegin(), latestByBlock.cend(), timestamp);
+    if (block == latestByBlock.cend()) {
+        return -1;
+    }
+
+    // The first block reaching the time holds the first line that does
+    const qint64 first = (block - latestByBlock.cbegin()) * timeBlockLines;
+    const qint64 end = qMin(first + timeBlockLines, completeLineCount());
+    for (qint64 line = first; line < end; ++line) {
+        if (timestamps.at(line) >= timestamp) {
+            return line;
+        }
+    }
+    return -1;
+}
+
+void LogSource::updateTimeLookup(qint64 fromLine) {
+    // The block fromLine falls into is recomputed, as it may have been partial
+    const qint64 firstBlock = qMin<qint64>(qMax<qint64>(fromLine, 0) / timeBlockLines, latestByBlock.size());
+    latestByBlock.resize(firstBlock);
+    qint64 latest = firstBlock > 0 ? latestByBlock.last() : TimestampParser::NoTimestamp;
+    for (qint64 line = firstBlock * timeBlockLines; line < timestamps.size(); ++line) {
+        latest = qMax(latest, timestamps.at(line));
+        if ((line + 1) % timeBlockLines == 0 || line + 1 == timestamps.size()) {
+            latestByBlock.append(latest);
+        }
+    }
+}
+
+bool LogSource::isRestoredFromCache() const {
+    return restoredFromCache;
+}
+
+QByteArray LogSource::lineBytes(qint64 line, BytesLease *lease) const {
+    qint64 start;
+    qint64 end;
+    {
+        QReadLocker locker(&lock);
+        if (line < 0 || line >= completeLineCount()) {
+            return QByteArray();
+        }
+        start = static_cast<qint64>(lineOffsets.at(line));
+        end = line + 1 < lineOffsets.size() ? static_cast<qint64>(lineOffsets.at(line + 1)) : dataSize;
+    }
+
+    return readLine(start, end - start, lease);
+}
+
+QByteArray LogSource::linesBytes(qint64 firstLine, qint64 endLine, BytesLease *lease) const {
+    qint64 start;
+    qint64 end;
+    {
+        QReadLocker locker(&lock);
+        endLine = qMin(endLine, completeLineCount());
+        if (firstLine < 0 || firstLine >= endLine) {
+            return QByteArray();
+        }
+        start = static_cast<qint64>(lineOffsets.at(firstLine));
+        end = endLine < lineOffsets.size() ? static_cast<qint64>(lineOffsets.at(endLine)) : dataSize;
+    }
+    return readRange(start, end - start, lease);
+}
+
+qint64 LogSource::lineAtOffset(qint64 offset) const {
+    QReadLocker locker(&lock);
+    const qint64 lines = completeLineCount();
+    if (lines == 0) {
+        return 0;
+    }
+    auto it = std::upper_bound(lineOffsets.cbegin(), lineOffsets.cbegin() + lines, static_cast<quint64>(qMax<qint64>(offset, 0)));
+    return qMax<qint64>(0, (it - lineOffsets.cbegin()) - 1);
+}
+
+QString LogSource::lineText(qint64 line) const {
+    return QString::fromUtf8(lineBytes(line));
+}
+
+QStringList LogSource::lineTexts(qint64 firstLine, qint64 count) const {
+    QStringList lines;
+    qint64 end = qMin(firstLine + count, lineCount());
+    for (qint64 line = qMax<qint64>(firstLine, 0); line < end; ++line) {
+        lines.append(lineText(line));
+    }
+    return lines;
+}
+
+QStringList LogSource::previewLines(qint64 offset, qint64 count) const {
+    QStringList lines;
+    // The byte before offset tells whether offset starts a line
+    const qint64 start = qMax<qint64>(0, offset - 1);
+    const qint64 length = qMin(qMin((longestLine() + 1) * (count + 1), previewLimit), size() - start);
+    if (count <= 0 || length <= 0) {
+        return lines;
+    }
+    const QByteArray bytes = readAhead(start, length);
+
+    qint64 position = 0;
+    if (offset > 0) {
+        position = bytes.indexOf('\n') + 1;
+        if (position == 0) {
+            return lines; // Inside a line longer than what was looked at
+        }
+    }
+    while (lines.size() < count && position < bytes.size()) {
+        qint64 end = bytes.indexOf('\n', position);
+        if (end < 0) {
+            end = bytes.size();
+        }
+        const qint64 textEnd = end > position && bytes.at(end - 1) == '\r' ? end - 1 : end;
+        lines.append(QString::fromUtf8(bytes.constData() + position, textEnd - position));
+        position = end + 1;
+    }
+    return lines;
+}
+
+LogEntry LogSource::entry(qint64 line) const {
+    QReadLocker locker(&lock);
+    LogEntry logEntry;
+    if (line >= 0 && line < completeLineCount()) {
+        logEntry.line = line;
+        logEntry.offset = lineOffsets.at(line);
+        logEntry.timestamp = timestamps.at(line);
+    }
+    return logEntry;
+}
+
+QString LogSource::text(qint64 firstLine) const {
+    qint64 start;
+    qint64 end;
+    {
+        QReadLocker locker(&lock);
+        if (firstLine < 0 || firstLine >= completeLineCount()) {
+            return QString();
+        }
+        start = static_cast<qint64>(lineOffsets.at(firstLine));
+        end = indexComplete ? dataSize : static_cast<qint64>(lineOffsets.last());
+    }
+    return QString::fromUtf8(readRange(start, end - start, nullptr));
+}
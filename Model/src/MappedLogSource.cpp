@@ -0,0 +1,443 @@
+#include "MappedLogSource.h"
+#include <QObject>
+#include <QReadLocker>
+#include <QMutexLocker>
+#include <QWriteLocker>
+#include <QFileInfo>
+#include <QDateTime>
+#include "LineScanner.h"
+#include "IndexCache.h"
+
+namespace {
+const qint64 indexChunkSize = 8 * 1024 * 1024; // Bytes scanned between two progress reports
+const qint64 firstChunkSize = 256 * 1024;       // Bytes scanned before the first report, enough for the first screens
+}
+
+MappedLogSource::Mapping::~Mapping() {
+    if (data) {
+        file.unmap(const_cast<uchar *>(data));
+    }
+    file.close();
+}
+
+QByteArray MappedLogSource::Mapping::read(qint64 offset, qint64 length) {
+    if (data) {
+        return QByteArray::fromRawData(reinterpret_cast<const char *>(data) + offset, length);
+    }
+    QMutexLocker locker(&readMutex);
+    if (length <= 0 || !file.seek(offset)) {
+        return QByteArray();
+    }
+    return file.read(length);
+}
+
+MappedLogSource::MappedLogSource(const QString &filePath) : LogSource(filePath), containerPath(filePath) {}
+
+MappedLogSource::MappedLogSource(const QString &filePath, const QString &containerPath, qint64 offset, qint64 length)
+    : LogSource(filePath), containerPath(containerPath), rangeOffset(offset), rangeLength(length) {}
+
+MappedLogSource::~MappedLogSource() {}
+
+bool MappedLogSource::open() {
+    std::shared_ptr<Mapping> opened = mapFile(rangeOffset, rangeLength);
+    if (!opened) {
+        return false;
+    }
+
+    QWriteLocker locker(&lock);
+    mapping = opened;
+    dataSize = mapping->size;
+    return true;
+}
+
+std::shared_ptr<MappedLogSource::Mapping> MappedLogSource::mapFile(qint64 offset, qint64 length, bool map) {
+    std::shared_ptr<Mapping> mapped = std::make_shared<Mapping>();
+    mapped->file.setFileName(containerPath);
+    if (!mapped->file.open(QIODevice::ReadOnly)) {
+        error = mapped->file.errorString();
+        return nullptr;
+    }
+
+    // The size is taken first: a write in between then shows as a size change to refresh()
+    mapped->size = length < 0 ? mapped->file.size() - offset : length;
+    mapped->modified = QFileInfo(mapped->file).lastModified().toMSecsSinceEpoch();
+    if (offset + mapped->size > mapped->file.size()) {
+        error = QObject::tr("The data extends past the end of the file.");
+        return nullptr;
+    }
+    if (mapped->size == 0 || !map) {
+        return mapped; // Nothing to map, the source simply has no lines, or is read instead
+    }
+
+    mapped->data = mapped->file.map(offset, mapped->size);
+    if (!mapped->data) {
+        error = QObject::tr("Unable to map file into memory: %1").arg(mapped->file.errorString());
+        return nullptr;
+    }
+    return mapped;
+}
+
+bool MappedLogSource::buildIndex(const ProgressCallback &progress) {
+    if (!mapping) {
+        error = QObject::tr("File is not open.");
+        return false;
+    }
+
+    rememberHead(mapping->read(0, qMin(IndexCache::headTailSize, dataSize))); // Before the index completes and can be followed
+    restoredFromCache = false;
+    qint64 resumeFrom = 0;
+    if (restoreFromCache(resumeFrom) && resumeFrom == dataSize) {
+        if (progress) {
+            progress(dataSize, dataSize, lineCount());
+        }
+        return true; // Unchanged since it was last indexed
+    }
+
+    if (!restoredFromCache) {
+        resetIndex();
+    }
+    if (!scanFrom(resumeFrom, progress)) {
+        return false;
+    }
+
+    saveToCache();
+    return true;
+}
+
+LogSource::RefreshResult MappedLogSource::refresh(qint64 &firstChangedLine) {
+    firstChangedLine = 0;
+    if (!mapping || !isIndexComplete() || !isFollowable()) {
+        return Unchanged;
+    }
+    startFollowing();
+
+    QFileInfo fileInfo(containerPath);
+    if (!fileInfo.exists() || (fileInfo.size() == dataSize && fileInfo.lastModified().toMSecsSinceEpoch() == mapping->modified)) {
+        return Unchanged; // Nothing new, or rotated away and not recreated yet
+    }
+
+    // Reopen by path: after a rename the old handle would keep pointing at the rotated file.
+    // Readers keep using the old file and index until the new ones are published
+    std::shared_ptr<Mapping> reopened = mapFile(0, -1, false);
+    if (!reopened) {
+        publish(std::make_shared<Mapping>(), 0, Scan());
+        rememberHead(QByteArray());
+        return Reset;
+    }
+
+    // The head is compared with its hash from indexing time, the file may have been rewritten in place since
+    const qint64 oldSize = dataSize;
+    const QByteArray head = reopened->read(0, qMin(IndexCache::headTailSize, reopened->size));
+    const bool sameHead = head.size() >= headLength
+                          && IndexCache::hash(reinterpret_cast<const uchar *>(head.constData()), headLength) == headHash;
+    Scan scan;
+    if (reopened->size <= oldSize || !sameHead) {
+        // Truncated, rewritten at the same size or replaced by a new file
+        if (!scanMapping(*reopened, 0, 0, scan)) {
+            return Unchanged; // Changed again while scanned, the next refresh starts over
+        }
+        publish(reopened, 0, scan);
+        rememberHead(head);
+        return Reset;
+    }
+
+    // The last indexed line may have grown, so it is rescanned from its start
+    const bool lastLineTerminated = oldSize == 0 || reopened->read(oldSize - 1, 1) == "\n";
+    qint64 oldLineCount;
+    qint64 lastLineStart;
+    qint64 longestSoFar;
+    {
+        QReadLocker locker(&lock);
+        oldLineCount = lineOffsets.size();
+        lastLineStart = lineOffsets.isEmpty() ? 0 : static_cast<qint64>(lineOffsets.last());
+        longestSoFar = longest;
+    }
+    if (!scanMapping(*reopened, lastLineStart, longestSoFar, scan)) {
+        return Unchanged;
+    }
+    publish(reopened, qMax<qint64>(0, oldLineCount - 1), scan);
+    rememberHead(head);
+    firstChangedLine = lastLineTerminated ? oldLineCount : qMax<qint64>(0, oldLineCount - 1);
+    return Appended;
+}
+
+void MappedLogSource::startFollowing() {
+    if (following || !isFollowable()) {
+        return;
+    }
+    following = true;
+
+    // The mapping goes away with the last lease on it; the index still describes the file as mapped
+    std::shared_ptr<Mapping> reader = mapFile(0, -1, false);
+    if (!reader) {
+        return; // Deleted, so no rotation can truncate the mapped file by its path any more
+    }
+    QWriteLocker locker(&lock);
+    reader->size = mapping->size;
+    reader->modified = mapping->modified;
+    mapping = reader;
+}
+
+void MappedLogSource::rememberHead(const QByteArray &head) {
+    headHash = IndexCache::hash(reinterpret_cast<const uchar *>(head.constData()), head.size());
+    headLength = head.size();
+}
+
+bool MappedLogSource::isFollowable() const {
+    return rangeLength < 0; // The archive a range belongs to is rewritten as a whole
+}
+
+qint64 MappedLogSource::inputSize() const {
+    return size();
+}
+
+QByteArray MappedLogSource::readAhead(qint64 offset, qint64 length) const {
+    return readRange(offset, length, nullptr);
+}
+
+QByteArray MappedLogSource::readRange(qint64 offset, qint64 length, BytesLease *lease) const {
+    QReadLocker locker(&lock); // Guards the mapping against a concurrent refresh()
+    if (!mapping || offset < 0 || offset + length > mapping->size) {
+        return QByteArray();
+    }
+    if (lease) {
+        *lease = mapping;
+    }
+    return mapping->read(offset, length);
+}
+
+QByteArray MappedLogSource::readLine(qint64 offset, qint64 length, BytesLease *lease) const {
+    QReadLocker locker(&lock);
+    if (!mapping || offset < 0 || offset + length > mapping->size) {
+        return QByteArray();
+    }
+    if (lease) {
+        *lease = mapping;
+    }
+    if (!mapping->data) {
+        QByteArray bytes = mapping->read(offset, length);
+        if (bytes.endsWith('\n')) {
+            bytes.chop(1);
+        }
+        if (bytes.endsWith('\r')) {
+            bytes.chop(1);
+        }
+        return bytes;
+    }
+
+    // Strip "\n" or "\r\n" before wrapping the bytes, truncating a raw-data array would deep-copy it
+    const char *line = reinterpret_cast<const char *>(mapping->data) + offset;
+    if (length > 0 && line[length - 1] == '\n') {
+        --length;
+    }
+    if (length > 0 && line[length - 1] == '\r') {
+        --length;
+    }
+    return QByteArray::fromRawData(line, length);
+}
+
+bool MappedLogSource::scanMapping(Mapping &mapping, qint64 lineStart, qint64 longestSoFar, Scan &scan) {
+    scan = Scan();
+    scan.longest = longestSoFar;
+    if (lineStart >= mapping.size) {
+        return true;
+    }
+
+    // Every chunk is read along with the bytes the timestamp of a line starting at its end may take
+    const qint64 lookahead = TimestampParser::maxLength;
+    const QByteArray first = mapping.read(lineStart, qMin(lookahead, mapping.size - lineStart));
+    scan.lineOffsets.append(static_cast<quint64>(lineStart));
+    scan.timestamps.append(TimestampParser::parse(first.constData(), first.size()));
+
+    LineScanner scanner;
+    QVector<quint64> streamOffsets;
+    for (qint64 chunkStart = lineStart; chunkStart < mapping.size; chunkStart += indexChunkSize) {
+        const qint64 chunkLength = qMin(indexChunkSize, mapping.size - chunkStart);
+        const qint64 readLength = qMin(chunkLength + lookahead, mapping.size - chunkStart);
+        const QByteArray bytes = mapping.read(chunkStart, readLength);
+        if (bytes.size() < readLength) {
+            return false;
+        }
+
+        streamOffsets.clear();
+        scanner.scanBuffer(bytes.constData(), chunkLength, streamOffsets);
+        for (quint64 streamOffset : std::as_const(streamOffsets)) {
+            const qint64 offset = lineStart + static_cast<qint64>(streamOffset);
+            if (offset == mapping.size) {
+                continue; // A trailing newline does not start another line
+            }
+            const qint64 position = offset - chunkStart;
+            scan.lineOffsets.append(static_cast<quint64>(offset));
+            scan.timestamps.append(TimestampParser::parse(bytes.constData() + position, qMin(lookahead, readLength - position)));
+        }
+    }
+    scanner.finish();
+    scan.longest = qMax(longestSoFar, scanner.longestLine());
+    return true;
+}
+
+void MappedLogSource::publish(const std::shared_ptr<Mapping> &remapped, qint64 firstLine, const Scan &scan) {
+    QWriteLocker locker(&lock);
+    mapping = remapped; // The previous mapping goes away with the last lease on it
+    dataSize = mapping->size;
+
+    lineOffsets.resize(firstLine);
+    timestamps.resize(firstLine);
+    lineOffsets.append(scan.lineOffsets);
+    timestamps.append(scan.timestamps);
+    updateTimeLookup(firstLine);
+    longest = scan.longest;
+    indexComplete = true;
+
+    if (firstLine == 0) {
+        sorted = true;
+    }
+    lastTimestamp = TimestampParser::NoTimestamp;
+    for (qint64 i = firstLine - 1; i >= 0 && lastTimestamp == TimestampParser::NoTimestamp; --i) {
+        lastTimestamp = timestamps.at(i);
+    }
+    for (qint64 i = firstLine; i < timestamps.size(); ++i) {
+        const qint64 timestamp = timestamps.at(i);
+        if (timestamp != TimestampParser::NoTimestamp) {
+            if (lastTimestamp != TimestampParser::NoTimestamp && timestamp < lastTimestamp) {
+                sorted = false;
+            }
+            lastTimestamp = timestamp;
+        }
+    }
+}
+
+void MappedLogSource::resetIndex() {
+    clearIndex(dataSize);
+    if (dataSize == 0) {
+        QWriteLocker locker(&lock);
+        indexComplete = true;
+        return;
+    }
+
+    const qint64 firstTimestamp = parseTimestamp(0);
+    QWriteLocker locker(&lock);
+    lineOffsets.append(0);
+    timestamps.append(firstTimestamp);
+    updateTimeLookup(0);
+    lastTimestamp = firstTimestamp;
+}
+
+qint64 MappedLogSource::resumeAtLastLine() {
+    QWriteLocker locker(&lock);
+    // The last indexed line may have grown, so it is rescanned from its start
+    qint64 resumeFrom = static_cast<qint64>(lineOffsets.last());
+    timestamps.last() = parseTimestamp(resumeFrom);
+    updateTimeLookup(timestamps.size() - 1);
+    lastTimestamp = TimestampParser::NoTimestamp;
+    for (qint64 i = timestamps.size() - 1; i >= 0 && lastTimestamp == TimestampParser::NoTimestamp; --i) {
+        lastTimestamp = timestamps.at(i);
+    }
+    return resumeFrom;
+}
+
+bool MappedLogSource::scanFrom(qint64 resumeFrom, const ProgressCallback &progress) {
+    if (dataSize == 0) {
+        return true;
+    }
+
+    LineScanner scanner(reinterpret_cast<const char *>(mapping->data), dataSize);
+    scanner.resume(resumeFrom, longest);
+    QVector<quint64> chunkOffsets;
+    QVector<qint64> chunkTimestamps;
+    qint64 chunkStart = resumeFrom;
+
+    // A small first chunk gets the file on screen before the bulk of it is scanned
+    qint64 chunkSize = firstChunkSize;
+    while (chunkStart < dataSize) {
+        qint64 chunkEnd = qMin(chunkStart + chunkSize, dataSize);
+        chunkSize = indexChunkSize;
+
+        chunkOffsets.clear();
+        chunkTimestamps.clear();
+        scanner.scan(chunkStart, chunkEnd, chunkOffsets);
+        for (quint64 offset : std::as_const(chunkOffsets)) {
+            chunkTimestamps.append(parseTimestamp(static_cast<qint64>(offset)));
+        }
+
+        qint64 lines = appendChunk(chunkOffsets, chunkTimestamps, scanner.longestLine(), chunkEnd == dataSize);
+
+        chunkStart = chunkEnd;
+        if (progress && !progress(chunkEnd, chunkEnd, lines)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+qint64 MappedLogSource::parseTimestamp(qint64 offset) const {
+    return TimestampParser::parse(reinterpret_cast<const char *>(mapping->data) + offset, qMin(TimestampParser::maxLength, dataSize - offset));
+}
+
+bool MappedLogSource::restoreFromCache(qint64 &resumeFrom) {
+    if (dataSize < IndexCache::minimumFileSize) {
+        return false;
+    }
+
+    IndexCache::Entry entry;
+    if (!IndexCache::load(filePath(), entry) || entry.lineOffsets.isEmpty()) {
+        return false;
+    }
+
+    // The first and last bytes the cache was built from must still be where they were
+    const uchar *data = mapping->data;
+    const qint64 cachedSize = static_cast<qint64>(entry.fileSize);
+    const qint64 hashLength = qMin(IndexCache::headTailSize, cachedSize);
+    if (cachedSize > dataSize
+        || IndexCache::hash(data, hashLength) != entry.headHash
+        || IndexCache::hash(data + cachedSize - hashLength, hashLength) != entry.tailHash) {
+        return false;
+    }
+
+    bool unchanged = cachedSize == dataSize && entry.modified == mapping->modified;
+    if (cachedSize == dataSize && !unchanged) {
+        return false; // Same size but rewritten, the middle cannot be trusted
+    }
+
+    QWriteLocker locker(&lock);
+    lineOffsets = std::move(entry.lineOffsets);
+    timestamps = std::move(entry.timestamps);
+    updateTimeLookup(0);
+    longest = entry.longestLine;
+    sorted = entry.timestampsSorted;
+    restoredFromCache = true;
+
+    if (unchanged) {
+        indexComplete = true;
+        resumeFrom = dataSize;
+        return true;
+    }
+
+    locker.unlock();
+    resumeFrom = resumeAtLastLine(); // Appended to since it was cached
+    return true;
+}
+
+void MappedLogSource::saveToCache() const {
+    if (dataSize < IndexCache::minimumFileSize) {
+        return;
+    }
+
+    const uchar *data = mapping->data;
+    const qint64 hashLength = qMin(IndexCache::headTailSize, dataSize);
+    IndexCache::Entry entry;
+    entry.filePath = filePath();
+    entry.fileSize = static_cast<quint64>(dataSize);
+    entry.textSize = entry.fileSize;
+    entry.modified = mapping->modified;
+    entry.headHash = IndexCache::hash(data, hashLength);
+    entry.tailHash = IndexCache::hash(data + dataSize - hashLength, hashLength);
+    {
+        QReadLocker locker(&lock);
+        entry.longestLine = longest;
+        entry.timestampsSorted = sorted;
+        entry.lineOffsets = lineOffsets; // Implicitly shared, no copy
+        entry.timestamps = timestamps;
+    }
+    IndexCache::save(entry);
+}
@@ -0,0 +1,51 @@
+#include "RangeDevice.h"
+
+RangeDevice::RangeDevice(QIODevice *base, qint64 offset, qint64 length, QObject *parent)
+    : QIODevice(parent), base(base), offset(offset), length(length) {}
+
+bool RangeDevice::open(OpenMode mode) {
+    if ((mode & ReadWrite) != ReadOnly) {
+        setErrorString(tr("RangeDevice is read-only."));
+        return false;
+    }
+    // Unbuffered: base is shared with nobody, but reads go straight to its position anyway
+    return QIODevice::open(mode | Unbuffered);
+}
+
+bool RangeDevice::isSequential() const {
+    return false;
+}
+
+qint64 RangeDevice::size() const {
+    return length;
+}
+
+bool RangeDevice::seek(qint64 pos) {
+    if (pos < 0 || pos > length) {
+        return false;
+    }
+    return QIODevice::seek(pos);
+}
+
+qint64 RangeDevice::readData(char *data, qint64 maxSize) {
+    const qint64 position = pos();
+    const qint64 wanted = qMin(maxSize, length - position);
+    if (wanted <= 0) {
+        return 0;
+    }
+    if (!base->seek(offset + position)) {
+        setErrorString(base->errorString());
+        return -1;
+    }
+    const qint64 read = base->read(data, wanted);
+    if (read < 0) {
+        setErrorString(base->errorString());
+    }
+    return read;
+}
+
+qint64 RangeDevice::writeData(const char *data, qint64 maxSize) {
+    Q_UNUSED(data);
+    Q_UNUSED(maxSize);
+    return -1;
+}
@@ -0,0 +1,192 @@
+#include "TextSearcher.h"
+#include <cstring>
+#include "LineScanner.h"
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define LOGZ_X86_SIMD
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#endif
+
+#if defined(__GNUC__) || defined(__clang__)
+#define LOGZ_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define LOGZ_TARGET_AVX2
+#endif
+
+namespace {
+inline char foldCase(char byte) {
+    return (byte >= 'A' && byte <= 'Z') ? static_cast<char>(byte - 'A' + 'a') : byte;
+}
+
+inline char upperCase(char byte) {
+    return (byte >= 'a' && byte <= 'z') ? static_cast<char>(byte - 'a' + 'A') : byte;
+}
+
+#ifdef LOGZ_X86_SIMD
+inline int countTrailingZeros(quint32 mask) {
+#if defined(_MSC_VER) && !defined(__clang__)
+    unsigned long index;
+    _BitScanForward(&index, mask);
+    return static_cast<int>(index);
+#else
+    return __builtin_ctz(mask);
+#endif
+}
+
+// Compares the bytes between the first and the last byte of a candidate, folding ASCII letters if needed
+template <bool folded>
+inline bool middleMatches(const char *data, const char *needle, qint64 size) {
+    if (!folded) {
+        return std::memcmp(data + 1, needle + 1, static_cast<size_t>(size - 2)) == 0;
+    }
+    for (qint64 j = 1; j < size - 1; ++j) {
+        if (foldCase(data[j]) != needle[j]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Candidates are positions where both the first and the last byte of the needle match, 16 or
+// 32 at a time, in either case if folded; only those are compared in full. Returns the first
+// match, or the position the caller has to continue at with a scalar search in *resume.
+template <bool folded>
+qint64 findSse2(const char *data, qint64 length, qint64 from, const char *needle, qint64 size, qint64 *resume) {
+    const __m128i first = _mm_set1_epi8(needle[0]);
+    const __m128i last = _mm_set1_epi8(needle[size - 1]);
+    const __m128i firstUpper = _mm_set1_epi8(upperCase(needle[0]));
+    const __m128i lastUpper = _mm_set1_epi8(upperCase(needle[size - 1]));
+    qint64 i = from;
+    for (; i + size - 1 + 16 <= length; i += 16) {
+        const __m128i blockFirst = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + i));
+        const __m128i blockLast = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + i + size - 1));
+        __m128i firstEqual = _mm_cmpeq_epi8(blockFirst, first);
+        __m128i lastEqual = _mm_cmpeq_epi8(blockLast, last);
+        if (folded) {
+            firstEqual = _mm_or_si128(firstEqual, _mm_cmpeq_epi8(blockFirst, firstUpper));
+            lastEqual = _mm_or_si128(lastEqual, _mm_cmpeq_epi8(blockLast, lastUpper));
+        }
+        quint32 mask = static_cast<quint32>(_mm_movemask_epi8(_mm_and_si128(firstEqual, lastEqual)));
+        while (mask) {
+            const qint64 candidate = i + countTrailingZeros(mask);
+            if (middleMatches<folded>(data + candidate, needle, size)) {
+                return candidate;
+            }
+            mask &= mask - 1;
+        }
+    }
+    *resume = i;
+    return -1;
+}
+
+template <bool folded>
+LOGZ_TARGET_AVX2 qint64 findAvx2(const char *data, qint64 length, qint64 from, const char *needle, qint64 size, qint64 *resume) {
+    const __m256i first = _mm256_set1_epi8(needle[0]);
+    const __m256i last = _mm256_set1_epi8(needle[size - 1]);
+    const __m256i firstUpper = _mm256_set1_epi8(upperCase(needle[0]));
+    const __m256i lastUpper = _mm256_set1_epi8(upperCase(needle[size - 1]));
+    qint64 i = from;
+    for (; i + size - 1 + 32 <= length; i += 32) {
+        const __m256i blockFirst = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + i));
+        const __m256i blockLast = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + i + size - 1));
+        __m256i firstEqual = _mm256_cmpeq_epi8(blockFirst, first);
+        __m256i lastEqual = _mm256_cmpeq_epi8(blockLast, last);
+        if (folded) {
+            firstEqual = _mm256_or_si256(firstEqual, _mm256_cmpeq_epi8(blockFirst, firstUpper));
+            lastEqual = _mm256_or_si256(lastEqual, _mm256_cmpeq_epi8(blockLast, lastUpper));
+        }
+        quint32 mask = static_cast<quint32>(_mm256_movemask_epi8(_mm256_and_si256(firstEqual, lastEqual)));
+        while (mask) {
+            const qint64 candidate = i + countTrailingZeros(mask);
+            if (middleMatches<folded>(data + candidate, needle, size)) {
+                return candidate;
+            }
+            mask &= mask - 1;
+        }
+    }
+    return findSse2<folded>(data, length, i, needle, size, resume);
+}
+
+// Runs the kernel selected for this CPU; returns -1 with *resume at from if there is none
+template <bool folded>
+qint64 findVectorized(const char *data, qint64 length, qint64 from, const char *needle, qint64 size, qint64 *resume) {
+    *resume = from;
+    switch (LineScanner::kernel()) {
+    case LineScanner::AVX2:
+        return findAvx2<folded>(data, length, from, needle, size, resume);
+    case LineScanner::SSE2:
+        return findSse2<folded>(data, length, from, needle, size, resume);
+    default:
+        return -1;
+    }
+}
+#endif
+}
+
+TextSearcher::TextSearcher(const QString &pattern, Qt::CaseSensitivity caseSensitivity)
+    : needle(pattern.toUtf8()), caseSensitivity(caseSensitivity) {
+    if (caseSensitivity == Qt::CaseInsensitive) {
+        for (char &byte : needle) {
+            byte = foldCase(byte);
+        }
+    } else {
+        matcher.setPattern(needle);
+    }
+}
+
+bool TextSearcher::isEmpty() const {
+    return needle.isEmpty();
+}
+
+qint64 TextSearcher::patternLength() const {
+    return needle.size();
+}
+
+qint64 TextSearcher::indexIn(const char *data, qint64 length, qint64 from) const {
+    const qint64 size = needle.size();
+    if (size == 0 || from < 0 || length - from < size) {
+        return -1;
+    }
+    const bool folded = caseSensitivity == Qt::CaseInsensitive;
+    if (!folded && size == 1) {
+        const void *match = std::memchr(data + from, needle.at(0), static_cast<size_t>(length - from));
+        return match ? static_cast<const char *>(match) - data : -1;
+    }
+#ifdef LOGZ_X86_SIMD
+    if (size > 1) {
+        qint64 resume = from;
+        const qint64 match = folded ? findVectorized<true>(data, length, from, needle.constData(), size, &resume)
+                                    : findVectorized<false>(data, length, from, needle.constData(), size, &resume);
+        if (match >= 0) {
+            return match;
+        }
+        from = resume; // Fewer bytes are left than a vector holds, or there is no kernel
+    }
+#endif
+    if (!folded) {
+        return matcher.indexIn(data, length, from);
+    }
+
+    // Candidates are found by the first byte in either case, the rest is compared folded
+    const char first = needle.at(0);
+    const char firstUpper = upperCase(first);
+    const char *rest = needle.constData() + 1;
+    const qint64 last = length - size;
+    for (qint64 i = from; i <= last; ++i) {
+        const char byte = data[i];
+        if (byte != first && byte != firstUpper) {
+            continue;
+        }
+        qint64 j = 0;
+        while (j < size - 1 && foldCase(data[i + 1 + j]) == rest[j]) {
+            ++j;
+        }
+        if (j == size - 1) {
+            return i;
+        }
+    }
+    return -1;
+}
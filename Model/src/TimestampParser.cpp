@@ -0,0 +1,70 @@
+#include "TimestampParser.h"
+
+namespace {
+
+bool readDigits(const char *text, int count, int &value) {
+    value = 0;
+    for (int i = 0; i < count; ++i) {
+        unsigned digit = static_cast<unsigned char>(text[i]) - '0';
+        if (digit > 9) {
+            return false;
+        }
+        value = value * 10 + static_cast<int>(digit);
+    }
+    return true;
+}
+
+// Days since 1970-01-01 in the proleptic Gregorian calendar
+qint64 daysFromCivil(int year, int month, int day) {
+    year -= month <= 2;
+    const qint64 era = (year >= 0 ? year : year - 399) / 400;
+    const qint64 yearOfEra = year - era * 400;
+    const qint64 dayOfYear = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+    const qint64 dayOfEra = yearOfEra * 365 + yearOfEra / 4 - yearOfEra / 100 + dayOfYear;
+    return era * 146097 + dayOfEra - 719468;
+}
+
+} // namespace
+
+qint64 TimestampParser::toMSecs(int year, int month, int day, int hour, int minute, int second, int msec) {
+    qint64 seconds = daysFromCivil(year, month, day) * 86400 + hour * 3600 + minute * 60 + second;
+    return seconds * 1000 + msec;
+}
+
+qint64 TimestampParser::parse(const char *text, qint64 length) {
+    if (length > 0 && text[0] == '[') {
+        ++text;
+        --length;
+    }
+    if (length < 19) {
+        return NoTimestamp;
+    }
+
+    int year, month, day, hour, minute, second;
+    if (!readDigits(text, 4, year) || text[4] != '-'
+        || !readDigits(text + 5, 2, month) || text[7] != '-'
+        || !readDigits(text + 8, 2, day) || (text[10] != ' ' && text[10] != 'T')
+        || !readDigits(text + 11, 2, hour) || text[13] != ':'
+        || !readDigits(text + 14, 2, minute) || text[16] != ':'
+        || !readDigits(text + 17, 2, second)) {
+        return NoTimestamp;
+    }
+    if (month < 1 || month > 12 || day < 1 || day > 31 || hour > 23 || minute > 59 || second > 60) {
+        return NoTimestamp;
+    }
+
+    int msec = 0;
+    if (length > 20 && (text[19] == '.' || text[19] == ',')) {
+        int scale = 100;
+        for (qint64 i = 20; i < length && i < 23; ++i) {
+            unsigned digit = static_cast<unsigned char>(text[i]) - '0';
+            if (digit > 9) {
+                break;
+            }
+            msec += static_cast<int>(digit) * scale;
+            scale /= 10;
+        }
+    }
+
+    return toMSecs(year, month, day, hour, minute, second, msec);
+}
@@ -46,6 +46,9 @@ class GroupManager : public QObject {
     Q_OBJECT
 
 public:
+    static constexpr int FilePathRole = Qt::UserRole + 1;   ///< Role of file items returning the path of the file.
+    static constexpr int HitCountRole = Qt::UserRole + 2;   ///< Role of file items returning the occurrences found by the last group search, if any.
+
     /**
      * @brief Constructor for the GroupManager.
      * @param model Pointer to the QStandardItemModel that stores group data.
@@ -67,6 +70,29 @@ public:
      */
     QString promptForGroupNameAndColor();
 
+    /**
+     * @brief Returns the paths of the files of a group, in the order they are listed.
+     * @param groupItem Item of the group.
+     */
+    QStringList filePaths(const QStandardItem *groupItem) const;
+
+    /**
+     * @brief Returns the paths of the files of all groups, each path once.
+     */
+    QStringList allFilePaths() const;
+
+    /**
+     * @brief Sets the number of occurrences shown as a badge on every item of a file.
+     * @param filePath The path to the file.
+     * @param hitCount Occurrences found in the file.
+     */
+    void setHitCount(const QString &filePath, qint64 hitCount);
+
+    /**
+     * @brief Removes the occurrence badges from all items.
+     */
+    void clearHitCounts();
+
 private:
     QStandardItemModel* model;                  ///< The model that holds the items.
     QMap<QString, QColor> groupColors;          ///< Maps group names to their associated colors.
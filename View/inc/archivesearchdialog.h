@@ -0,0 +1,65 @@
+#ifndef ARCHIVESEARCHDIALOG_H
+#define ARCHIVESEARCHDIALOG_H
+
+#include <QDialog>
+#include <QLineEdit>
+#include <QCheckBox>
+#include <QPushButton>
+#include <QTreeWidget>
+#include <QLabel>
+#include <QSharedPointer>
+#include "ArchiveSession.h"
+#include "ArchiveSearch.h"
+
+/**
+ * @class ArchiveSearchDialog
+ * @brief Dialog searching the contents of archive entries before any of them is opened.
+ *
+ * The entries are searched in parallel by an ArchiveSearch. Every entry with matches is
+ * listed with its number of matching lines, and its first matching lines can be expanded
+ * below it. Accepting the dialog hands back the entries with matches, so that only those
+ * get opened.
+ */
+class ArchiveSearchDialog : public QDialog
+{
+    Q_OBJECT
+
+public:
+    /**
+     * @brief Constructs the dialog.
+     * @param archive Session of the archive.
+     * @param entryPaths Paths of the entries to search.
+     * @param parent Parent widget, typically the archive viewer.
+     */
+    ArchiveSearchDialog(const QSharedPointer<ArchiveSession> &archive, const QStringList &entryPaths, QWidget *parent = nullptr);
+
+    /**
+     * @brief Returns the entries with at least one match, in the order they were searched.
+     */
+    QStringList matchingEntries() const;
+
+private:
+    ArchiveSearch *search; ///< Runs the search on worker threads.
+    QStringList entries; ///< Entries to search.
+    QLineEdit *textEdit; ///< Text to search for.
+    QCheckBox *caseSensitiveCheckBox; ///< Toggles case-sensitive matching.
+    QPushButton *searchButton; ///< Starts or stops the search.
+    QTreeWidget *resultTree; ///< Entries with matches and their first matching lines.
+    QLabel *statusLabel; ///< Progress and totals of the search.
+    QPushButton *selectButton; ///< Accepts the dialog with the entries that matched.
+    QStringList matches; ///< Entries with at least one match.
+    qint64 matchingLines = 0; ///< Matching lines over all entries.
+    int failedEntries = 0; ///< Entries that could not be read.
+
+    /**
+     * @brief Starts a new search, or stops the running one.
+     */
+    void toggleSearch();
+
+    /**
+     * @brief Adds the result of an entry to the tree.
+     */
+    void addResult(const ArchiveSearch::Result &result);
+};
+
+#endif // ARCHIVESEARCHDIALOG_H
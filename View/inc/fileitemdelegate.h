@@ -10,7 +10,8 @@
  *
  * This delegate is responsible for drawing a close button next to each item in the view
  * and handling the click events on these buttons to emit signals indicating that an item
- * should be closed (either a file or a group).
+ * should be closed (either a file or a group). Files in which the last group search found
+ * occurrences get a badge with their number, see GroupManager::HitCountRole.
  */
 class FileItemDelegate : public QStyledItemDelegate {
     Q_OBJECT
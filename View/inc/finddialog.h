@@ -6,12 +6,18 @@
 #include <QPushButton>
 #include <QVBoxLayout>
 #include <QCheckBox>
+#include <QLabel>
+#include <QTimer>
+#include <QComboBox>
 
 /**
  * @brief The FindDialog class provides a dialog for finding text in a document.
  *
  * This dialog allows the user to search for text using various options like
- * find next, find previous, and find all. It also supports case sensitivity.
+ * find next, find previous, and find all. It also supports case sensitivity and
+ * searching for a regular expression instead of literal text. While the user types,
+ * searchTextChanged() is emitted once typing pauses, for a live count of the matches.
+ * Find All searches the file shown, the group it belongs to or all groups, see scope().
  */
 class FindDialog : public QDialog {
     Q_OBJECT
@@ -24,6 +30,46 @@ public:
      */
     explicit FindDialog(QWidget *parent = nullptr);
 
+    /**
+     * @brief Files searched by Find All.
+     */
+    enum Scope {
+        CurrentFile,    ///< The file shown.
+        CurrentGroup,   ///< The files of the group selected in the tree.
+        AllGroups       ///< The files of all groups.
+    };
+
+    /**
+     * @brief Returns the files Find All searches.
+     */
+    Scope scope() const;
+
+    /**
+     * @brief Returns true if the lines Find All finds in several files are merged by their timestamps instead of listed file by file.
+     */
+    bool orderByTimestamp() const;
+
+    /**
+     * @brief Returns the text entered to search for.
+     */
+    QString text() const;
+
+    /**
+     * @brief Replaces the text to search for, e.g. with the last search of the file shown.
+     *
+     * @param text The text to search for.
+     */
+    void setText(const QString &text);
+
+    /**
+     * @brief Shows the state of the live search below the options, e.g. the number of matches so far.
+     *
+     * @param status The text to show; an empty string hides it.
+     */
+    void setStatus(const QString &status);
+
+    static constexpr int liveSearchDelay = 200; ///< Milliseconds without typing before searchTextChanged() is emitted.
+
 signals:
     /**
      * @brief Signal emitted when the user clicks the "Find Next" button.
@@ -53,10 +99,29 @@ signals:
      */
     void caseSensitivityChanged(bool enabled);
 
+    /**
+     * @brief Signal emitted when the regular expression option changes.
+     *
+     * @param enabled True if the text is a regular expression, false if it is literal text.
+     */
+    void regularExpressionChanged(bool enabled);
+
+    /**
+     * @brief Signal emitted when the text or an option has changed and typing paused for liveSearchDelay.
+     *
+     * @param text The text to find, empty if the user cleared it.
+     */
+    void searchTextChanged(const QString &text);
+
 private:
     QLineEdit *lineEdit; ///< Line edit for entering the text to search.
     QPushButton *findNextButton, *findPreviousButton, *findAllButton; ///< Button to find the next/previous/all occurrence of the search term.
     QCheckBox *caseSensitiveCheckBox; ///< Checkbox to toggle case sensitivity in search.
+    QCheckBox *regularExpressionCheckBox; ///< Checkbox to search for a regular expression instead of literal text.
+    QComboBox *scopeComboBox; ///< Combo box to choose the files Find All searches.
+    QCheckBox *orderByTimestampCheckBox; ///< Checkbox to merge the lines found in several files by their timestamps.
+    QLabel *statusLabel; ///< Label showing the state of the live search.
+    QTimer liveSearchTimer; ///< Debounces searchTextChanged() while the user types.
     QVBoxLayout layout; ///< Layout to arrange widgets vertically in the dialog.
 };
 
@@ -0,0 +1,55 @@
+#ifndef GOTODIALOG_H
+#define GOTODIALOG_H
+
+#include <QDialog>
+#include <QLineEdit>
+#include <QLabel>
+#include <QPushButton>
+#include <QVBoxLayout>
+
+/**
+ * @brief The GoToDialog class asks for a line number or a timestamp to jump to.
+ *
+ * A plain number, optionally with thousands separators, is taken as a one-based line
+ * number. Anything else is parsed as a timestamp in the format the log lines start with,
+ * e.g. "2024-03-01 14:05:00"; seconds or the whole time of day may be left out.
+ */
+class GoToDialog : public QDialog {
+    Q_OBJECT
+
+public:
+    /**
+     * @brief Construct a new Go To Dialog object
+     *
+     * @param parent The parent widget of the dialog, nullptr if it has no parent.
+     */
+    explicit GoToDialog(QWidget *parent = nullptr);
+
+signals:
+    /**
+     * @brief Signal emitted when the user asks for a line.
+     *
+     * @param line Zero-based line number.
+     */
+    void goToLine(qint64 line);
+
+    /**
+     * @brief Signal emitted when the user asks for a point in time.
+     *
+     * @param timestamp Milliseconds since the epoch, as returned by TimestampParser.
+     */
+    void goToTimestamp(qint64 timestamp);
+
+private:
+    QLineEdit *lineEdit; ///< Line edit for entering the line number or timestamp.
+    QLabel *hintLabel; ///< Explains the accepted input, or why it was not accepted.
+    QPushButton *goButton; ///< Button emitting goToLine() or goToTimestamp().
+    QVBoxLayout layout; ///< Layout to arrange widgets vertically in the dialog.
+
+    /**
+     * @brief Parses the input and emits goToLine() or goToTimestamp(), or explains what is wrong with it.
+     */
+    void go();
+};
+
+#endif // GOTODIALOG_H
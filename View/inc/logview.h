@@ -0,0 +1,293 @@
+#ifndef LOGVIEW_H
+#define LOGVIEW_H
+
+#include <QAbstractScrollArea>
+#include <QSharedPointer>
+#include <QTimer>
+#include <QBitArray>
+#include "LogSource.h"
+#include "LineLexer.h"
+
+class QPainter;
+
+/**
+ * @class LogView
+ * @brief Read-only view of a LogSource that lays out and paints only the lines on screen.
+ *
+ * Unlike a QTextEdit there is no document: the vertical scroll bar counts lines of the
+ * source's index, and every paint decodes just the visible rows and draws them with the
+ * fixed advance of a monospace font, one column per UTF-16 code unit. Opening, scrolling
+ * and resizing therefore cost the same for a file of a hundred lines and of a hundred
+ * million. Decoded lines are kept for a page above and below the screen, so scrolling by
+ * a few lines decodes nothing.
+ *
+ * Sources that are still being indexed are shown right away. The scroll bar covers the
+ * line count estimated from the part indexed so far and is refined as indexing goes on;
+ * rows beyond the indexed lines are previewed from the bytes at the estimated position,
+ * in the placeholder text color, until the index gets there.
+ *
+ * Severity levels, timestamps, addresses, UUIDs and numbers are colored as found by
+ * LineLexer. Lines are lexed when they are first painted and the tokens are kept with the
+ * decoded lines, so scrolling lexes only the lines coming into view.
+ *
+ * The position, selection and decoded lines can be saved with saveState() and handed back
+ * to setSource(), which makes switching between files instant.
+ *
+ * Text can be selected with the mouse, copied with Ctrl+C or the context menu, and a line
+ * can be Ctrl+clicked to collect it, see ctrlClicked().
+ */
+class LogView : public QAbstractScrollArea
+{
+    Q_OBJECT
+
+public:
+    /**
+     * @brief Position in the text: a line and a column within its decoded text.
+     */
+    struct Position {
+        qint64 line = -1;   ///< Zero-based line number, -1 for no position.
+        int column = 0;     ///< Column in UTF-16 code units.
+
+        bool operator<(const Position &other) const {
+            return line < other.line || (line == other.line && column < other.column);
+        }
+        bool operator==(const Position &other) const {
+            return line == other.line && column == other.column;
+        }
+    };
+
+    /**
+     * @brief Everything needed to show a source again exactly as it was left.
+     */
+    struct State {
+        qint64 firstLine = 0;       ///< First line on screen.
+        int horizontalOffset = 0;   ///< Horizontal scroll position in pixels.
+        Position anchor;            ///< Where the selection started.
+        Position cursor;            ///< Where the selection ended.
+        qint64 lines = 0;           ///< Line count of the source when the state was saved.
+        qint64 rowsFirst = 0;       ///< Line number of the first decoded line.
+        QStringList rows;           ///< Decoded lines around the screen.
+
+        /**
+         * @brief Returns the approximate memory held by the state in bytes.
+         */
+        qint64 cost() const;
+    };
+
+    /**
+     * @brief Constructs an empty view.
+     * @param parent The parent widget.
+     */
+    explicit LogView(QWidget *parent = nullptr);
+
+    /**
+     * @brief Shows a source from its first line, or nothing for a null pointer.
+     * @param source The source to show.
+     */
+    void setSource(const QSharedPointer<LogSource> &source);
+
+    /**
+     * @brief Shows a source as it was when the state was saved.
+     *
+     * Decoded lines of the state are reused, except those a followed file may have changed since.
+     *
+     * @param source The source to show.
+     * @param state State saved by saveState() while the same source was shown.
+     */
+    void setSource(const QSharedPointer<LogSource> &source, const State &state);
+
+    /**
+     * @brief Returns the current position, selection and decoded lines.
+     */
+    State saveState() const;
+
+    /**
+     * @brief Returns the source shown, or a null pointer.
+     */
+    QSharedPointer<LogSource> source() const;
+
+    /**
+     * @brief Shows nothing.
+     */
+    void clear();
+
+    /**
+     * @brief Picks up lines indexed or appended since the last refresh, keeping the
+     *        position; if the view was scrolled to the end, it stays at the end.
+     */
+    void refresh();
+
+    /**
+     * @brief Turns coloring of the tokens found by LineLexer on or off; it is on by default.
+     */
+    void setHighlighting(bool enabled);
+
+    /**
+     * @brief Returns true if tokens are colored.
+     */
+    bool highlighting() const;
+
+    /**
+     * @brief Returns the first line on screen.
+    qint64 firstVisibleLine() const;
+
+    /**
+     * @brief Scrolls so that a line is on screen, centering it if it was not.
+     * @param line Zero-based line number.
+     */
+    void ensureLineVisible(qint64 line);
+
+    /**
+     * @brief Selects a range within one line and scrolls to it.
+     * @param line Zero-based line number.
+     * @param column First selected column.
+     * @param length Number of selected columns.
+     */
+    void setSelection(qint64 line, int column, int length);
+
+    /**
+     * @brief Returns true if text is selected.
+     */
+    bool hasSelection() const;
+
+    /**
+     * @brief Returns the start of the selection, or where the last click was if nothing is selected.
+     */
+    Position selectionStart() const;
+
+    /**
+     * @brief Returns the end of the selection, or where the last click was if nothing is selected.
+     */
+    Position selectionEnd() const;
+
+    /**
+     * @brief Returns the selected text, lines separated by '\n'.
+     */
+    QString selectedText() const;
+
+public slots:
+    /**
+     * @brief Copies the selected text to the clipboard.
+     */
+    void copy();
+
+    /**
+     * @brief Selects all indexed lines.
+     */
+    void selectAll();
+
+signals:
+    /**
+     * @brief Emitted when a line is Ctrl+clicked.
+     * @param lineText The text of the clicked line.
+     */
+    void ctrlClicked(const QString &lineText);
+
+    /**
+     * @brief Emitted when the selection changes.
+     */
+    void selectionChanged();
+
+protected:
+    void paintEvent(QPaintEvent *event) override;
+    void resizeEvent(QResizeEvent *event) override;
+    void changeEvent(QEvent *event) override;
+    void scrollContentsBy(int dx, int dy) override;
+    void mousePressEvent(QMouseEvent *event) override;
+    void mouseMoveEvent(QMouseEvent *event) override;
+    void mouseReleaseEvent(QMouseEvent *event) override;
+    void mouseDoubleClickEvent(QMouseEvent *event) override;
+    void keyPressEvent(QKeyEvent *event) override;
+    void contextMenuEvent(QContextMenuEvent *event) override;
+
+private:
+    QSharedPointer<LogSource> logSource;    ///< Source shown, may be null.
+    qint64 lines = 0;                       ///< Line count of the source at the last refresh.
+    qint64 estimatedLines = 0;              ///< Lines the scroll bar covers, estimated while the source is being indexed.
+    int lineHeight = 1;                     ///< Height of a row in pixels.
+    int charWidth = 1;                      ///< Advance of one column in pixels.
+    int ascent = 0;                         ///< Baseline offset within a row.
+    Position anchor;                        ///< Where the selection started.
+    Position cursor;                        ///< Where the selection ends, the mouse while selecting.
+    bool selecting = false;                 ///< True while the left button is held to select.
+    QTimer autoScrollTimer;                 ///< Scrolls while selecting above or below the viewport.
+    QTimer pollTimer;                       ///< Refreshes while the source is being indexed.
+    mutable qint64 rowsFirst = 0;           ///< Line number of the first decoded line.
+    mutable QStringList rows;               ///< Decoded lines around the screen, see decodeRows().
+    mutable QVector<LineLexer::Tokens> rowTokens; ///< Tokens of the decoded lines, valid where rowLexed is set.
+    mutable QBitArray rowLexed;             ///< Which of the decoded lines have been lexed.
+    bool highlight = true;                  ///< True if tokens are colored.
+
+    /**
+     * @brief Recomputes the row height and column width from the font.
+     */
+    void updateMetrics();
+
+    /**
+     * @brief Updates the scroll bar ranges from the line count and the longest line.
+     */
+    void updateScrollBars();
+
+    /**
+     * @brief Returns the number of rows that fit on screen entirely.
+     */
+    int visibleRows() const;
+
+    /**
+     * @brief Returns the text position under a point of the viewport, clamped to the indexed lines.
+     */
+    Position positionAt(const QPoint &point) const;
+
+    /**
+     * @brief Returns the decoded text of a line, an empty string if it is out of range.
+     */
+    QString lineText(qint64 line) const;
+
+    /**
+     * @brief Makes sure the lines [first, first + count) are decoded, decoding a page more on either side if not.
+     */
+    void decodeRows(qint64 first, int count) const;
+
+    /**
+     * @brief Drops the decoded lines from a line on, e.g. because a followed file changed them.
+     */
+    void dropRowsFrom(qint64 line);
+
+    /**
+     * @brief Forgets the tokens of all decoded lines after they have been replaced.
+     */
+    void resetTokens() const;
+
+    /**
+     * @brief Returns the tokens of an indexed line, lexing it if it was not yet.
+     * @param line Zero-based line number of a decoded line.
+     */
+    const LineLexer::Tokens &tokensAt(qint64 line) const;
+
+    /**
+     * @brief Draws the visible part of a row, colored by its tokens unless a single color is given.
+     * @param painter Painter of the viewport.
+     * @param x Left edge of the first visible column.
+     * @param y Baseline of the row.
+     * @param visible Visible columns of the row.
+     * @param firstColumn Column of the first visible character.
+     * @param tokens Tokens of the whole row.
+     * @param color Color of the text between tokens.
+     */
+    void drawRow(QPainter &painter, int x, int y, const QString &visible, int firstColumn,
+                 const LineLexer::Tokens &tokens, const QColor &color) const;
+
+    /**
+     * @brief Decodes rows beyond the indexed lines from the bytes where they are estimated to be.
+     * @param first First row to preview, at least the indexed line count.
+     * @param count Number of rows.
+     */
+    QStringList previewRows(qint64 first, int count) const;
+
+    /**
+     * @brief Moves the end of the selection while dragging and repaints.
+     */
+    void extendSelection(const QPoint &point);
+};
+
+#endif // LOGVIEW_H
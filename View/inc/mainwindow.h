@@ -3,9 +3,13 @@
 
 #include <QMainWindow>
 #include <QStandardItemModel>
-#include "clickabletextedit.h"
+#include "logview.h"
 #include "finddialog.h"
+#include "gotodialog.h"
 #include "LogManager.h"
+#include "LogSearch.h"
+#include "GroupSearch.h"
+#include "FindResultsModel.h"
 #include "GroupManager.h"
 #include <QDateTime>
 #include <QList>
@@ -13,11 +17,15 @@
 #include <QTextDocument>
 #include <KArchive>
 #include <KZip>
-#include <KTar>
 #include <QStandardPaths>
+#include <QCache>
 
 QT_BEGIN_NAMESPACE
 namespace Ui { class MainWindow; }
+class QLabel;
+class QProgressBar;
+class QProgressDialog;
+class QPushButton;
 QT_END_NAMESPACE
 
 /**
@@ -50,13 +58,38 @@ private slots:
      */
     void on_actionOpen_triggered();
 
+    /**
+     * @brief Opens every log file in a folder and its subfolders under one group.
+     *
+     * Collects all *.log and *.txt files below the chosen directory and hands them to
+     * LogManager::openFiles(), which loads them concurrently.
+     */
+    void on_openFolder_triggered();
+
     /**
      * @brief Slot triggered when a tree view item is clicked.
      *        Displays the content of the selected file.
+     *
+     * The view state of the file shown so far is kept in the view cache; a file found in it
+     * is shown again where it was left, without decoding its lines again.
+     *
      * @param index The model index of the clicked item.
      */
     void onTreeViewClicked(const QModelIndex &index);
 
+    /**
+     * @brief Shows the context menu of a tree view item, offering to follow the file.
+     * @param pos Position of the request in tree view viewport coordinates.
+     */
+    void onTreeViewContextMenuRequested(const QPoint &pos);
+
+    /**
+     * @brief Shows lines written to a followed file in the log view if it shows that file.
+     * @param filePath Path of the followed file.
+     * @param firstChangedLine First line whose content changed.
+     */
+    void onLinesAppended(const QString &filePath, qint64 firstChangedLine);
+
     /**
      * @brief Slot triggered to close a file or a group.
      * @param index The model index of the item to close.
@@ -70,13 +103,13 @@ private slots:
     void onCloseGroupRequested(const QModelIndex &index);
 
     /**
-     * @brief Handles the Ctrl+click action on a line of text in the primary text edit widget.
+     * @brief Handles the Ctrl+click action on a line of text in the log view.
      *
-     * This slot is triggered when the user Ctrl+clicks on a line of text in the primary text edit.
+     * This slot is triggered when the user Ctrl+clicks on a line of text in the log view.
      * It appends the clicked line of text to the secondary text edit widget.
      * @param lineText The text of the clicked line to be added to the secondary text edit.
      */
-    void onTextEditPrimaryCtrlClicked(const QString &lineText);
+    void onLogViewCtrlClicked(const QString &lineText);
 
     /**
      * @brief Slot triggered to change the font size of the text edits and tree view.
@@ -84,6 +117,11 @@ private slots:
      */
     void onChangeFontSizeTriggered();
 
+    /**
+     * @brief Lets the user choose how much memory the view cache may use; 0 disables it.
+     */
+    void onViewCacheSizeTriggered();
+
     /**
      * @brief Changes the color of the selected text in textEditSecondary.
      */
@@ -149,24 +187,25 @@ private slots:
     void deleteSelectedLineInSecondary(int position);
 
     /**
-     * @brief Finds and selects the next occurrence of the text in the primary text edit widget.
+     * @brief Finds and selects the next occurrence of the text in the log view.
      *
-     * This method searches for the next occurrence of the specified text in the primary text edit widget,
-     * starting from the current cursor position. If the text is found, it selects the text and updates
-     * the cursor position to the end of the found text.
+     * This method searches for the next occurrence of the specified text in the log shown in the log view,
+     * starting at the end of the selection. The rest of the current line is checked right away; the lines
+     * after it are searched by stepSearch on worker threads and onStepSearchFinished() selects the
+     * occurrence found and scrolls to it. A Find Next or Find Previous still running is cancelled.
      *
-     * @param text The text string to search for in the primary text edit widget.
+     * @param text The text string to search for in the log view.
      */
     void findNext(const QString &text);
 
     /**
-     * @brief Finds and selects the previous occurrence of the text in the primary text edit widget.
+     * @brief Finds and selects the previous occurrence of the text in the log view.
      *
-     * This method searches for the previous occurrence of the specified text in the primary text edit widget,
-     * starting from the current cursor position and searching backwards. If the text is found, it selects
-     * the text and updates the cursor position to the beginning of the found text.
+     * This method searches backwards for the previous occurrence of the specified text in the log shown
+     * in the log view, starting at the start of the selection. The start of the current line is checked
+     * right away; the lines before it are searched by stepSearch like for findNext().
      *
-     * @param text The text string to search for in the primary text edit widget.
+     * @param text The text string to search for in the log view.
      */
     void findPrevious(const QString &text);
 
@@ -181,25 +220,103 @@ private slots:
     void updateCaseSensitivity(bool enabled);
 
     /**
-     * @brief Toggles the display between user content and find results in the secondary text edit widget.
+     * @brief Switches text searches between literal text and regular expressions.
      *
-     * This method switches the content displayed in the secondary text edit widget between the user's
-     * original content and the results of a find operation. It also adjusts the editability of the widget
-     * based on the type of content being displayed.
+     * @param enabled True to search for regular expressions, false for literal text.
+     */
+    void updateRegularExpressionSearch(bool enabled);
+
+    /**
+     * @brief Toggles the display between the secondary text edit widget and the find results list.
+     *
+     * Both stay alive in a stacked widget, so the user's content is kept as it is and the find results
+     * are not rebuilt when switching between them.
      */
     void toggleFindResults();
 
     /**
-     * @brief Searches for all occurrences of the specified text in the primary text edit widget and displays the results.
+     * @brief Searches for all occurrences of the specified text in the log view and displays the results.
      *
-     * This method finds all occurrences of the specified text within the primary text edit widget. It formats
-     * each found line with its line number and the matched text, and displays these results in the secondary
-     * text edit widget. If no matches are found, it informs the user via a message box.
+     * This method starts a LogSearch over the lines of the log shown in the log view, which runs on
+     * worker threads while the status bar shows its progress. The matching lines are listed in place of
+     * the secondary text edit widget by onLogSearchFinished(). A search still running is cancelled.
+     * If the find dialog's scope is a group or all groups, findAllInGroups() searches their files instead.
      *
-     * @param text The text string to search for in the primary text edit widget.
+     * @param text The text string to search for in the log view.
      */
     void findAllInDocument(const QString &text);
 
+    /**
+     * @brief Searches all loaded files of the current group or of all groups, see FindDialog::scope().
+     *
+     * The files are searched by a GroupSearch on one thread pool. The tree shows the number of
+     * occurrences of every file as soon as it is searched, and onGroupSearchFinished() lists the
+     * lines of all files. Files that are still loading or failed to load are skipped.
+     *
+     * @param matcher Text or regular expression to search for.
+     */
+    void findAllInGroups(const LineMatcher &matcher);
+
+    /**
+     * @brief Lists the lines found in all files by findAllInGroups(), by file and line or by timestamp.
+     *
+     * @param cancelled True if the search was cancelled, in which case nothing is shown.
+     */
+    void onGroupSearchFinished(bool cancelled);
+
+    /**
+     * @brief Searches the log view as the user types in the find dialog, to show the number of matches.
+     *
+     * Starting a search cancels the one of the previous keystroke. A text extending the previous one
+     * only searches the lines that one matched, see LogSearch.
+     *
+     * @param text The text to search for; an empty text clears the count.
+     */
+    void onSearchTextChanged(const QString &text);
+
+    /**
+     * @brief Shows the number of matches in the find dialog, and for Find All the matching lines.
+     *
+     * The lines found by Find All are listed by findResultsModel, shown in place of the secondary text
+     * edit widget. If no matches are found, it informs the user via a message box.
+     *
+     * @param cancelled True if the search was cancelled, in which case nothing is shown.
+     */
+    void onLogSearchFinished(bool cancelled);
+
+    /**
+     * @brief Selects the occurrence found by Find Next or Find Previous, or tells that there is none.
+     * @param cancelled True if the search was cancelled, in which case nothing is shown.
+     */
+    void onStepSearchFinished(bool cancelled);
+
+    /**
+     * @brief Selects the first match of a clicked find result in the log view.
+     *
+     * A result of a group search in another file shows that file first.
+     *
+     * @param index Row of findResultsModel that was clicked.
+     */
+    void onFindResultClicked(const QModelIndex &index);
+
+    /**
+     * @brief Scrolls the log view to a line and selects it.
+     *
+     * If the line is not indexed yet, the user is told how many lines are available so far.
+     *
+     * @param line Zero-based line number.
+     */
+    void goToLine(qint64 line);
+
+    /**
+     * @brief Scrolls the log view to the first line at or after a point in time and selects it.
+     *
+     * The line is looked up with LogSource::lineAtTimestamp(), in logarithmic time.
+     *
+     * @param timestamp Milliseconds since the epoch, as returned by TimestampParser.
+     */
+    void goToTimestamp(qint64 timestamp);
+
     /**
      * @brief Sets the dark theme for the application.
      *
@@ -262,17 +379,82 @@ private slots:
      */
     void changeLanguage(const QString &language);
 
+    /**
+     * @brief Shows ingestion progress and throughput in the status bar.
+     * @param bytesDone Bytes indexed so far.
+     * @param bytesTotal Total bytes queued.
+     * @param linesDone Lines indexed so far.
+     * @param bytesPerSecond Average throughput in bytes per second.
+     * @param linesPerSecond Average throughput in lines per second.
+     */
+    void onIngestionProgress(qint64 bytesDone, qint64 bytesTotal, qint64 linesDone, double bytesPerSecond, double linesPerSecond);
+
+    /**
+     * @brief Hides the ingestion progress widgets and shows the aggregate throughput once all queued files are loaded.
+     * @param cancelled True if loading was cancelled by the user.
+     * @param filesLoaded Number of files opened.
+     * @param bytesLoaded Number of bytes indexed.
+     * @param elapsedMs Duration of the run in milliseconds.
+     */
+    void onIngestionFinished(bool cancelled, int filesLoaded, qint64 bytesLoaded, qint64 elapsedMs);
+
+    /**
+     * @brief Lets the user pick the entries of a listed archive to open in a ZipViewerDialog.
+     *
+     * Archives listed while a dialog is open are queued and asked for one after the other.
+     *
+     * @param archive Session of the listed archive.
+     * @param groupName Name of the group the picked entries are added to.
+     */
+    void onArchiveOpened(const QSharedPointer<ArchiveSession> &archive, const QString &groupName);
+
+    /**
+     * @brief Refreshes the log view if the updated source is the currently opened file.
+     * @param filePath Path of the updated file.
+     */
+    void onSourceUpdated(const QString &filePath);
+
+    /**
+     * @brief Shows a followed file again after it was truncated or rotated, dropping its cached view state.
+     * @param filePath Path of the reset file.
+     */
+    void onSourceReset(const QString &filePath);
+
 private:
+    /**
+     * @brief View state of a file that is not shown, kept for switching back to it.
+     */
+    struct FileViewState {
+        LogView::State view;    ///< Position, selection and decoded lines of the log view.
+        QString findText;       ///< Text in the find dialog.
+        QVector<LogSearch::Hit> findHits; ///< Occurrences found by Find All in the file.
+
+        /**
+         * @brief Returns the approximate memory held by the state in bytes.
+         */
+        qint64 cost() const;
+    };
+
+    static constexpr qint64 defaultViewCacheSize = 64 * 1024 * 1024; ///< Default memory budget of the view cache.
+
     Ui::MainWindow *ui; ///< Pointer to the UI elements.
     QStandardItemModel *model; ///< Model for managing tree view items.
     QString currentOpenFilePath; ///< Path of the currently open file.
-    QList<LogEntry> logEntries; ///< List of log entries displayed in the application.
     FindDialog *findDialog; ///< Pointer to the find dialog used for text searches.
+    GoToDialog *goToDialog; ///< Pointer to the dialog asking for a line or timestamp to jump to.
     bool caseSensitiveSearch = false; ///< Indicates if the search should be case-sensitive.
-    QString findResults; ///< Stores the search results formatted as HTML.
-    QString userContent; ///< Stores the user content displayed in the secondary text editor when not showing find results.
+    bool regularExpressionSearch = false; ///< Indicates if the search text is a regular expression.
+    LogSearch *logSearch; ///< Find All search running over the log shown.
+    LogSearch *stepSearch; ///< Find Next or Find Previous search running over the log shown.
+    QSharedPointer<LogSource> stepSource; ///< Log the running Find Next or Find Previous runs over.
+    bool stepBackward = false; ///< True if the running step search is a Find Previous.
+    GroupSearch *groupSearch; ///< Find All search running over the files of a group or of all groups.
+    QSharedPointer<LogSource> findAllSource; ///< Log the running search runs over.
+    bool findAllRequested = false; ///< True if the running search is a Find All, whose lines are shown when it finishes.
+    FindResultsModel *findResultsModel; ///< Lines found by Find All in the file shown or by the last group search, listed in findResultsView.
     QAction *toggleViewAction; ///< Action associated with toggling between user content and find results.
-    bool isFindResultsDisplayed = false; ///< Flag to indicate if the find results are currently displayed in the secondary text editor.
+    QAction *highlightLevelsAction; ///< Checkable action turning the highlighting of levels and values in the log view on and off.
+    bool isFindResultsDisplayed = false; ///< Flag to indicate if the find results are currently displayed instead of the secondary text editor.
     LogManager* logManager; ///< Pointer to an instance of LogManager which handles the logic for managing log files.
     GroupManager* groupManager; ///< Pointer to an instance of GroupManager which manages group creation and color settings for the groups.
     QString currentLanguage; ///< Holds the current language code.
@@ -280,6 +462,14 @@ private:
     QMap<QString, QString> translations_hr; ///< Translations for Croatian.
     QMap<QString, QString> translations_es; ///< Translations for Spanish.
     QMap<QString, QString> translations_de; ///< Translations for German.
+    QLabel *ingestionLabel; ///< Status bar label showing ingestion throughput.
+    QProgressBar *ingestionProgressBar; ///< Status bar progress of the files being loaded.
+    QPushButton *cancelIngestionButton; ///< Status bar button cancelling the files being loaded.
+    QProgressDialog *archiveProgressDialog; ///< Progress of the archives being listed, shown only if listing takes a while.
+    QList<QPair<QSharedPointer<ArchiveSession>, QString>> openedArchives; ///< Listed archives, with their group, waiting for entries to be picked.
+    bool pickingArchiveEntries = false; ///< True while a ZipViewerDialog is open for one of openedArchives.
+    QCache<QString, FileViewState> viewStates; ///< View states of recently shown files, least recently shown evicted first; costs are in bytes.
+    QLabel *viewCacheLabel; ///< Status bar label showing the memory used by the view cache.
 
     /**
      * @brief Prompts the user to enter or select a group name.
@@ -360,6 +550,11 @@ private:
      */
     void setupFindDialog();
 
+    /**
+     * @brief Sets up the go-to dialog and the Ctrl+G shortcut opening it.
+     */
+    void setupGoToDialog();
+
     /**
      * @brief Sets up the item delegate for styling tree view items.
      */
@@ -370,6 +565,39 @@ private:
      */
     void setupGroupLogConnections();
 
+    /**
+     * @brief Sets up the status bar widgets reporting background file loading.
+     */
+    void setupStatusBar();
+
+    /**
+     * @brief Shows a file in the log view, restoring its cached view state if there is one.
+     * @param filePath Path of the file.
+     * @return False if the file is not loaded.
+     */
+    bool showFile(const QString &filePath);
+
+    /**
+     * @brief Cancels the group search and drops its results and hit counts, e.g. once one of its files is closed.
+     */
+    void forgetGroupSearch();
+
+    /**
+     * @brief Moves the view state of the file currently shown into the view cache.
+     */
+    void saveViewState();
+
+    /**
+     * @brief Drops the cached view state of a file once it is no longer open in any group.
+     * @param filePath Path of the closed file.
+     */
+    void forgetViewState(const QString &filePath);
+
+    /**
+     * @brief Shows the memory used by the view cache and its budget in the status bar.
+     */
+    void updateViewCacheLabel();
+
     /**
      * @brief Prompts the user for confirmation before sorting logs.
      *
@@ -393,26 +621,15 @@ private:
     QString previousContent;
 
     /**
-     * @brief Configures the appearance of the primary text edit widget.
+     * @brief Configures the appearance of the log view.
      *
-     * This method sets up the visual styling for the primary text edit widget in the application.
+     * This method sets up the visual styling for the log view in the application.
      * It applies a custom style sheet to change the appearance of selected text, setting the background
      * color to green and the text color to white. This enhances the visibility of selected text,
      * making it easier for users to identify their selections within the text.
      */
     void setupTextEdit();
 
-    /**
-     * @brief Decompresses and processes files within an archive file.
-     *
-     * This method opens an archive file, decompresses its contents, and
-     * optionally saves them to a specified output directory or directly uses them.
-     *
-     * @param filePath Path to the archive file.
-     * @param outputPath Directory where the decompressed content should be saved.
-     */
-    void processArchiveFile(const QString &filePath, const QString &outputPath);
-
     /**
      * @brief Loads translations for the given language.
      * @param language The language code to load translations for.
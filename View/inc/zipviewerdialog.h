@@ -2,18 +2,27 @@
 #define ZIPVIEWERDIALOG_H
 
 #include <QDialog>
-#include <QTreeWidget>
+#include <QTreeView>
+#include <QLineEdit>
+#include <QLabel>
+#include <QTimer>
 #include <QVBoxLayout>
 #include <QDialogButtonBox>
-#include <KArchiveDirectory>
+#include <QSharedPointer>
+#include "ArchiveSession.h"
+#include "ArchiveEntryModel.h"
 
 /**
  * @class ZipViewerDialog
  * @brief The ZipViewerDialog class provides a dialog window to view the contents of a ZIP archive.
  *
- * This dialog is designed to display the hierarchical structure of files and directories
- * within a ZIP archive using a QTreeWidget. It allows users to view and possibly select
- * files or directories within the archive for further processing.
+ * This dialog displays the hierarchical structure of files and directories within a ZIP
+ * archive in a QTreeView backed by an ArchiveEntryModel, which creates directory nodes only
+ * when they are expanded, so archives with hundreds of thousands of entries open instantly.
+ * Entries can be filtered by name or glob while typing, all matching entries can be selected
+ * at once, and the uncompressed and compressed size of every entry and of the selection are
+ * shown before anything is opened. The contents of the selected entries, or of all matching
+ * ones, can be searched with an ArchiveSearchDialog to select just the entries containing a text.
  */
 class ZipViewerDialog : public QDialog
 {
@@ -22,15 +31,17 @@ class ZipViewerDialog : public QDialog
 public:
     /**
      * @brief Constructor for ZipViewerDialog.
-     * @param zipPath Path to the ZIP file to be opened and displayed.
+     * @param archive Session of the ZIP archive to be displayed; its directory is not read again.
      * @param parent Parent widget, typically the main window.
      */
-    ZipViewerDialog(const QString &zipPath, QWidget *parent = nullptr);
+    ZipViewerDialog(const QSharedPointer<ArchiveSession> &archive, QWidget *parent = nullptr);
 
     /**
      * @brief Retrieves the list of file paths selected by the user.
      *
-     * @return A list of file paths.
+     * Checking a directory selects all files below it.
+     *
+     * @return A list of file paths inside the archive.
      */
     QStringList getSelectedFiles() const;
 
@@ -38,28 +49,18 @@ private slots:
     void accept() override;
 
 private:
-    QTreeWidget *treeWidget; ///< Tree widget to display the contents of the ZIP file.
+    ArchiveEntryModel *model; ///< Entries of the archive and their check states.
+    QTreeView *treeView; ///< Tree view to display the contents of the ZIP file.
+    QLineEdit *filterEdit; ///< Name or glob the entries are filtered by.
+    QLabel *summaryLabel; ///< Number of matching entries and size of the selection.
+    QSharedPointer<ArchiveSession> archive; ///< Archive whose entries are shown.
+    QTimer filterTimer; ///< Delays filtering until typing pauses.
     QStringList selectedFiles; ///< List of selected file paths from the ZIP file.
 
     /**
-     * @brief Loads the contents of the ZIP file into the tree widget.
-     * @param zipPath Path to the ZIP file.
-     */
-    void loadZipContents(const QString &zipPath);
-
-    /**
-     * @brief Recursively populates the tree widget with items from the KArchiveDirectory.
-     * @param directory Pointer to the current directory in the archive being processed.
-     * @param parentItem The parent tree widget item under which new items will be added.
-     */
-    void populateTreeWidget(const KArchiveDirectory* directory, QTreeWidgetItem* parentItem = nullptr);
-
-    /**
-     * @brief Recursively collects the checked (selected) file paths from the tree widget.
-     *
-     * @param item The current tree widget item being examined.
+     * @brief Updates the summary label from the model.
      */
-    void collectSelectedFiles(QTreeWidgetItem* item);
+    void updateSummary();
 };
 
 #endif // ZIPVIEWERDIALOG_H
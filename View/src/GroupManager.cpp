@@ -26,7 +26,7 @@ void GroupManager::addToGroup(const QString &groupName, const QString &fileName,
     fileFont.setBold(false);
     fileItem->setFont(fileFont);
     fileItem->setForeground(QBrush(textColor));
-    fileItem->setData(filePath, Qt::UserRole + 1); // Store file path for opening
+    fileItem->setData(filePath, FilePathRole); // Store file path for opening
     groupItem->appendRow(fileItem);
 }
 
@@ -76,3 +76,41 @@ QString GroupManager::promptForGroupNameAndColor() {
     }
     return QString();
 }
+
+QStringList GroupManager::filePaths(const QStandardItem *groupItem) const {
+    QStringList paths;
+    for (int i = 0; groupItem && i < groupItem->rowCount(); ++i) {
+        paths << groupItem->child(i)->data(FilePathRole).toString();
+    }
+    return paths;
+}
+
+QStringList GroupManager::allFilePaths() const {
+    QStringList paths;
+    for (int i = 0; i < model->rowCount(); ++i) {
+        paths << filePaths(model->item(i));
+    }
+    paths.removeDuplicates(); // A file may be in several groups
+    return paths;
+}
+
+void GroupManager::setHitCount(const QString &filePath, qint64 hitCount) {
+    for (int i = 0; i < model->rowCount(); ++i) {
+        QStandardItem *groupItem = model->item(i);
+        for (int j = 0; j < groupItem->rowCount(); ++j) {
+            QStandardItem *fileItem = groupItem->child(j);
+            if (fileItem->data(FilePathRole).toString() == filePath) {
+                fileItem->setData(hitCount, HitCountRole);
+            }
+        }
+    }
+}
+
+void GroupManager::clearHitCounts() {
+    for (int i = 0; i < model->rowCount(); ++i) {
+        QStandardItem *groupItem = model->item(i);
+        for (int j = 0; j < groupItem->rowCount(); ++j) {
+            groupItem->child(j)->setData(QVariant(), HitCountRole);
+        }
+    }
+}
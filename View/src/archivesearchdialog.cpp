@@ -0,0 +1,115 @@
+#include "archivesearchdialog.h"
+#include <QVBoxLayout>
+#include <QHBoxLayout>
+#include <QDialogButtonBox>
+#include <QHeaderView>
+#include <QLocale>
+
+namespace {
+const int maxHitsPerEntry = 20; // Matching lines listed below every entry
+}
+
+ArchiveSearchDialog::ArchiveSearchDialog(const QSharedPointer<ArchiveSession> &archive, const QStringList &entryPaths, QWidget *parent)
+    : QDialog(parent), search(new ArchiveSearch(archive, this)), entries(entryPaths), textEdit(new QLineEdit(this)),
+      caseSensitiveCheckBox(new QCheckBox(tr("Case Sensitive"), this)), searchButton(new QPushButton(tr("Search"), this)),
+      resultTree(new QTreeWidget(this)), statusLabel(new QLabel(this)) {
+    setWindowTitle(tr("Search in Archive"));
+    resize(760, 520);
+    QVBoxLayout *layout = new QVBoxLayout(this);
+
+    QHBoxLayout *searchLayout = new QHBoxLayout();
+    textEdit->setPlaceholderText(tr("Text to search for in %n entries", nullptr, entries.size()));
+    searchLayout->addWidget(textEdit, 1);
+    searchLayout->addWidget(caseSensitiveCheckBox);
+    searchLayout->addWidget(searchButton);
+    layout->addLayout(searchLayout);
+
+    resultTree->setColumnCount(2);
+    resultTree->setHeaderLabels({tr("Entry / Line"), tr("Matches")});
+    resultTree->setUniformRowHeights(true);
+    resultTree->header()->setStretchLastSection(false);
+    resultTree->header()->setSectionResizeMode(0, QHeaderView::Stretch);
+    resultTree->header()->setSectionResizeMode(1, QHeaderView::ResizeToContents);
+    layout->addWidget(resultTree);
+    layout->addWidget(statusLabel);
+
+    QDialogButtonBox *buttonBox = new QDialogButtonBox(QDialogButtonBox::Cancel, this);
+    selectButton = buttonBox->addButton(tr("Select entries with matches"), QDialogButtonBox::AcceptRole);
+    selectButton->setEnabled(false);
+    layout->addWidget(buttonBox);
+    connect(buttonBox, &QDialogButtonBox::accepted, this, &ArchiveSearchDialog::accept);
+    connect(buttonBox, &QDialogButtonBox::rejected, this, &ArchiveSearchDialog::reject);
+
+    connect(searchButton, &QPushButton::clicked, this, &ArchiveSearchDialog::toggleSearch);
+    connect(textEdit, &QLineEdit::returnPressed, this, [this]() {
+        if (!search->isRunning()) {
+            toggleSearch();
+        }
+    });
+    connect(search, &ArchiveSearch::entrySearched, this, &ArchiveSearchDialog::addResult);
+    connect(search, &ArchiveSearch::progress, this, [this](int entriesDone, int entriesTotal, qint64 bytesSearched) {
+        QLocale locale;
+        statusLabel->setText(tr("Searched %1 of %2 entries (%3), %4 lines in %5 entries match")
+                                 .arg(locale.toString(entriesDone))
+                                 .arg(locale.toString(entriesTotal))
+                                 .arg(locale.formattedDataSize(bytesSearched))
+                                 .arg(locale.toString(matchingLines))
+                                 .arg(locale.toString(matches.size())));
+    });
+    connect(search, &ArchiveSearch::finished, this, [this](bool cancelled) {
+        searchButton->setText(tr("Search"));
+        selectButton->setEnabled(!matches.isEmpty());
+        QString status = statusLabel->text();
+        if (cancelled) {
+            status += tr(" - stopped");
+        }
+        if (failedEntries > 0) {
+            status += tr(" - %n entries could not be read", nullptr, failedEntries);
+        }
+        statusLabel->setText(status);
+    });
+}
+
+QStringList ArchiveSearchDialog::matchingEntries() const {
+    return matches;
+}
+
+void ArchiveSearchDialog::toggleSearch() {
+    if (search->isRunning()) {
+        search->cancel();
+        return;
+    }
+    if (textEdit->text().isEmpty()) {
+        return;
+    }
+
+    resultTree->clear();
+    matches.clear();
+    matchingLines = 0;
+    failedEntries = 0;
+    selectButton->setEnabled(false);
+    statusLabel->setText(tr("Searching..."));
+    searchButton->setText(tr("Stop"));
+    search->start(entries, textEdit->text(),
+                  caseSensitiveCheckBox->isChecked() ? Qt::CaseSensitive : Qt::CaseInsensitive, maxHitsPerEntry);
+}
+
+void ArchiveSearchDialog::addResult(const ArchiveSearch::Result &result) {
+    if (!result.error.isEmpty()) {
+        ++failedEntries;
+        QTreeWidgetItem *item = new QTreeWidgetItem(resultTree, {result.entryPath, tr("Error")});
+        item->setToolTip(0, result.error);
+        item->setToolTip(1, result.error);
+        return;
+    }
+    if (result.matchingLines == 0) {
+        return;
+    }
+
+    matches.append(result.entryPath);
+    matchingLines += result.matchingLines;
+    QTreeWidgetItem *item = new QTreeWidgetItem(resultTree, {result.entryPath, QLocale().toString(result.matchingLines)});
+    for (const ArchiveSearch::Hit &hit : result.hits) {
+        new QTreeWidgetItem(item, {tr("%1: %2").arg(hit.line + 1).arg(hit.text.simplified())});
+    }
+}
@@ -1,4 +1,5 @@
 #include "fileitemdelegate.h"
+#include "GroupManager.h"
 #include <QMouseEvent>
 
 FileItemDelegate::FileItemDelegate(QObject *parent) : QStyledItemDelegate(parent) {}
@@ -8,6 +9,24 @@ void FileItemDelegate::paint(QPainter *painter, const QStyleOptionViewItem &opti
 
     //Drawing X on the right side
     painter->drawText(option.rect.adjusted(option.rect.width() - 20, 0, -5, 0), Qt::AlignRight | Qt::AlignVCenter, "x");
+
+    // Badge with the occurrences found by the last group search, left of the X
+    QVariant hitCount = index.data(GroupManager::HitCountRole);
+    if (hitCount.isValid() && hitCount.toLongLong() > 0) {
+        QString text = QString::number(hitCount.toLongLong());
+        int width = option.fontMetrics.horizontalAdvance(text) + 10;
+        int height = option.fontMetrics.height();
+        QRect badgeRect(option.rect.right() - 24 - width, option.rect.center().y() - height / 2, width, height);
+
+        painter->save();
+        painter->setRenderHint(QPainter::Antialiasing);
+        painter->setPen(Qt::NoPen);
+        painter->setBrush(option.palette.highlight());
+        painter->drawRoundedRect(badgeRect, height / 2.0, height / 2.0);
+        painter->setPen(option.palette.highlightedText().color());
+        painter->drawText(badgeRect, Qt::AlignCenter, text);
+        painter->restore();
+    }
 }
 
 bool FileItemDelegate::editorEvent(QEvent *event, QAbstractItemModel *model, const QStyleOptionViewItem &option, const QModelIndex &index) {
@@ -7,12 +7,25 @@ FindDialog::FindDialog(QWidget *parent) : QDialog(parent), layout() {
     findPreviousButton = new QPushButton("Find Previous", this);
     findAllButton = new QPushButton("Find All", this);
     caseSensitiveCheckBox = new QCheckBox("Case Sensitive", this);
+    regularExpressionCheckBox = new QCheckBox("Regular Expression", this);
+    scopeComboBox = new QComboBox(this);
+    scopeComboBox->addItem("Find All in Current File", CurrentFile);
+    scopeComboBox->addItem("Find All in Current Group", CurrentGroup);
+    scopeComboBox->addItem("Find All in All Groups", AllGroups);
+    orderByTimestampCheckBox = new QCheckBox("Order by Timestamp", this);
+    orderByTimestampCheckBox->setEnabled(false); // Only lines of several files are merged
+    statusLabel = new QLabel(this);
+    statusLabel->hide();
 
     layout.addWidget(lineEdit);
     layout.addWidget(findNextButton);
     layout.addWidget(findPreviousButton);
     layout.addWidget(findAllButton);
     layout.addWidget(caseSensitiveCheckBox);
+    layout.addWidget(regularExpressionCheckBox);
+    layout.addWidget(scopeComboBox);
+    layout.addWidget(orderByTimestampCheckBox);
+    layout.addWidget(statusLabel);
     setLayout(&layout);
 
     connect(findNextButton, &QPushButton::clicked, this, [this](){
@@ -27,4 +40,41 @@ FindDialog::FindDialog(QWidget *parent) : QDialog(parent), layout() {
     connect(caseSensitiveCheckBox, &QCheckBox::stateChanged, this, [this](int state){
         emit caseSensitivityChanged(state == Qt::Checked);
     });
+    connect(regularExpressionCheckBox, &QCheckBox::stateChanged, this, [this](int state){
+        emit regularExpressionChanged(state == Qt::Checked);
+    });
+    connect(scopeComboBox, qOverload<int>(&QComboBox::currentIndexChanged), this, [this](){
+        orderByTimestampCheckBox->setEnabled(scope() != CurrentFile);
+    });
+
+    // Every change restarts the delay, so only the text the user paused at is searched
+    liveSearchTimer.setSingleShot(true);
+    liveSearchTimer.setInterval(liveSearchDelay);
+    connect(&liveSearchTimer, &QTimer::timeout, this, [this](){
+        emit searchTextChanged(lineEdit->text());
+    });
+    connect(lineEdit, &QLineEdit::textEdited, &liveSearchTimer, qOverload<>(&QTimer::start));
+    connect(caseSensitiveCheckBox, &QCheckBox::stateChanged, &liveSearchTimer, qOverload<>(&QTimer::start));
+    connect(regularExpressionCheckBox, &QCheckBox::stateChanged, &liveSearchTimer, qOverload<>(&QTimer::start));
+}
+
+FindDialog::Scope FindDialog::scope() const {
+    return static_cast<Scope>(scopeComboBox->currentData().toInt());
+}
+
+bool FindDialog::orderByTimestamp() const {
+    return orderByTimestampCheckBox->isChecked();
+}
+
+QString FindDialog::text() const {
+    return lineEdit->text();
+}
+
+void FindDialog::setText(const QString &text) {
+    lineEdit->setText(text);
+}
+
+void FindDialog::setStatus(const QString &status) {
+    statusLabel->setText(status);
+    statusLabel->setVisible(!status.isEmpty());
 }
@@ -0,0 +1,54 @@
+#include "gotodialog.h"
+#include <QRegularExpression>
+#include "TimestampParser.h"
+
+GoToDialog::GoToDialog(QWidget *parent) : QDialog(parent), layout() {
+    setWindowTitle(tr("Go To"));
+    lineEdit = new QLineEdit(this);
+    lineEdit->setPlaceholderText(tr("12345678 or 2024-03-01 14:05:00"));
+    hintLabel = new QLabel(tr("Enter a line number or a timestamp."), this);
+    goButton = new QPushButton(tr("Go"), this);
+    goButton->setDefault(true);
+
+    layout.addWidget(lineEdit);
+    layout.addWidget(hintLabel);
+    layout.addWidget(goButton);
+    setLayout(&layout);
+
+    connect(goButton, &QPushButton::clicked, this, &GoToDialog::go);
+}
+
+void GoToDialog::go() {
+    const QString text = lineEdit->text().trimmed();
+    static const QRegularExpression separators("[\\s,.'_]");
+    static const QRegularExpression dateOnly("^\\d{4}-\\d{2}-\\d{2}$");
+    static const QRegularExpression withoutSeconds("^\\d{4}-\\d{2}-\\d{2}[ T]\\d{2}:\\d{2}$");
+
+    bool isNumber = false;
+    const qint64 number = QString(text).remove(separators).toLongLong(&isNumber);
+    if (isNumber && !text.contains(QLatin1Char('-'))) {
+        if (number < 1) {
+            hintLabel->setText(tr("Lines are numbered from 1."));
+            return;
+        }
+        emit goToLine(number - 1);
+        accept();
+        return;
+    }
+
+    // Dates and times without seconds are completed to the format the parser expects
+    QString timestamp = text;
+    if (dateOnly.match(text).hasMatch()) {
+        timestamp += " 00:00:00";
+    } else if (withoutSeconds.match(text).hasMatch()) {
+        timestamp += ":00";
+    }
+    const QByteArray bytes = timestamp.toUtf8();
+    const qint64 msecs = TimestampParser::parse(bytes.constData(), bytes.size());
+    if (msecs == TimestampParser::NoTimestamp) {
+        hintLabel->setText(tr("\"%1\" is neither a line number nor a timestamp like 2024-03-01 14:05:00.").arg(text));
+        return;
+    }
+    emit goToTimestamp(msecs);
+    accept();
+}
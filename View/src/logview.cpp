@@ -0,0 +1,558 @@
+#include "logview.h"
+#include <QPainter>
+#include <QScrollBar>
+#include <QMouseEvent>
+#include <QKeyEvent>
+#include <QContextMenuEvent>
+#include <QApplication>
+#include <QClipboard>
+#include <QMenu>
+#include <limits>
+
+namespace {
+const int pollIntervalMs = 250;     // Refresh interval while the source is being indexed
+const int autoScrollIntervalMs = 50; // Scroll interval while selecting outside the viewport
+const int maxScrollValue = std::numeric_limits<int>::max();
+
+// Colors of the token kinds, in LineLexer::Kind order; mid tones that read on light and dark backgrounds
+const QColor tokenColors[LineLexer::KindCount] = {
+    QColor(0xE5, 0x39, 0x35), // Error
+    QColor(0xF5, 0x7C, 0x00), // Warning
+    QColor(0x43, 0xA0, 0x47), // Info
+    QColor(0x8E, 0x8E, 0x8E), // Debug
+    QColor(0x1E, 0x88, 0xE5), // Timestamp
+    QColor(0xAB, 0x47, 0xBC), // Address
+    QColor(0xAB, 0x47, 0xBC), // Uuid
+    QColor(0x00, 0xAC, 0xC1), // Number
+};
+
+bool isWordCharacter(QChar character) {
+    return character.isLetterOrNumber() || character == QLatin1Char('_');
+}
+}
+
+LogView::LogView(QWidget *parent) : QAbstractScrollArea(parent) {
+    setFocusPolicy(Qt::StrongFocus);
+    viewport()->setCursor(Qt::IBeamCursor);
+    verticalScrollBar()->setSingleStep(1);
+    updateMetrics();
+
+    autoScrollTimer.setInterval(autoScrollIntervalMs);
+    connect(&autoScrollTimer, &QTimer::timeout, this, [this]() {
+        extendSelection(viewport()->mapFromGlobal(QCursor::pos()));
+    });
+    pollTimer.setInterval(pollIntervalMs);
+    connect(&pollTimer, &QTimer::timeout, this, &LogView::refresh);
+}
+
+qint64 LogView::State::cost() const {
+    qint64 bytes = sizeof(State);
+    for (const QString &row : rows) {
+        bytes += sizeof(QString) + row.size() * sizeof(QChar);
+    }
+    return bytes;
+}
+
+void LogView::setSource(const QSharedPointer<LogSource> &source) {
+    setSource(source, State());
+}
+
+void LogView::setSource(const QSharedPointer<LogSource> &source, const State &state) {
+    logSource = source;
+    lines = source ? source->lineCount() : 0;
+    estimatedLines = source ? source->estimatedLineCount() : 0;
+    rowsFirst = state.rowsFirst;
+    rows = source ? state.rows : QStringList();
+    resetTokens();
+    if (lines != state.lines) {
+        dropRowsFrom(state.lines - 1); // The last line may have been unterminated when the state was saved
+    }
+    anchor = state.anchor.line < lines && state.cursor.line < lines ? state.anchor : Position();
+    cursor = state.anchor.line < lines && state.cursor.line < lines ? state.cursor : Position();
+    selecting = false;
+    updateScrollBars();
+    verticalScrollBar()->setValue(static_cast<int>(qBound<qint64>(0, state.firstLine, maxScrollValue)));
+    horizontalScrollBar()->setValue(state.horizontalOffset);
+    if (source && !source->isIndexComplete()) {
+        pollTimer.start();
+    } else {
+        pollTimer.stop();
+    }
+    viewport()->update();
+    emit selectionChanged();
+}
+
+LogView::State LogView::saveState() const {
+    State state;
+    state.firstLine = firstVisibleLine();
+    state.horizontalOffset = horizontalScrollBar()->value();
+    state.anchor = anchor;
+    state.cursor = cursor;
+    state.lines = lines;
+    state.rowsFirst = rowsFirst;
+    state.rows = rows;
+    return state;
+}
+
+QSharedPointer<LogSource> LogView::source() const {
+    return logSource;
+}
+
+void LogView::clear() {
+    setSource(QSharedPointer<LogSource>());
+}
+
+void LogView::refresh() {
+    if (!logSource) {
+        return;
+    }
+    if (logSource->isIndexComplete()) {
+        pollTimer.stop();
+    }
+
+    QScrollBar *scrollBar = verticalScrollBar();
+    const bool atEnd = scrollBar->maximum() > 0 && scrollBar->value() == scrollBar->maximum();
+    const qint64 previousLines = lines;
+    lines = logSource->lineCount();
+    estimatedLines = logSource->estimatedLineCount();
+    if (lines != previousLines) {
+        dropRowsFrom(qMin(previousLines, lines) - 1); // Appending may have completed the last line
+    }
+    if (cursor.line >= lines || anchor.line >= lines) {
+        anchor = Position(); // The file was truncated under the selection
+        cursor = Position();
+        emit selectionChanged();
+    }
+    updateScrollBars();
+    if (atEnd) {
+        scrollBar->setValue(scrollBar->maximum()); // Keep tailing if the user was at the end
+    }
+    viewport()->update();
+}
+
+void LogView::setHighlighting(bool enabled) {
+    highlight = enabled;
+    viewport()->update();
+}
+
+bool LogView::highlighting() const {
+    return highlight;
+}
+
+qint64 LogView::firstVisibleLine() const {
+    return verticalScrollBar()->value();
+}
+
+void LogView::ensureLineVisible(qint64 line) {
+    const qint64 first = firstVisibleLine();
+    if (line < first || line >= first + visibleRows()) {
+        verticalScrollBar()->setValue(static_cast<int>(qBound<qint64>(0, line - visibleRows() / 2, maxScrollValue)));
+    }
+}
+
+void LogView::setSelection(qint64 line, int column, int length) {
+    anchor = Position{line, column};
+    cursor = Position{line, column + length};
+    ensureLineVisible(line);
+
+    // Bring the selected columns into view as well
+    const int left = column * charWidth;
+    const int right = (column + length) * charWidth;
+    QScrollBar *scrollBar = horizontalScrollBar();
+    if (left < scrollBar->value() || right > scrollBar->value() + viewport()->width()) {
+        scrollBar->setValue(qMax(0, left - viewport()->width() / 4));
+    }
+    viewport()->update();
+    emit selectionChanged();
+}
+
+bool LogView::hasSelection() const {
+    return anchor.line >= 0 && !(anchor == cursor);
+}
+
+LogView::Position LogView::selectionStart() const {
+    return cursor < anchor ? cursor : anchor;
+}
+
+LogView::Position LogView::selectionEnd() const {
+    return cursor < anchor ? anchor : cursor;
+}
+
+QString LogView::selectedText() const {
+    if (!hasSelection() || !logSource) {
+        return QString();
+    }
+    const Position start = selectionStart();
+    const Position end = selectionEnd();
+    if (start.line == end.line) {
+        return lineText(start.line).mid(start.column, end.column - start.column);
+    }
+
+    QString text = lineText(start.line).mid(start.column);
+    for (qint64 line = start.line + 1; line < end.line; ++line) {
+        text += QLatin1Char('\n');
+        text += lineText(line);
+    }
+    text += QLatin1Char('\n');
+    text += lineText(end.line).left(end.column);
+    return text;
+}
+
+void LogView::copy() {
+    if (hasSelection()) {
+        QApplication::clipboard()->setText(selectedText());
+    }
+}
+
+void LogView::selectAll() {
+    if (lines == 0) {
+        return;
+    }
+    anchor = Position{0, 0};
+    cursor = Position{lines - 1, lineText(lines - 1).size()};
+    viewport()->update();
+    emit selectionChanged();
+}
+
+void LogView::updateMetrics() {
+    const QFontMetrics metrics(font());
+    lineHeight = qMax(1, metrics.lineSpacing());
+    charWidth = qMax(1, metrics.horizontalAdvance(QLatin1Char('M')));
+    ascent = metrics.ascent();
+    verticalScrollBar()->setSingleStep(1);
+    horizontalScrollBar()->setSingleStep(charWidth);
+    updateScrollBars();
+}
+
+void LogView::updateScrollBars() {
+    const int pageRows = visibleRows();
+    QScrollBar *vertical = verticalScrollBar();
+    vertical->setPageStep(pageRows);
+    vertical->setRange(0, static_cast<int>(qBound<qint64>(0, estimatedLines - pageRows, maxScrollValue)));
+
+    const qint64 longest = logSource ? logSource->longestLine() : 0;
+    const qint64 contentWidth = (longest + 1) * charWidth;
+    QScrollBar *horizontal = horizontalScrollBar();
+    horizontal->setPageStep(viewport()->width());
+    horizontal->setRange(0, static_cast<int>(qBound<qint64>(0, contentWidth - viewport()->width(), maxScrollValue)));
+}
+
+int LogView::visibleRows() const {
+    return qMax(1, viewport()->height() / lineHeight);
+}
+
+LogView::Position LogView::positionAt(const QPoint &point) const {
+    if (lines == 0) {
+        return Position();
+    }
+    const qint64 row = point.y() < 0 ? -1 : point.y() / lineHeight;
+    const qint64 line = qBound<qint64>(0, firstVisibleLine() + row, lines - 1);
+    const qint64 x = qMax<qint64>(0, point.x() + horizontalScrollBar()->value());
+    const int length = lineText(line).size();
+    const int column = static_cast<int>(qMin<qint64>((x + charWidth / 2) / charWidth, length));
+    return Position{line, column};
+}
+
+QString LogView::lineText(qint64 line) const {
+    if (!logSource || line < 0 || line >= lines) {
+        return QString();
+    }
+    if (line >= rowsFirst && line < rowsFirst + rows.size()) {
+        return rows.at(line - rowsFirst);
+    }
+    return logSource->lineText(line);
+}
+
+void LogView::decodeRows(qint64 first, int count) const {
+    const qint64 end = qMin(first + count, lines);
+    if (!logSource || end <= first || (first >= rowsFirst && end <= rowsFirst + rows.size())) {
+        return;
+    }
+    rowsFirst = qMax<qint64>(0, first - count);
+    rows = logSource->lineTexts(rowsFirst, end + count - rowsFirst);
+    resetTokens();
+}
+
+void LogView::resetTokens() const {
+    rowTokens.fill(LineLexer::Tokens(), rows.size());
+    rowLexed.fill(false, rows.size());
+}
+
+const LineLexer::Tokens &LogView::tokensAt(qint64 line) const {
+    static const LineLexer::Tokens none;
+    const qint64 row = line - rowsFirst;
+    if (row < 0 || row >= rows.size()) {
+        return none; // Not decoded, e.g. because the source shrank since the last refresh
+    }
+    if (!rowLexed.testBit(row)) {
+        rowTokens[row] = LineLexer::tokenize(rows.at(row));
+        rowLexed.setBit(row);
+    }
+    return rowTokens.at(row);
+}
+
+void LogView::drawRow(QPainter &painter, int x, int y, const QString &visible, int firstColumn,
+                      const LineLexer::Tokens &tokens, const QColor &color) const {
+    int column = 0; // Visible columns drawn so far
+    for (const LineLexer::Token &token : tokens) {
+        const int from = qMax(token.start - firstColumn, column);
+        const int to = qMin(token.start + token.length - firstColumn, static_cast<int>(visible.size()));
+        if (to <= from) {
+            if (from >= visible.size()) {
+                break;
+            }
+            continue;
+        }
+        if (from > column) {
+            painter.setPen(color);
+            painter.drawText(x + column * charWidth, y, visible.mid(column, from - column));
+        }
+        painter.setPen(tokenColors[token.kind]);
+        painter.drawText(x + from * charWidth, y, visible.mid(from, to - from));
+        column = to;
+    }
+    if (column < visible.size()) {
+        painter.setPen(color);
+        painter.drawText(x + column * charWidth, y, visible.mid(column));
+    }
+}
+
+QStringList LogView::previewRows(qint64 first, int count) const {
+    if (!logSource || lines == 0) {
+        return QStringList(); // Nothing to estimate line lengths from yet
+    }
+    const qint64 indexed = logSource->indexedSize();
+    const double bytesPerLine = static_cast<double>(indexed) / lines;
+    const qint64 offset = indexed + static_cast<qint64>((first - lines) * bytesPerLine);
+    return logSource->previewLines(offset, count);
+}
+
+void LogView::dropRowsFrom(qint64 line) {
+    const qint64 keep = qBound<qint64>(0, line - rowsFirst, rows.size());
+    rows.erase(rows.begin() + keep, rows.end());
+    rowTokens.resize(keep);
+    rowLexed.resize(keep);
+}
+
+void LogView::extendSelection(const QPoint &point) {
+    // Dragging past the top or bottom scrolls a line per tick
+    if (point.y() < 0) {
+        verticalScrollBar()->setValue(verticalScrollBar()->value() - 1);
+    } else if (point.y() > viewport()->height()) {
+        verticalScrollBar()->setValue(verticalScrollBar()->value() + 1);
+    }
+
+    const Position position = positionAt(point);
+    if (position.line >= 0 && !(position == cursor)) {
+        cursor = position;
+        viewport()->update();
+        emit selectionChanged();
+    }
+}
+
+void LogView::paintEvent(QPaintEvent *event) {
+    Q_UNUSED(event);
+    if (!logSource || estimatedLines == 0) {
+        return;
+    }
+
+    QPainter painter(viewport());
+    painter.setFont(font());
+    const QPalette &colors = palette();
+    const qint64 first = firstVisibleLine();
+    const int rowCount = static_cast<int>(qMin<qint64>(viewport()->height() / lineHeight + 1, estimatedLines - first));
+    const int indexedRows = static_cast<int>(qBound<qint64>(0, lines - first, rowCount));
+    decodeRows(first, indexedRows);
+
+    // Only the columns on screen are drawn, however long the lines are
+    const int xOffset = horizontalScrollBar()->value();
+    const int firstColumn = xOffset / charWidth;
+    const int columns = viewport()->width() / charWidth + 2;
+    const int x = firstColumn * charWidth - xOffset;
+
+    const bool selected = hasSelection();
+    const Position start = selectionStart();
+    const Position end = selectionEnd();
+    // Rows the index has not reached yet are previewed, dimmed, until it does
+    const QStringList preview = indexedRows < rowCount ? previewRows(first + indexedRows, rowCount - indexedRows) : QStringList();
+    for (int row = 0; row < rowCount; ++row) {
+        const qint64 line = first + row;
+        const int y = row * lineHeight;
+        const bool indexed = row < indexedRows;
+        const QString text = indexed ? lineText(line) : preview.value(row - indexedRows);
+        QString visible = text.mid(firstColumn, columns);
+        visible.replace(QLatin1Char('\t'), QLatin1Char(' ')); // Tabs would break the fixed advance
+
+        if (indexed && highlight) {
+            drawRow(painter, x, y + ascent, visible, firstColumn, tokensAt(line), colors.color(QPalette::Text));
+        } else {
+            painter.setPen(colors.color(indexed ? QPalette::Text : QPalette::PlaceholderText));
+            painter.drawText(x, y + ascent, visible);
+        }
+
+        if (selected && line >= start.line && line <= end.line) {
+            // The line break counts as selected on all but the last line
+            const int from = line == start.line ? start.column : 0;
+            const int to = line == end.line ? end.column : text.size() + 1;
+            const QRect selection(from * charWidth - xOffset, y, (to - from) * charWidth, lineHeight);
+            painter.save();
+            painter.fillRect(selection, colors.brush(QPalette::Highlight));
+            painter.setClipRect(selection);
+            painter.setPen(colors.color(QPalette::HighlightedText));
+            painter.drawText(x, y + ascent, visible);
+            painter.restore();
+        }
+    }
+}
+
+void LogView::resizeEvent(QResizeEvent *event) {
+    QAbstractScrollArea::resizeEvent(event);
+    updateScrollBars();
+}
+
+void LogView::changeEvent(QEvent *event) {
+    QAbstractScrollArea::changeEvent(event);
+    if (event->type() == QEvent::FontChange) {
+        updateMetrics();
+        viewport()->update();
+    }
+}
+
+void LogView::scrollContentsBy(int dx, int dy) {
+    Q_UNUSED(dx);
+    Q_UNUSED(dy);
+    viewport()->update(); // Rows are decoded per paint, there is nothing to move
+}
+
+void LogView::mousePressEvent(QMouseEvent *event) {
+    if (event->button() != Qt::LeftButton) {
+        QAbstractScrollArea::mousePressEvent(event);
+        return;
+    }
+
+    const Position position = positionAt(event->pos());
+    if (position.line < 0) {
+        return;
+    }
+    if (event->modifiers() & Qt::ControlModifier) {
+        emit ctrlClicked(lineText(position.line));
+        return;
+    }
+
+    if (event->modifiers() & Qt::ShiftModifier && anchor.line >= 0) {
+        cursor = position;
+    } else {
+        anchor = position;
+        cursor = position;
+    }
+    selecting = true;
+    viewport()->update();
+    emit selectionChanged();
+}
+
+void LogView::mouseMoveEvent(QMouseEvent *event) {
+    if (!selecting) {
+        QAbstractScrollArea::mouseMoveEvent(event);
+        return;
+    }
+
+    extendSelection(event->pos());
+    const bool outside = event->pos().y() < 0 || event->pos().y() > viewport()->height();
+    if (outside && !autoScrollTimer.isActive()) {
+        autoScrollTimer.start();
+    } else if (!outside) {
+        autoScrollTimer.stop();
+    }
+}
+
+void LogView::mouseReleaseEvent(QMouseEvent *event) {
+    if (event->button() == Qt::LeftButton) {
+        selecting = false;
+        autoScrollTimer.stop();
+    }
+    QAbstractScrollArea::mouseReleaseEvent(event);
+}
+
+void LogView::mouseDoubleClickEvent(QMouseEvent *event) {
+    if (event->button() != Qt::LeftButton || (event->modifiers() & Qt::ControlModifier)) {
+        QAbstractScrollArea::mouseDoubleClickEvent(event);
+        return;
+    }
+
+    // Select the word under the mouse
+    const Position position = positionAt(event->pos());
+    if (position.line < 0) {
+        return;
+    }
+    const QString text = lineText(position.line);
+    int from = position.column;
+    int to = position.column;
+    while (from > 0 && isWordCharacter(text.at(from - 1))) {
+        --from;
+    }
+    while (to < text.size() && isWordCharacter(text.at(to))) {
+        ++to;
+    }
+    anchor = Position{position.line, from};
+    cursor = Position{position.line, to};
+    viewport()->update();
+    emit selectionChanged();
+}
+
+void LogView::keyPressEvent(QKeyEvent *event) {
+    if (event == QKeySequence::Copy) {
+        copy();
+        return;
+    }
+    if (event == QKeySequence::SelectAll) {
+        selectAll();
+        return;
+    }
+
+    QScrollBar *vertical = verticalScrollBar();
+    QScrollBar *horizontal = horizontalScrollBar();
+    switch (event->key()) {
+    case Qt::Key_Up:
+        vertical->triggerAction(QAbstractSlider::SliderSingleStepSub);
+        break;
+    case Qt::Key_Down:
+        vertical->triggerAction(QAbstractSlider::SliderSingleStepAdd);
+        break;
+    case Qt::Key_PageUp:
+        vertical->triggerAction(QAbstractSlider::SliderPageStepSub);
+        break;
+    case Qt::Key_PageDown:
+        vertical->triggerAction(QAbstractSlider::SliderPageStepAdd);
+        break;
+    case Qt::Key_Left:
+        horizontal->triggerAction(QAbstractSlider::SliderSingleStepSub);
+        break;
+    case Qt::Key_Right:
+        horizontal->triggerAction(QAbstractSlider::SliderSingleStepAdd);
+        break;
+    case Qt::Key_Home:
+        if (event->modifiers() & Qt::ControlModifier) {
+            vertical->setValue(0);
+        }
+        horizontal->setValue(0);
+        break;
+    case Qt::Key_End:
+        if (event->modifiers() & Qt::ControlModifier) {
+            vertical->setValue(vertical->maximum());
+        }
+        break;
+    default:
+        QAbstractScrollArea::keyPressEvent(event);
+    }
+}
+
+void LogView::contextMenuEvent(QContextMenuEvent *event) {
+    QMenu menu(this);
+    QAction *copyAction = menu.addAction(tr("&Copy"), this, &LogView::copy);
+    copyAction->setShortcut(QKeySequence::Copy);
+    copyAction->setEnabled(hasSelection());
+    QAction *selectAllAction = menu.addAction(tr("Select &All"), this, &LogView::selectAll);
+    selectAllAction->setShortcut(QKeySequence::SelectAll);
+    selectAllAction->setEnabled(lines > 0);
+    menu.exec(event->globalPos());
+}
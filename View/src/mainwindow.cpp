@@ -5,6 +5,7 @@
 #include "HelpDialog.h"
 #include <QFileDialog>
 #include <QFile>
+#include <QFileInfo>
 #include <QIODevice>
 #include <QTextStream>
 #include <QInputDialog>
@@ -20,19 +21,30 @@
 #include <algorithm>
 #include <KArchive>
 #include <KZip>
-#include <KTar>
 #include <QStandardPaths>
 #include <QTextDocumentFragment>
 #include <QTextBlock>
 #include <QDateTime>
 #include <QRegularExpression>
+#include <QProgressBar>
+#include <QLabel>
+#include <QPushButton>
+#include <QStatusBar>
+#include <QScrollBar>
+#include <QMenu>
+#include <QDirIterator>
+#include <QProgressDialog>
+#include <QLocale>
+#include <memory>
+#include "LineMatcher.h"
 
 MainWindow::MainWindow(QWidget *parent)
     : QMainWindow(parent),
     ui(new Ui::MainWindow),
     model(new QStandardItemModel(this)),
     logManager(new LogManager),
-    groupManager(new GroupManager(model, this)) {
+    groupManager(new GroupManager(model, this)),
+    viewStates(defaultViewCacheSize) {
     ui->setupUi(this);
     initializeTreeView();
     initializeFonts();
@@ -44,7 +56,9 @@ MainWindow::MainWindow(QWidget *parent)
     setupSecondaryTextEditConnections();
     setupTextEdit();
     setupFindDialog();
+    setupGoToDialog();
     setupGroupLogConnections();
+    setupStatusBar();
 }
 
 // Destructor
@@ -65,8 +79,9 @@ void MainWindow::initializeTreeView() {
 // Initialize font settings for text edits
 void MainWindow::initializeFonts() {
     QFont monospaceFont("Courier New", 14);
-    ui->textEditPrimary->setFont(monospaceFont);
+    ui->logView->setFont(monospaceFont);
     ui->textEditSecondary->setFont(monospaceFont);
+    ui->findResultsView->setFont(monospaceFont);
 }
 
 // Setup menu bar and actions
@@ -80,6 +95,10 @@ void MainWindow::setupMenuBar() {
     fileMenu->addAction(openLogsAction);
     connect(openLogsAction, &QAction::triggered, this, &MainWindow::on_actionOpen_triggered);
 
+    QAction *openFolderAction = new QAction(tr("Open &Folder"), this);
+    fileMenu->addAction(openFolderAction);
+    connect(openFolderAction, &QAction::triggered, this, &MainWindow::on_openFolder_triggered);
+
     QAction *openEditableLogAction = new QAction(tr("Open &Editable Log"), this);
     fileMenu->addAction(openEditableLogAction);
     connect(openEditableLogAction, &QAction::triggered, this, &MainWindow::on_openEditableLog_triggered);
@@ -98,6 +117,17 @@ void MainWindow::setupMenuBar() {
     viewMenu->addAction(changeFontSizeAction);
     connect(changeFontSizeAction, &QAction::triggered, this, &MainWindow::onChangeFontSizeTriggered);
 
+    // Created once, as retranslateUi() rebuilds the menus but must keep its checked state
+    highlightLevelsAction = new QAction(tr("&Highlight Levels and Values"), this);
+    highlightLevelsAction->setCheckable(true);
+    highlightLevelsAction->setChecked(true);
+    viewMenu->addAction(highlightLevelsAction);
+    connect(highlightLevelsAction, &QAction::toggled, ui->logView, &LogView::setHighlighting);
+
+    QAction *viewCacheSizeAction = new QAction(tr("View Cache &Size..."), this);
+    viewMenu->addAction(viewCacheSizeAction);
+    connect(viewCacheSizeAction, &QAction::triggered, this, &MainWindow::onViewCacheSizeTriggered);
+
     QAction *toggleViewAction = new QAction(tr("Toggle Find Results"), this);
     toggleViewAction->setCheckable(true);
     connect(toggleViewAction, &QAction::toggled, this, &MainWindow::toggleFindResults);
@@ -175,9 +205,11 @@ void MainWindow::setupDelegatesAndConnections() {
     ui->treeView->setItemDelegate(delegate);
 
     connect(ui->treeView, &QTreeView::clicked, this, &MainWindow::onTreeViewClicked);
+    ui->treeView->setContextMenuPolicy(Qt::CustomContextMenu);
+    connect(ui->treeView, &QTreeView::customContextMenuRequested, this, &MainWindow::onTreeViewContextMenuRequested);
     connect(delegate, &FileItemDelegate::closeFileRequested, this, &MainWindow::onCloseFileRequested);
     connect(delegate, &FileItemDelegate::closeGroupRequested, this, &MainWindow::onCloseGroupRequested);
-    connect(ui->textEditPrimary, &ClickableTextEdit::ctrlClicked, this, &MainWindow::onTextEditPrimaryCtrlClicked);
+    connect(ui->logView, &LogView::ctrlClicked, this, &MainWindow::onLogViewCtrlClicked);
 }
 
 void MainWindow::setupFindDialog() {
@@ -187,8 +219,33 @@ void MainWindow::setupFindDialog() {
     connect(findDialog, &FindDialog::findNext, this, &MainWindow::findNext);
     connect(findDialog, &FindDialog::findPrevious, this, &MainWindow::findPrevious);
     connect(findDialog, &FindDialog::caseSensitivityChanged, this, &MainWindow::updateCaseSensitivity);
+    connect(findDialog, &FindDialog::regularExpressionChanged, this, &MainWindow::updateRegularExpressionSearch);
     connect(findDialog, &FindDialog::findAll, this, &MainWindow::findAllInDocument);
 
+    findResultsModel = new FindResultsModel(this);
+    ui->findResultsView->setModel(findResultsModel);
+    connect(ui->findResultsView, &QListView::clicked, this, &MainWindow::onFindResultClicked);
+    connect(findDialog, &FindDialog::searchTextChanged, this, &MainWindow::onSearchTextChanged);
+
+    logSearch = new LogSearch(this);
+    connect(logSearch, &LogSearch::finished, this, &MainWindow::onLogSearchFinished);
+    stepSearch = new LogSearch(this);
+    connect(stepSearch, &LogSearch::finished, this, &MainWindow::onStepSearchFinished);
+    connect(logSearch, &LogSearch::progress, this, [this](int chunksDone, int chunksTotal, qint64 hitsFound) {
+        findDialog->setStatus(tr("%1 matches so far (%2%)").arg(hitsFound).arg(chunksDone * 100 / qMax(chunksTotal, 1)));
+        if (findAllRequested) {
+            ui->statusbar->showMessage(tr("Finding all: %1%").arg(chunksDone * 100 / qMax(chunksTotal, 1)));
+        }
+    });
+
+    groupSearch = new GroupSearch(this);
+    connect(groupSearch, &GroupSearch::finished, this, &MainWindow::onGroupSearchFinished);
+    connect(groupSearch, &GroupSearch::fileSearched, groupManager, &GroupManager::setHitCount);
+    connect(groupSearch, &GroupSearch::progress, this, [this](int filesDone, int filesTotal, qint64 hitsFound) {
+        findDialog->setStatus(tr("%1 matches so far (%2 of %3 files)").arg(hitsFound).arg(filesDone).arg(filesTotal));
+        ui->statusbar->showMessage(tr("Finding all: %1 of %2 files").arg(filesDone).arg(filesTotal));
+    });
+
     // Action to open dialog on Ctrl+F
     QAction *openFindDialogAction = new QAction(this);
     openFindDialogAction->setShortcut(QKeySequence("Ctrl+F"));
@@ -197,32 +254,75 @@ void MainWindow::setupFindDialog() {
 }
 
 void MainWindow::on_actionOpen_triggered() {
-    QString filter = "All supported files (*.txt *.log *.zip);;Text files (*.txt);;Log files (*.log);;ZIP archives (*.zip);;All files (*.*)";
+    QString filter = "All supported files (*.txt *.log *.zip *.tar *.tgz *.tbz2 *.txz *.tzst *.7z *.gz *.bz2 *.xz *.zst);;Text files (*.txt);;Log files (*.log);;"
+                     "Archives (*.zip *.tar *.tar.gz *.tgz *.tar.bz2 *.tbz2 *.tar.xz *.txz *.tar.zst *.tzst *.7z);;Compressed logs (*.gz *.bz2 *.xz *.zst);;All files (*.*)";
     QStringList filePaths = QFileDialog::getOpenFileNames(this, tr("Open Files"), "", filter);
 
     if (!filePaths.isEmpty()) {
         QString groupName = groupManager->promptForGroupNameAndColor();
         if (!groupName.isEmpty()) {
+            QStringList archives;
+            QStringList logFiles;
             for (const QString &filePath : filePaths) {
-                if (filePath.endsWith(".zip")) {
-                    ZipViewerDialog viewer(filePath, this);
-                    if (viewer.exec() == QDialog::Accepted) {
-                        QStringList filesToAdd = viewer.getSelectedFiles();
-                        for (const QString &fileInsideZip : filesToAdd) {
-                            QString tempPath = logManager->extractFileFromZip(filePath, fileInsideZip);
-                            if (!tempPath.isEmpty()) {
-                                groupManager->addToGroup(groupName, QFileInfo(fileInsideZip).fileName(), tempPath);
-                            }
-                        }
-                    }
+                if (ArchiveSession::isArchive(filePath)) {
+                    archives.append(filePath);
                 } else {
-                    logManager->openAndDisplayFile(filePath, groupName);
+                    logFiles.append(filePath);
                 }
             }
+
+            // Plain files load in the background while the archives are listed and the user picks
+            // their entries. The directory is read once, for the dialog and for all selected entries.
+            // TAR archives have none and are read through once, which takes a while for big ones
+            logManager->openFiles(logFiles, groupName);
+            if (!archives.isEmpty() && !archiveProgressDialog->isVisible()) {
+                archiveProgressDialog->setLabelText(tr("Reading %1...").arg(QFileInfo(archives.first()).fileName()));
+                archiveProgressDialog->setValue(0); // Shown if listing takes longer than its minimum duration
+            }
+            for (const QString &filePath : archives) {
+                logManager->openArchive(filePath, groupName);
+            }
         }
     }
 }
 
+void MainWindow::onArchiveOpened(const QSharedPointer<ArchiveSession> &archive, const QString &groupName) {
+    openedArchives.append({archive, groupName});
+    if (pickingArchiveEntries) return; // Asked for once the dialog shown is closed
+
+    // The dialog runs its own event loop, in which more archives may arrive
+    pickingArchiveEntries = true;
+    while (!openedArchives.isEmpty()) {
+        const QPair<QSharedPointer<ArchiveSession>, QString> opened = openedArchives.takeFirst();
+        ZipViewerDialog viewer(opened.first, this);
+        if (viewer.exec() == QDialog::Accepted) {
+            logManager->openArchiveEntries(opened.first, viewer.getSelectedFiles(), opened.second);
+        }
+    }
+    pickingArchiveEntries = false;
+}
+
+void MainWindow::on_openFolder_triggered() {
+    QString directory = QFileDialog::getExistingDirectory(this, tr("Open Folder"));
+    if (directory.isEmpty()) return;
+
+    QStringList filePaths;
+    QDirIterator it(directory, QStringList() << "*.log" << "*.txt" << "*.log.gz" << "*.log.bz2" << "*.log.xz" << "*.log.zst",
+                    QDir::Files, QDirIterator::Subdirectories);
+    while (it.hasNext()) {
+        filePaths.append(it.next());
+    }
+    if (filePaths.isEmpty()) {
+        QMessageBox::information(this, tr("Open Folder"), tr("No log files found in the selected folder."));
+        return;
+    }
+
+    QString groupName = groupManager->promptForGroupNameAndColor();
+    if (!groupName.isEmpty()) {
+        logManager->openFiles(filePaths, groupName);
+    }
+}
+
 QString MainWindow::promptForGroupName() {
     QStringList groups;
     for (int i = 0; i < model->rowCount(); ++i) {
@@ -272,27 +372,89 @@ void MainWindow::onTreeViewClicked(const QModelIndex &index) {
 
     // If parrent exists, that means that file is clicked, else group
     if (item->parent()) {
-        QString filePath = item->data(Qt::UserRole + 1).toString();
-        QFile file(filePath);
-        if (file.open(QIODevice::ReadOnly | QIODevice::Text)) {
-            QTextStream in(&file);
-            ui->textEditPrimary->setPlainText(in.readAll());
-            file.close();
-        } else {
+        if (!showFile(item->data(Qt::UserRole + 1).toString())) {
             QMessageBox::warning(this, tr("Error"), tr("Cannot open file."));
         }
     }
 }
 
+bool MainWindow::showFile(const QString &filePath) {
+    QSharedPointer<LogSource> source = logManager->source(filePath);
+    if (!source) return false;
+    if (filePath == currentOpenFilePath) return true; // Already shown as it is
+
+    logSearch->cancel(); // Find results always belong to the file shown
+    stepSearch->cancel();
+    if (!groupSearch->isRunning()) findDialog->setStatus(QString());
+    saveViewState();
+    std::unique_ptr<FileViewState> state(viewStates.take(filePath));
+    bool keepResults = findResultsModel->isCrossFile(); // Results of a group search belong to no single file
+    if (state) {
+        ui->logView->setSource(source, state->view);
+        findDialog->setText(state->findText);
+        if (!keepResults) findResultsModel->setResults(source, filePath, state->findHits);
+    } else {
+        ui->logView->setSource(source);
+        if (!keepResults) findResultsModel->clear(); // Find results always belong to the file shown
+    }
+    currentOpenFilePath = filePath;
+    updateViewCacheLabel();
+    return true;
+}
+
+void MainWindow::onTreeViewContextMenuRequested(const QPoint &pos) {
+    QModelIndex index = ui->treeView->indexAt(pos);
+    if (!index.isValid() || !index.parent().isValid()) return; // Only files can be followed
+
+    QString filePath = model->data(index, Qt::UserRole + 1).toString();
+    QMenu menu(this);
+    QAction *followAction = menu.addAction(tr("Follow (tail -f)"));
+    followAction->setCheckable(true);
+    followAction->setChecked(logManager->isFollowing(filePath));
+    QSharedPointer<LogSource> source = logManager->source(filePath);
+    followAction->setEnabled(!source || source->isFollowable()); // Compressed files are never appended to in place
+
+    if (menu.exec(ui->treeView->viewport()->mapToGlobal(pos)) != followAction) return;
+
+    bool follow = followAction->isChecked();
+    if (!logManager->setFollowing(filePath, follow)) {
+        QMessageBox::information(this, tr("Follow"), tr("The file can be followed once it has finished loading."));
+        return;
+    }
+
+    // Followed files are shown in italics in every group they belong to
+    for (int i = 0; i < model->rowCount(); ++i) {
+        QStandardItem *groupItem = model->item(i);
+        for (int j = 0; j < groupItem->rowCount(); ++j) {
+            QStandardItem *fileItem = groupItem->child(j);
+            if (fileItem->data(Qt::UserRole + 1).toString() == filePath) {
+                QFont font = fileItem->font();
+                font.setItalic(follow);
+                fileItem->setFont(font);
+            }
+        }
+    }
+}
+
+void MainWindow::onLinesAppended(const QString &filePath, qint64 firstChangedLine) {
+    if (filePath != currentOpenFilePath) return;
+
+    Q_UNUSED(firstChangedLine); // The view only paints visible lines, so it needs no partial update
+    ui->logView->refresh(); // Keeps tailing if the user was at the end
+}
+
 void MainWindow::onCloseFileRequested(const QModelIndex &index) {
     if (!index.isValid()) return;
 
-    QString filePath = model->data(index, Qt::UserRole).toString();
+    QString filePath = model->data(index, Qt::UserRole + 1).toString();
     bool clearTextView = filePath == currentOpenFilePath;
 
     QStandardItem *parentItem = index.parent().isValid() ? model->itemFromIndex(index.parent()) : nullptr;
     if (parentItem) {
+        forgetGroupSearch();
         parentItem->removeRow(index.row());
+        logManager->releaseSource(filePath);
+        forgetViewState(filePath);
         if (parentItem->rowCount() == 0) {
             // If this is the last file in the group, close the whole group
             int groupRow = model->indexFromItem(parentItem).row();
@@ -301,12 +463,15 @@ void MainWindow::onCloseFileRequested(const QModelIndex &index) {
         }
     } else {
         // If there is no parent (meaning it's group), close the whole group
-        model->removeRow(index.row());
+        onCloseGroupRequested(index);
+        return;
     }
 
     if (model->rowCount() == 0 || clearTextView) {
-        ui->textEditPrimary->clear(); // Clear text view if there are no more items left or the opened file was closed
+        ui->logView->clear(); // Clear text view if there are no more items left or the opened file was closed
         currentOpenFilePath.clear();
+        logSearch->cancel();
+        findResultsModel->clear();
     }
 }
 
@@ -317,24 +482,29 @@ void MainWindow::displayError(const QString &error) {
 void MainWindow::onCloseGroupRequested(const QModelIndex &groupIndex) {
     if (!groupIndex.isValid()) return;
 
+    forgetGroupSearch();
     auto groupItem = model->itemFromIndex(groupIndex);
     for (int i = 0; i < groupItem->rowCount(); ++i) {
         auto fileItem = groupItem->child(i);
-        if (fileItem->data(Qt::UserRole).toString() == currentOpenFilePath) {
-            ui->textEditPrimary->clear(); // Clear text view if the currently opened file is within the closing group
+        QString filePath = fileItem->data(Qt::UserRole + 1).toString();
+        if (filePath == currentOpenFilePath) {
+            ui->logView->clear(); // Clear text view if the currently opened file is within the closing group
             currentOpenFilePath.clear();
-            break;
+            logSearch->cancel();
+            findResultsModel->clear();
         }
+        logManager->releaseSource(filePath);
+        forgetViewState(filePath);
     }
 
     model->removeRow(groupIndex.row()); // Remove the group and its children
 
     if (model->rowCount() == 0) {
-        ui->textEditPrimary->clear(); // Clear text view if there are no more items left in the whole model
+        ui->logView->clear(); // Clear text view if there are no more items left in the whole model
     }
 }
 
-void MainWindow::onTextEditPrimaryCtrlClicked(const QString &lineText) {
+void MainWindow::onLogViewCtrlClicked(const QString &lineText) {
     ui->textEditSecondary->append(lineText); // Append - to the bottom of textEditSecondary
 }
 
@@ -342,11 +512,24 @@ void MainWindow::onChangeFontSizeTriggered() {
     bool ok;
     QFont font = QFontDialog::getFont(&ok, this);
     if (ok) {
-        ui->textEditPrimary->setFont(font);
+        ui->logView->setFont(font);
         ui->textEditSecondary->setFont(font);
     }
 }
 
+void MainWindow::onViewCacheSizeTriggered() {
+    const qint64 megabyte = 1024 * 1024;
+    bool ok;
+    int size = QInputDialog::getInt(this, tr("View Cache Size"),
+                                    tr("Memory kept for switching back to recently shown files, in MB\n(%1 in use, 0 disables the cache):")
+                                        .arg(locale().formattedDataSize(viewStates.totalCost())),
+                                    static_cast<int>(viewStates.maxCost() / megabyte), 0, 65536, 16, &ok);
+    if (ok) {
+        viewStates.setMaxCost(size * megabyte); // Evicts the least recently shown files beyond the new budget
+        updateViewCacheLabel();
+    }
+}
+
 void MainWindow::setupTextFormattingActions() {
     QAction *changeColorAction = new QAction(tr("Change Text Color"), this);
     QAction *highlightAction = new QAction(tr("Highlight Text"), this);
@@ -447,8 +630,8 @@ void MainWindow::deleteSelectedLineInSecondary(int position) {
 }
 
 void MainWindow::setupTextEdit() {
-    ui->textEditPrimary->setStyleSheet(
-        "QTextEdit {"
+    ui->logView->setStyleSheet(
+        "LogView {"
         "   selection-background-color: green;" // Selected text color and background
         "   selection-color: white;"
         "}"
@@ -456,111 +639,305 @@ void MainWindow::setupTextEdit() {
 }
 
 void MainWindow::findNext(const QString &text) {
-    QTextDocument::FindFlags flags;
-    if (caseSensitiveSearch) {
-        flags |= QTextDocument::FindCaseSensitively;
-    }
+    QSharedPointer<LogSource> source = ui->logView->source();
+    if (!source || text.isEmpty()) return;
 
-    QTextCursor cursor = ui->textEditPrimary->textCursor();
-    QTextCursor foundCursor = ui->textEditPrimary->document()->find(text, cursor, flags);
+    LineMatcher matcher(text, caseSensitiveSearch ? Qt::CaseSensitive : Qt::CaseInsensitive, regularExpressionSearch);
+    if (!matcher.isValid()) {
+        QMessageBox::warning(this, tr("Invalid Regular Expression"), matcher.errorString());
+        return;
+    }
 
-    if (!foundCursor.isNull()) {
-        ui->textEditPrimary->setTextCursor(foundCursor);
-    } else {
-        QMessageBox::information(this, tr("Text Not Found"), tr("The specified text was not found."));
-        ui->textEditPrimary->setTextCursor(cursor);
+    // The rest of the line the selection ends on is checked here, the following lines by stepSearch
+    LogView::Position from = ui->logView->hasSelection() ? ui->logView->selectionEnd() : LogView::Position();
+    qint64 line = qMax<qint64>(from.line, 0);
+    if (from.line >= 0 && line < source->lineCount() && matcher.mayMatch(source->lineBytes(line))) {
+        qsizetype length = 0;
+        qsizetype found = matcher.indexIn(source->lineText(line), from.column, &length);
+        if (found >= 0) {
+            stepSearch->cancel();
+            ui->logView->setSelection(line, found, length);
+            return;
+        }
+        ++line;
     }
+    stepSearch->cancel(); // Before the members below, which its finished() signal resets
+    stepBackward = false;
+    stepSource = source;
+    ui->statusbar->showMessage(tr("Finding next..."));
+    stepSearch->start(source, matcher, line, -1, LogSearch::Forward, 1);
 }
 
 void MainWindow::findPrevious(const QString &text) {
-    QTextDocument::FindFlags flags = QTextDocument::FindBackward;
-    if (caseSensitiveSearch) {
-        flags |= QTextDocument::FindCaseSensitively;
+    QSharedPointer<LogSource> source = ui->logView->source();
+    if (!source || text.isEmpty()) return;
+
+    LineMatcher matcher(text, caseSensitiveSearch ? Qt::CaseSensitive : Qt::CaseInsensitive, regularExpressionSearch);
+    if (!matcher.isValid()) {
+        QMessageBox::warning(this, tr("Invalid Regular Expression"), matcher.errorString());
+        return;
     }
 
-    QTextCursor cursor = ui->textEditPrimary->textCursor();
-    QTextCursor foundCursor = ui->textEditPrimary->document()->find(text, cursor, flags);
+    // Without a selection the search starts at the top of the view, like the old text cursor did.
+    // The start of the line the selection starts on is checked here, the lines before by stepSearch
+    LogView::Position from = ui->logView->hasSelection() ? ui->logView->selectionStart()
+                                                         : LogView::Position{ui->logView->firstVisibleLine(), 0};
+    if (from.line >= 0 && from.line < source->lineCount() && from.column > 0 && matcher.mayMatch(source->lineBytes(from.line))) {
+        qsizetype length = 0;
+        qsizetype found = matcher.lastIndexIn(source->lineText(from.line), from.column - 1, &length);
+        if (found >= 0) {
+            stepSearch->cancel();
+            ui->logView->setSelection(from.line, found, length);
+            return;
+        }
+    }
+    stepSearch->cancel(); // Before the members below, which its finished() signal resets
+    stepBackward = true;
+    stepSource = source;
+    ui->statusbar->showMessage(tr("Finding previous..."));
+    stepSearch->start(source, matcher, 0, qMax<qint64>(from.line, 0), LogSearch::Backward, 1);
+}
 
-    if (!foundCursor.isNull()) {
-        ui->textEditPrimary->setTextCursor(foundCursor);
-    } else {
-        QMessageBox::information(this, tr("Text Not Found"), tr("No previous occurrence found."));
-        ui->textEditPrimary->setTextCursor(cursor);
+void MainWindow::onStepSearchFinished(bool cancelled) {
+    QSharedPointer<LogSource> source = stepSource;
+    stepSource.reset();
+    if (cancelled) return;
+
+    ui->statusbar->clearMessage();
+    if (!source || source != ui->logView->source()) return; // Another file is shown by now
+
+    const QVector<LogSearch::Hit> &hits = stepSearch->hits();
+    if (hits.isEmpty()) {
+        QMessageBox::information(this, tr("Text Not Found"), stepBackward ? tr("No previous occurrence found.")
+                                                                          : tr("The specified text was not found."));
+        return;
+    }
+    ui->logView->setSelection(hits.first().line, hits.first().column, hits.first().length);
+}
+
+void MainWindow::setupGoToDialog() {
+    goToDialog = new GoToDialog(this);
+    goToDialog->hide();
+
+    connect(goToDialog, &GoToDialog::goToLine, this, &MainWindow::goToLine);
+    connect(goToDialog, &GoToDialog::goToTimestamp, this, &MainWindow::goToTimestamp);
+
+    QAction *openGoToDialogAction = new QAction(this);
+    openGoToDialogAction->setShortcut(QKeySequence("Ctrl+G"));
+    connect(openGoToDialogAction, &QAction::triggered, goToDialog, &QWidget::show);
+    addAction(openGoToDialogAction);
+}
+
+void MainWindow::goToLine(qint64 line) {
+    QSharedPointer<LogSource> source = ui->logView->source();
+    if (!source) return;
+
+    qint64 count = source->lineCount();
+    if (line >= count) {
+        QMessageBox::information(this, tr("Go To"), source->isIndexComplete()
+                                     ? tr("The file has only %1 lines.").arg(count)
+                                     : tr("Line %1 is not loaded yet; %2 lines are available so far.").arg(line + 1).arg(count));
+        return;
+    }
+    ui->logView->setSelection(line, 0, source->lineText(line).size());
+}
+
+void MainWindow::goToTimestamp(qint64 timestamp) {
+    QSharedPointer<LogSource> source = ui->logView->source();
+    if (!source) return;
+
+    qint64 line = source->lineAtTimestamp(timestamp);
+    if (line < 0) {
+        QMessageBox::information(this, tr("Go To"), tr("No line is that late."));
+        return;
     }
+    ui->logView->setSelection(line, 0, source->lineText(line).size());
 }
 
 void MainWindow::updateCaseSensitivity(bool enabled) {
     caseSensitiveSearch = enabled;
 }
 
+void MainWindow::updateRegularExpressionSearch(bool enabled) {
+    regularExpressionSearch = enabled;
+}
+
 void MainWindow::toggleFindResults() {
-    if (isFindResultsDisplayed) {
-        // userContent in textEditSecondary
-        ui->textEditSecondary->setHtml(userContent);
-        ui->textEditSecondary->setReadOnly(false);
-        isFindResultsDisplayed = false;
-    } else {
-        // Find results in textEditSecondary
-        userContent = ui->textEditSecondary->toHtml();
-        ui->textEditSecondary->setHtml(findResults);
-        ui->textEditSecondary->setReadOnly(true);
-        isFindResultsDisplayed = true;
-    }
+    isFindResultsDisplayed = !isFindResultsDisplayed;
+    ui->secondaryStack->setCurrentWidget(isFindResultsDisplayed ? static_cast<QWidget *>(ui->findResultsView)
+                                                                : ui->textEditSecondary);
 }
 
 void MainWindow::findAllInDocument(const QString &text) {
-    QTextDocument *document = ui->textEditPrimary->document();
-    QTextCursor cursor(document);
-    QString formattedResults;
-    bool found = false;
-
-    // CSS needed because of newLines(Now, logs aren't separated with empty new lines).
-    QString style = "<style>p { margin: 0; padding: 0; }</style>";
-
-    while (!cursor.isNull() && !cursor.atEnd()) {
-        cursor = document->find(text, cursor);
-        if (!cursor.isNull() && !cursor.atEnd()) {
-            found = true;
-            QString lineText = cursor.block().text();
-            formattedResults += "<p>" + lineText + "</p>";
+    QSharedPointer<LogSource> source = ui->logView->source();
+    bool inGroups = findDialog->scope() != FindDialog::CurrentFile;
+    if ((!source && !inGroups) || text.isEmpty()) return;
+
+    LineMatcher matcher(text, caseSensitiveSearch ? Qt::CaseSensitive : Qt::CaseInsensitive, regularExpressionSearch);
+    if (!matcher.isValid()) {
+        QMessageBox::warning(this, tr("Invalid Regular Expression"), matcher.errorString());
+        return;
+    }
+    if (inGroups) {
+        findAllInGroups(matcher);
+        return;
+    }
+    groupSearch->cancel();
+    logSearch->cancel(); // Before the members below, which its finished() signal resets
+    findAllSource = source;
+    findAllRequested = true;
+    logSearch->start(source, matcher);
+}
+
+void MainWindow::findAllInGroups(const LineMatcher &matcher) {
+    QStringList filePaths;
+    if (findDialog->scope() == FindDialog::AllGroups) {
+        filePaths = groupManager->allFilePaths();
+    } else {
+        QModelIndex index = ui->treeView->currentIndex();
+        if (index.parent().isValid()) index = index.parent(); // The group of the selected file
+        filePaths = groupManager->filePaths(model->itemFromIndex(index));
+        if (filePaths.isEmpty()) {
+            QMessageBox::information(this, tr("Find All"), tr("Select a group or one of its files in the tree first."));
+            return;
         }
     }
 
-    if (found) {
-        findResults = style + formattedResults;
-        if (!isFindResultsDisplayed) {
-            userContent = ui->textEditSecondary->toHtml();
-            isFindResultsDisplayed = true;
+    QVector<GroupSearch::Target> targets;
+    for (const QString &filePath : std::as_const(filePaths)) {
+        QSharedPointer<LogSource> source = logManager->source(filePath);
+        if (source) {
+            targets.append(GroupSearch::Target{filePath, source}); // Files still loading have no source yet
         }
-        ui->textEditSecondary->setHtml(findResults);
-        ui->textEditSecondary->setReadOnly(true);
-    } else {
+    }
+    if (targets.isEmpty()) {
+        QMessageBox::information(this, tr("Find All"), tr("None of the files has finished loading."));
+        return;
+    }
+
+    logSearch->cancel();
+    groupManager->clearHitCounts();
+    groupSearch->start(targets, matcher);
+}
+
+void MainWindow::onGroupSearchFinished(bool cancelled) {
+    if (cancelled) {
+        findDialog->setStatus(QString());
+        ui->statusbar->clearMessage();
+        return;
+    }
+
+    QVector<FindResultsModel::File> files;
+    qint64 hitCount = 0;
+    int filesWithHits = 0;
+    int truncatedFiles = 0;
+    for (const GroupSearch::FileResult &result : groupSearch->results()) {
+        files.append(FindResultsModel::File{result.filePath, result.source, result.hits});
+        hitCount += result.hits.size();
+        filesWithHits += result.hits.isEmpty() ? 0 : 1;
+        truncatedFiles += result.truncated ? 1 : 0;
+    }
+    findDialog->setStatus(tr("%1 matches in %2 of %3 files").arg(hitCount).arg(filesWithHits).arg(files.size()));
+    ui->statusbar->showMessage(truncatedFiles > 0 ? tr("Found %1 occurrence(s), %2 file(s) have more").arg(hitCount).arg(truncatedFiles)
+                                                  : tr("Found %1 occurrence(s)").arg(hitCount), 5000);
+    if (hitCount == 0) {
+        QMessageBox::information(this, tr("No Matches"), tr("No matches found for the specified text."));
+        return;
+    }
+
+    findResultsModel->setResults(files, findDialog->orderByTimestamp() ? FindResultsModel::ByTimestamp : FindResultsModel::ByFileAndLine);
+    if (!isFindResultsDisplayed) {
+        toggleFindResults();
+    }
+}
+
+void MainWindow::forgetGroupSearch() {
+    groupSearch->cancel();
+    groupManager->clearHitCounts();
+    if (findResultsModel->isCrossFile()) {
+        findResultsModel->clear(); // The results may refer to a closed file
+    }
+}
+
+void MainWindow::onSearchTextChanged(const QString &text) {
+    QSharedPointer<LogSource> source = ui->logView->source();
+    logSearch->cancel(); // The query of the previous keystroke, or a Find All still running
+    if (!source || text.isEmpty()) {
+        findDialog->setStatus(QString());
+        return;
+    }
+
+    LineMatcher matcher(text, caseSensitiveSearch ? Qt::CaseSensitive : Qt::CaseInsensitive, regularExpressionSearch);
+    if (!matcher.isValid()) {
+        findDialog->setStatus(tr("Invalid regular expression: %1").arg(matcher.errorString()));
+        return;
+    }
+    findAllSource = source;
+    logSearch->start(source, matcher);
+}
+
+void MainWindow::onLogSearchFinished(bool cancelled) {
+    QSharedPointer<LogSource> source = findAllSource;
+    bool showResults = findAllRequested;
+    findAllSource.reset();
+    findAllRequested = false;
+    if (cancelled || !source) {
+        if (showResults) ui->statusbar->clearMessage();
+        return;
+    }
+    const QVector<LogSearch::Hit> &hits = logSearch->hits();
+    findDialog->setStatus(logSearch->isTruncated() ? tr("More than %1 matches").arg(hits.size()) : tr("%1 matches").arg(hits.size()));
+    if (!showResults) return;
+
+    ui->statusbar->showMessage(logSearch->isTruncated() ? tr("Found more than %1 occurrence(s), showing the first ones").arg(hits.size())
+                                                        : tr("Found %1 occurrence(s)").arg(hits.size()), 5000);
+    if (hits.isEmpty()) {
         QMessageBox::information(this, tr("No Matches"), tr("No matches found for the specified text."));
+        return;
+    }
+
+    findResultsModel->setResults(source, currentOpenFilePath, hits);
+    if (!isFindResultsDisplayed) {
+        toggleFindResults();
     }
 }
 
+void MainWindow::onFindResultClicked(const QModelIndex &index) {
+    QString filePath = index.data(FindResultsModel::FilePathRole).toString();
+    if (filePath != currentOpenFilePath && (!findResultsModel->isCrossFile() || !showFile(filePath))) return;
+
+    ui->logView->setSelection(index.data(FindResultsModel::LineRole).toLongLong(),
+                              index.data(FindResultsModel::ColumnRole).toInt(),
+                              index.data(FindResultsModel::LengthRole).toInt());
+}
+
 void MainWindow::setDarkTheme() {
     //QString windowStyle = "background-color: #1f1f1f; color: #434343;";
     QString textStyle = "QTextEdit { background-color: #121212; color: #FFFFFF; }";
+    QString logStyle = "LogView { background-color: #121212; color: #FFFFFF; }";
     QString treeStyle = "QTreeView { background-color: #121212; color: #FFFFFF; }";
+    QString listStyle = "QListView { background-color: #121212; color: #FFFFFF; }";
 
     //this->setStyleSheet(windowStyle);
-    ui->textEditPrimary->setStyleSheet(textStyle);
+    ui->logView->setStyleSheet(logStyle);
     ui->textEditSecondary->setStyleSheet(textStyle);
+    ui->findResultsView->setStyleSheet(listStyle);
     ui->treeView->setStyleSheet(treeStyle);
 }
 
 void MainWindow::setBlueTheme() {
     QString styleSheet = "background-color: #06013d; color: #FFFFFF;";
-    ui->textEditPrimary->setStyleSheet(styleSheet);
+    ui->logView->setStyleSheet(styleSheet);
     ui->textEditSecondary->setStyleSheet(styleSheet);
+    ui->findResultsView->setStyleSheet(styleSheet);
     ui->treeView->setStyleSheet(styleSheet);
 }
 
 void MainWindow::setLightTheme() {
     QString styleSheet = "background-color: #FFFFFF; color: #000000;";
-    ui->textEditPrimary->setStyleSheet(styleSheet);
+    ui->logView->setStyleSheet(styleSheet);
     ui->textEditSecondary->setStyleSheet(styleSheet);
+    ui->findResultsView->setStyleSheet(styleSheet);
     ui->treeView->setStyleSheet(styleSheet);
 }
 
@@ -570,6 +947,130 @@ void MainWindow::setupGroupLogConnections() {
     connect(groupManager, &GroupManager::groupAdded, this, &MainWindow::addToGroup);
 }
 
+void MainWindow::setupStatusBar() {
+    ingestionLabel = new QLabel(this);
+    ingestionProgressBar = new QProgressBar(this);
+    ingestionProgressBar->setRange(0, 1000);
+    ingestionProgressBar->setMaximumWidth(200);
+    ingestionProgressBar->setTextVisible(false);
+    cancelIngestionButton = new QPushButton(tr("Cancel"), this);
+
+    ui->statusbar->addPermanentWidget(ingestionLabel);
+    ui->statusbar->addPermanentWidget(ingestionProgressBar);
+    ui->statusbar->addPermanentWidget(cancelIngestionButton);
+    viewCacheLabel = new QLabel(this);
+    viewCacheLabel->setToolTip(tr("Memory kept for switching back to recently shown files, see View > View Cache Size"));
+    ui->statusbar->addPermanentWidget(viewCacheLabel);
+    updateViewCacheLabel();
+    ingestionLabel->hide();
+    ingestionProgressBar->hide();
+    cancelIngestionButton->hide();
+
+    connect(cancelIngestionButton, &QPushButton::clicked, logManager, &LogManager::cancelIngestion);
+
+    // Archives are listed on the ingestion pool; the dialog only blocks the window while that takes a while
+    archiveProgressDialog = new QProgressDialog(this);
+    archiveProgressDialog->setRange(0, 1000);
+    archiveProgressDialog->setCancelButtonText(tr("Cancel"));
+    archiveProgressDialog->setWindowModality(Qt::WindowModal);
+    archiveProgressDialog->setMinimumDuration(500);
+    archiveProgressDialog->reset(); // Not shown before the first archive is opened
+    connect(archiveProgressDialog, &QProgressDialog::canceled, logManager, &LogManager::cancelArchiveListing);
+    connect(logManager, &LogManager::archiveListingProgress, this, [this](const QString &archivePath, qint64 bytesRead, qint64 bytesTotal) {
+        if (archiveProgressDialog->wasCanceled()) return;
+        archiveProgressDialog->setLabelText(tr("Reading %1...").arg(QFileInfo(archivePath).fileName()));
+        if (bytesTotal > 0) {
+            archiveProgressDialog->setValue(static_cast<int>(qMin<qint64>(bytesRead * 1000 / bytesTotal, 999)));
+        }
+    });
+    connect(logManager, &LogManager::archiveListingFinished, archiveProgressDialog, &QProgressDialog::reset);
+    // Queued, so that the listing is accounted for before the modal ZipViewerDialog runs its event loop
+    connect(logManager, &LogManager::archiveOpened, this, &MainWindow::onArchiveOpened, Qt::QueuedConnection);
+    connect(logManager, &LogManager::ingestionProgress, this, &MainWindow::onIngestionProgress);
+    connect(logManager, &LogManager::ingestionFinished, this, &MainWindow::onIngestionFinished);
+    connect(logManager, &LogManager::sourceUpdated, this, &MainWindow::onSourceUpdated);
+    connect(logManager, &LogManager::sourceReset, this, &MainWindow::onSourceReset);
+    connect(logManager, &LogManager::linesAppended, this, &MainWindow::onLinesAppended);
+}
+
+void MainWindow::onIngestionProgress(qint64 bytesDone, qint64 bytesTotal, qint64 linesDone, double bytesPerSecond, double linesPerSecond) {
+    Q_UNUSED(linesDone);
+    ingestionProgressBar->setValue(bytesTotal > 0 ? static_cast<int>(bytesDone * 1000 / bytesTotal) : 0);
+    ingestionLabel->setText(tr("Loading %1 / %2 MB (%3 MB/s, %4 lines/s)")
+                                .arg(bytesDone / (1024 * 1024))
+                                .arg(bytesTotal / (1024 * 1024))
+                                .arg(bytesPerSecond / (1024 * 1024), 0, 'f', 1)
+                                .arg(qRound64(linesPerSecond)));
+    ingestionLabel->show();
+    ingestionProgressBar->show();
+    cancelIngestionButton->show();
+}
+
+void MainWindow::onIngestionFinished(bool cancelled, int filesLoaded, qint64 bytesLoaded, qint64 elapsedMs) {
+    ingestionLabel->hide();
+    ingestionProgressBar->hide();
+    cancelIngestionButton->hide();
+
+    double seconds = qMax<qint64>(elapsedMs, 1) / 1000.0;
+    QString summary = tr("%1 file(s), %2 MB in %3 s (%4 MB/s)")
+                          .arg(filesLoaded)
+                          .arg(bytesLoaded / (1024 * 1024))
+                          .arg(seconds, 0, 'f', 1)
+                          .arg(bytesLoaded / seconds / (1024 * 1024), 0, 'f', 1);
+    ui->statusbar->showMessage((cancelled ? tr("Loading cancelled: ") : tr("Loaded ")) + summary, 10000);
+}
+
+void MainWindow::onSourceUpdated(const QString &filePath) {
+    if (filePath != currentOpenFilePath) return;
+
+    // The open file was shown while still loading, show the lines indexed since
+    ui->logView->refresh();
+}
+
+void MainWindow::onSourceReset(const QString &filePath) {
+    viewStates.remove(filePath);
+    for (const GroupSearch::FileResult &result : groupSearch->results()) {
+        if (result.filePath == filePath) {
+            forgetGroupSearch(); // The lines found may have moved
+            break;
+        }
+    }
+    updateViewCacheLabel();
+    if (filePath != currentOpenFilePath) return;
+
+    // Every decoded line may be gone, keep only the position
+    logSearch->cancel();
+    stepSearch->cancel();
+    findResultsModel->clear();
+    LogView::State state = ui->logView->saveState();
+    state.rows.clear();
+    ui->logView->setSource(logManager->source(filePath), state);
+}
+
+qint64 MainWindow::FileViewState::cost() const {
+    return view.cost() + findText.size() * static_cast<qint64>(sizeof(QChar)) + findHits.size() * static_cast<qint64>(sizeof(LogSearch::Hit));
+}
+
+void MainWindow::saveViewState() {
+    if (currentOpenFilePath.isEmpty() || !ui->logView->source()) return;
+
+    FileViewState *state = new FileViewState{ui->logView->saveState(), findDialog->text(), findResultsModel->hits()};
+    viewStates.insert(currentOpenFilePath, state, state->cost()); // Deletes the state if it exceeds the whole budget
+}
+
+void MainWindow::forgetViewState(const QString &filePath) {
+    if (!logManager->source(filePath)) {
+        viewStates.remove(filePath); // The file may still be open in another group
+        updateViewCacheLabel();
+    }
+}
+
+void MainWindow::updateViewCacheLabel() {
+    viewCacheLabel->setText(tr("View cache: %1 of %2")
+                                .arg(locale().formattedDataSize(viewStates.totalCost()))
+                                .arg(locale().formattedDataSize(viewStates.maxCost())));
+}
+
 void MainWindow::showHelpDialog() {
     HelpDialog *helpDialog = new HelpDialog(this);
     helpDialog->exec();
@@ -579,11 +1080,14 @@ void MainWindow::initializeTranslations() {
     translations_en = {
         {"file", "File"},
         {"open_logs", "Open Logs"},
+        {"open_folder", "Open Folder"},
         {"open_editable_log", "Open Editable Log"},
         {"save", "Save"},
         {"undo", "Undo"},
         {"view", "View"},
         {"change_font_size", "Change Font Size"},
+        {"highlight_levels", "Highlight Levels and Values"},
+        {"view_cache_size", "View Cache Size..."},
         {"toggle_find_results", "Toggle Find Results"},
         {"themes", "Themes"},
         {"dark_theme", "Dark Theme"},
@@ -598,11 +1102,14 @@ void MainWindow::initializeTranslations() {
     translations_hr = {
         {"file", "Datoteka"},
         {"open_logs", "Otvori log datoteke"},
+        {"open_folder", "Otvori mapu"},
         {"open_editable_log", "Otvori log za uređivanje"},
         {"save", "Spremi"},
         {"undo", "Poništi"},
         {"view", "Prikaz"},
         {"change_font_size", "Promijeni veličinu fonta"},
+        {"highlight_levels", "Istakni razine i vrijednosti"},
+        {"view_cache_size", "Prikaži veličinu predmemorije..."},
         {"toggle_find_results", "Promijeni sadržaj sporednog prozora"},
         {"themes", "Teme"},
         {"dark_theme", "Tamna tema"},
@@ -617,11 +1124,14 @@ void MainWindow::initializeTranslations() {
     translations_es = {
         {"file", "Archivo"},
         {"open_logs", "Abrir registros"},
+        {"open_folder", "Abrir carpeta"},
         {"open_editable_log", "Abrir registro editable"},
         {"save", "Guardar"},
         {"undo", "Deshacer"},
         {"view", "Vista"},
         {"change_font_size", "Cambiar tamaño de fuente"},
+        {"highlight_levels", "Resaltar niveles y valores"},
+        {"view_cache_size", "Ver tamaño de la caché..."},
         {"toggle_find_results", "Alternar resultados de búsqueda"},
         {"themes", "Temas"},
         {"dark_theme", "Tema oscuro"},
@@ -636,11 +1146,14 @@ void MainWindow::initializeTranslations() {
     translations_de = {
         {"file", "Datei"},
         {"open_logs", "Protokolle öffnen"},
+        {"open_folder", "Ordner öffnen"},
         {"open_editable_log", "Bearbeitbares Protokoll öffnen"},
         {"save", "Speichern"},
         {"undo", "Rückgängig machen"},
         {"view", "Ansicht"},
         {"change_font_size", "Schriftgröße ändern"},
+        {"highlight_levels", "Ebenen und Werte hervorheben"},
+        {"view_cache_size", "Cache-Größe anzeigen..."},
         {"toggle_find_results", "Suchergebnisse umschalten"},
         {"themes", "Themen"},
         {"dark_theme", "Dunkles Thema"},
@@ -688,6 +1201,10 @@ void MainWindow::retranslateUi() {
     fileMenu->addAction(openLogsAction);
     connect(openLogsAction, &QAction::triggered, this, &MainWindow::on_actionOpen_triggered);
 
+    QAction *openFolderAction = new QAction(translations["open_folder"], this);
+    fileMenu->addAction(openFolderAction);
+    connect(openFolderAction, &QAction::triggered, this, &MainWindow::on_openFolder_triggered);
+
     QAction *openEditableLogAction = new QAction(translations["open_editable_log"], this);
     fileMenu->addAction(openEditableLogAction);
     connect(openEditableLogAction, &QAction::triggered, this, &MainWindow::on_openEditableLog_triggered);
@@ -705,6 +1222,13 @@ void MainWindow::retranslateUi() {
     viewMenu->addAction(changeFontSizeAction);
     connect(changeFontSizeAction, &QAction::triggered, this, &MainWindow::onChangeFontSizeTriggered);
 
+    highlightLevelsAction->setText(translations["highlight_levels"]);
+    viewMenu->addAction(highlightLevelsAction);
+
+    QAction *viewCacheSizeAction = new QAction(translations["view_cache_size"], this);
+    viewMenu->addAction(viewCacheSizeAction);
+    connect(viewCacheSizeAction, &QAction::triggered, this, &MainWindow::onViewCacheSizeTriggered);
+
     QAction *toggleViewAction = new QAction(translations["toggle_find_results"], this);
     toggleViewAction->setCheckable(true);
     connect(toggleViewAction, &QAction::toggled, this, &MainWindow::toggleFindResults);
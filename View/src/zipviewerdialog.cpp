@@ -1,18 +1,44 @@
 #include "zipviewerdialog.h"
-#include <KZip>
-#include <KArchiveEntry>
-#include <KArchiveDirectory>
-#include <QTreeWidgetItem>
-#include <QVBoxLayout>
-#include <QDialogButtonBox>
-#include <QMessageBox>
+#include "archivesearchdialog.h"
+#include <QHBoxLayout>
+#include <QPushButton>
+#include <QHeaderView>
+#include <QLocale>
 
-ZipViewerDialog::ZipViewerDialog(const QString &zipPath, QWidget *parent)
-    : QDialog(parent), treeWidget(new QTreeWidget(this)) {
-    setWindowTitle("ZIP Content Viewer");
-    treeWidget->setHeaderLabel("Files and Directories");
+namespace {
+const int filterDelayMs = 150; // Pause in typing after which the filter is applied
+}
+
+ZipViewerDialog::ZipViewerDialog(const QSharedPointer<ArchiveSession> &archive, QWidget *parent)
+    : QDialog(parent), model(new ArchiveEntryModel(archive, this)), treeView(new QTreeView(this)),
+      filterEdit(new QLineEdit(this)), summaryLabel(new QLabel(this)), archive(archive) {
+    setWindowTitle(tr("Archive Content Viewer"));
+    resize(720, 520);
     QVBoxLayout *layout = new QVBoxLayout(this);
-    layout->addWidget(treeWidget);
+
+    filterEdit->setPlaceholderText(tr("Filter by name or glob, e.g. *.log"));
+    filterEdit->setClearButtonEnabled(true);
+    layout->addWidget(filterEdit);
+
+    // Uniform row heights let the view lay out huge directories without measuring every row.
+    treeView->setModel(model);
+    treeView->setUniformRowHeights(true);
+    treeView->header()->setStretchLastSection(false);
+    treeView->header()->setSectionResizeMode(ArchiveEntryModel::NameColumn, QHeaderView::Stretch);
+    const int sizeWidth = fontMetrics().horizontalAdvance(QLocale().formattedDataSize(999999999999)) + 24;
+    treeView->header()->resizeSection(ArchiveEntryModel::SizeColumn, sizeWidth);
+    treeView->header()->resizeSection(ArchiveEntryModel::CompressedSizeColumn, sizeWidth);
+    layout->addWidget(treeView);
+
+    QHBoxLayout *selectionLayout = new QHBoxLayout();
+    selectionLayout->addWidget(summaryLabel, 1);
+    QPushButton *selectMatchingButton = new QPushButton(tr("Select all matching"), this);
+    QPushButton *clearButton = new QPushButton(tr("Deselect all matching"), this);
+    QPushButton *searchButton = new QPushButton(tr("Search contents..."), this);
+    selectionLayout->addWidget(selectMatchingButton);
+    selectionLayout->addWidget(clearButton);
+    selectionLayout->addWidget(searchButton);
+    layout->addLayout(selectionLayout);
 
     // Dialog buttons for confirmation and cancellation.
     QDialogButtonBox *buttonBox = new QDialogButtonBox(QDialogButtonBox::Ok | QDialogButtonBox::Cancel, this);
@@ -20,61 +46,56 @@ ZipViewerDialog::ZipViewerDialog(const QString &zipPath, QWidget *parent)
     connect(buttonBox, &QDialogButtonBox::accepted, this, &ZipViewerDialog::accept);
     connect(buttonBox, &QDialogButtonBox::rejected, this, &ZipViewerDialog::reject);
 
-    // Load the contents of the ZIP file.
-    loadZipContents(zipPath);
-}
+    filterTimer.setSingleShot(true);
+    filterTimer.setInterval(filterDelayMs);
+    connect(filterEdit, &QLineEdit::textChanged, &filterTimer, qOverload<>(&QTimer::start));
+    connect(&filterTimer, &QTimer::timeout, this, [this]() {
+        model->setFilter(filterEdit->text());
+        updateSummary();
+    });
+    connect(selectMatchingButton, &QPushButton::clicked, this, [this]() {
+        model->setMatchingChecked(true);
+    });
+    connect(clearButton, &QPushButton::clicked, this, [this]() {
+        // Only what is shown, so a filter can be used to deselect part of the selection
+        model->setMatchingChecked(false);
+    });
+    connect(searchButton, &QPushButton::clicked, this, [this]() {
+        // The selection, or everything shown if nothing is selected yet
+        if (filterTimer.isActive()) {
+            filterTimer.stop();
+            model->setFilter(filterEdit->text());
+            updateSummary();
+        }
+        const QStringList entryPaths = model->checkedCount() > 0 ? model->checkedEntries() : model->matchingEntries();
+        ArchiveSearchDialog searchDialog(this->archive, entryPaths, this);
+        if (searchDialog.exec() == QDialog::Accepted) {
+            model->setCheckedEntries(searchDialog.matchingEntries());
+        }
+    });
+    connect(model, &ArchiveEntryModel::checkedChanged, this, &ZipViewerDialog::updateSummary);
 
-void ZipViewerDialog::loadZipContents(const QString &zipPath) {
-    KZip archive(zipPath);
-    if (archive.open(QIODevice::ReadOnly)) {
-        const KArchiveDirectory* rootDir = archive.directory();
-        populateTreeWidget(rootDir, nullptr);  // Populate the tree widget with the contents.
-        archive.close();
-    } else {
-        QMessageBox::critical(this, "Error", "Unable to open ZIP file.");
-    }
+    updateSummary();
 }
 
-void ZipViewerDialog::populateTreeWidget(const KArchiveDirectory* directory, QTreeWidgetItem* parentItem) {
-    QStringList entries = directory->entries();
-    foreach (const QString &entry, entries) {
-        const KArchiveEntry *e = directory->entry(entry);
-        QTreeWidgetItem *item = new QTreeWidgetItem();
-        item->setText(0, e->name());
-        item->setFlags(item->flags() | Qt::ItemIsUserCheckable); // Enables checkbox.
-        item->setCheckState(0, Qt::Unchecked); // Sets checkbox to unchecked by default.
-
-        if (e->isDirectory()) {
-            item->setIcon(0, QIcon(":/Resources/Icons/folder.png"));
-        } else {
-            item->setIcon(0, QIcon(":/Resources/Icons/file.png"));
-        }
-        if (parentItem) {
-            parentItem->addChild(item);
-        } else {
-            treeWidget->addTopLevelItem(item);
-        }
-        if (e->isDirectory()) {
-            populateTreeWidget(static_cast<const KArchiveDirectory *>(e), item);
-        }
-    }
+void ZipViewerDialog::updateSummary() {
+    QLocale locale;
+    QString matching = model->isFiltered()
+                           ? tr("%1 matching entries").arg(locale.toString(model->matchCount()))
+                           : tr("%1 entries").arg(locale.toString(model->matchCount()));
+    summaryLabel->setText(tr("%1, %2 selected (%3, %4 compressed)")
+                              .arg(matching)
+                              .arg(locale.toString(model->checkedCount()))
+                              .arg(locale.formattedDataSize(model->checkedSize()))
+                              .arg(locale.formattedDataSize(model->checkedCompressedSize())));
 }
 
 void ZipViewerDialog::accept() {
-    selectedFiles.clear();
-    collectSelectedFiles(treeWidget->invisibleRootItem()); // Start collecting selected files.
+    filterTimer.stop();
+    selectedFiles = model->checkedEntries();
     QDialog::accept();
 }
 
-void ZipViewerDialog::collectSelectedFiles(QTreeWidgetItem* item) {
-    if (item->checkState(0) == Qt::Checked) {
-        selectedFiles.append(item->text(0)); // Adds the file path to the list.
-    }
-    for (int i = 0; i < item->childCount(); ++i) {
-        collectSelectedFiles(item->child(i)); // Recursively collect selected files.
-    }
-}
-
 QStringList ZipViewerDialog::getSelectedFiles() const {
     return selectedFiles;
 }